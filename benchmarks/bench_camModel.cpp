@@ -0,0 +1,149 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "Algorithm/vision/camModel/camModel.h"
+#include "precompile.h"
+
+using namespace DeltaVins;
+
+namespace {
+
+constexpr int NUM_POINTS = 1024;
+
+// 752x480 calibrations in the format of Config/calibrations
+const char* PINHOLE_CONFIG = R"(%YAML:1.0
+CamType: Pinhole
+IsStereo: 0
+Intrinsic: !!opencv-matrix
+   rows: 1
+   cols: 6
+   dt: d
+   data: [ 752.0, 480.0, 458.654, 457.296, 367.215, 248.375 ]
+)";
+
+const char* RADTAN_CONFIG = R"(%YAML:1.0
+CamType: RadTan
+IsStereo: 0
+Intrinsic: !!opencv-matrix
+   rows: 1
+   cols: 6
+   dt: d
+   data: [ 752.0, 480.0, 458.654, 457.296, 367.215, 248.375 ]
+Distortion: !!opencv-matrix
+   rows: 1
+   cols: 5
+   dt: d
+   data: [ -0.28340811, 0.07395907, 0.00019359, 1.76187114e-05, 0. ]
+)";
+
+const char* EQUIDISTANT_CONFIG = R"(%YAML:1.0
+CamType: Equidistant
+IsStereo: 0
+Intrinsic: !!opencv-matrix
+   rows: 1
+   cols: 6
+   dt: d
+   data: [ 752.0, 480.0, 365.0, 365.0, 376.0, 240.0 ]
+Distortion: !!opencv-matrix
+   rows: 1
+   cols: 4
+   dt: d
+   data: [ -0.0411423, -0.00242177, 0.00340036, -0.00185288 ]
+)";
+
+// c, d, e, a0, a2, a3, a4 of the omnidirectional model
+const char* FISHEYE_CONFIG = R"(%YAML:1.0
+CamType: Fisheye
+IsStereo: 0
+Alignment: 0
+Intrinsic: !!opencv-matrix
+   rows: 1
+   cols: 4
+   dt: d
+   data: [ 752.0, 480.0, 376.0, 240.0 ]
+Distortion: !!opencv-matrix
+   rows: 1
+   cols: 7
+   dt: d
+   data: [ 1.0, 0.0, 0.0, 350.0, -5.0e-4, 0.0, 0.0 ]
+)";
+
+CamModel::Ptr MakeCamModel(const char* config) {
+    cv::FileStorage fs(config, cv::FileStorage::READ | cv::FileStorage::MEMORY);
+    return CamModel::CreateFromConfig(fs);
+}
+
+// pixels spread over the image and their rays, from a fixed seed
+void MakePoints(CamModel& cam_model, std::vector<Vector2f>& pxs,
+                std::vector<Vector3f>& rays) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    for (int i = 0; i < NUM_POINTS; ++i) {
+        Vector2f px(cam_model.width() * (0.05f + 0.9f * unit(rng)),
+                    cam_model.height() * (0.05f + 0.9f * unit(rng)));
+        pxs.push_back(px);
+        rays.push_back(cam_model.imageToCam(px));
+    }
+}
+
+void BM_CamToImage(benchmark::State& state, const char* config) {
+    CamModel::Ptr cam_model = MakeCamModel(config);
+    std::vector<Vector2f> pxs;
+    std::vector<Vector3f> rays;
+    MakePoints(*cam_model, pxs, rays);
+    for (auto _ : state) {
+        for (int i = 0; i < NUM_POINTS; ++i) {
+            pxs[i] = cam_model->camToImage(rays[i]);
+        }
+        benchmark::DoNotOptimize(pxs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_POINTS);
+}
+
+void BM_CamToImageJacobian(benchmark::State& state, const char* config) {
+    CamModel::Ptr cam_model = MakeCamModel(config);
+    std::vector<Vector2f> pxs;
+    std::vector<Vector3f> rays;
+    MakePoints(*cam_model, pxs, rays);
+    Matrix23f J23;
+    for (auto _ : state) {
+        for (int i = 0; i < NUM_POINTS; ++i) {
+            pxs[i] = cam_model->camToImage(rays[i], J23);
+            benchmark::DoNotOptimize(J23.data());
+        }
+        benchmark::DoNotOptimize(pxs.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_POINTS);
+}
+
+void BM_ImageToCam(benchmark::State& state, const char* config) {
+    CamModel::Ptr cam_model = MakeCamModel(config);
+    std::vector<Vector2f> pxs;
+    std::vector<Vector3f> rays;
+    MakePoints(*cam_model, pxs, rays);
+    for (auto _ : state) {
+        for (int i = 0; i < NUM_POINTS; ++i) {
+            rays[i] = cam_model->imageToCam(pxs[i]);
+        }
+        benchmark::DoNotOptimize(rays.data());
+    }
+    state.SetItemsProcessed(state.iterations() * NUM_POINTS);
+}
+
+BENCHMARK_CAPTURE(BM_CamToImage, Pinhole, PINHOLE_CONFIG);
+BENCHMARK_CAPTURE(BM_CamToImage, RadTan, RADTAN_CONFIG);
+BENCHMARK_CAPTURE(BM_CamToImage, Equidistant, EQUIDISTANT_CONFIG);
+BENCHMARK_CAPTURE(BM_CamToImage, Fisheye, FISHEYE_CONFIG);
+
+BENCHMARK_CAPTURE(BM_CamToImageJacobian, Pinhole, PINHOLE_CONFIG);
+BENCHMARK_CAPTURE(BM_CamToImageJacobian, RadTan, RADTAN_CONFIG);
+BENCHMARK_CAPTURE(BM_CamToImageJacobian, Equidistant, EQUIDISTANT_CONFIG);
+BENCHMARK_CAPTURE(BM_CamToImageJacobian, Fisheye, FISHEYE_CONFIG);
+
+BENCHMARK_CAPTURE(BM_ImageToCam, Pinhole, PINHOLE_CONFIG);
+BENCHMARK_CAPTURE(BM_ImageToCam, RadTan, RADTAN_CONFIG);
+BENCHMARK_CAPTURE(BM_ImageToCam, Equidistant, EQUIDISTANT_CONFIG);
+BENCHMARK_CAPTURE(BM_ImageToCam, Fisheye, FISHEYE_CONFIG);
+
+}  // namespace
@@ -0,0 +1,49 @@
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+
+#include "Algorithm/IMU/ImuPreintergration.h"
+#include "IO/dataBuffer/imuBuffer.h"
+#include "precompile.h"
+#include "utils/SensorConfig.h"
+#include "utils/constantDefine.h"
+
+using namespace DeltaVins;
+
+namespace {
+
+// a body swinging about all axes, at the rate of the calibration
+void FillImuBuffer(ImuBuffer& buffer, int fps, int num_samples) {
+    for (int i = 0; i < num_samples; ++i) {
+        const float t = float(i) / fps;
+        ImuData imu;
+        imu.timestamp = 1000000000LL * i / fps;
+        imu.gyro = Vector3f(0.3f * std::sin(2 * t), 0.2f * std::cos(3 * t),
+                            0.1f * std::sin(5 * t));
+        imu.acc = Vector3f(0.5f * std::cos(2 * t), 0.3f * std::sin(3 * t),
+                           -GRAVITY + 0.2f * std::cos(5 * t));
+        buffer.OnImuReceived(imu);
+    }
+}
+
+// between two frames num_samples imu samples apart, neither on a sample
+void BM_ImuPreIntegration(benchmark::State& state) {
+    const int fps = SensorConfig::Instance().GetIMUParams(0).fps;
+    auto& buffer = ImuBuffer::Instance();
+    if (buffer.empty()) FillImuBuffer(buffer, fps, 1000);
+
+    const int64_t sample_ns = 1000000000LL / fps;
+    ImuPreintergration imu_term;
+    imu_term.sensor_id = 0;
+    imu_term.t0 = 100 * sample_ns + sample_ns / 2;
+    imu_term.t1 = imu_term.t0 + state.range(0) * sample_ns;
+    for (auto _ : state) {
+        buffer.ImuPreIntegration(imu_term);
+        benchmark::DoNotOptimize(imu_term.Cov.data());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+// up to 1.5 frame intervals at 20Hz, longer ones are reported as frame drops
+BENCHMARK(BM_ImuPreIntegration)->ArgName("samples")->DenseRange(5, 15, 5);
+
+}  // namespace
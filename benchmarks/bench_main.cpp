@@ -0,0 +1,23 @@
+#include <benchmark/benchmark.h>
+
+#include "framework/VioContext.h"
+#include "precompile.h"
+#include "utils/SensorConfig.h"
+
+using namespace DeltaVins;
+
+// usage: delta_vins_benchmarks [--benchmark_...] [calibration folder]
+int main(int argc, char** argv) {
+    benchmark::Initialize(&argc, argv);
+    const std::string calibration =
+        argc > 1 ? argv[1] : BENCHMARK_CALIBRATION_DIR;
+
+    // the kernels read the cameras and imus of the bound context
+    VioContext context;
+    VioContext::Scope scope(&context);
+    if (!SensorConfig::Instance().LoadConfig(calibration)) return 1;
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,230 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+
+#include "Algorithm/solver/SquareRootEKFSolver.h"
+#include "precompile.h"
+#include "synthetic.h"
+
+namespace DeltaVins {
+
+/**
+ * @brief Puts a solver into the state it has in the middle of a run and
+ * runs its kernels one at a time. The kernels work in place, so every
+ * benchmark restores its inputs between iterations.
+ */
+class SolverBenchmark {
+   public:
+    SolverBenchmark(int num_frames, int num_points)
+        : scene_(MakeScene(num_frames, num_points)),
+          solver_(std::make_unique<SquareRootEKFSolver>()) {
+        vel_.setZero();
+        solver_->vel_ = &vel_;
+        solver_->static_ = &static_;
+    }
+
+    // every frame in the window, a dense information factor
+    void SetUpWindow() {
+        auto& solver = *solver_;
+        solver.cam_states_.clear();
+        for (auto& frame : scene_.frames) {
+            solver.cam_states_.push_back(frame->state);
+        }
+        const int num_cams = solver.cam_states_.size();
+        _RandomInfoFactor(IMU_STATE_DIM + CAM_STATE_DIM * num_cams);
+    }
+
+    int ComputeJacobians() {
+        int rows = 0;
+        for (auto& landmark : scene_.landmarks) {
+            rows += solver_->ComputeJacobians(landmark.get());
+        }
+        return rows;
+    }
+
+    // stacks the null space projected rows of every point, as
+    // StackInformationFactorMatrix() does for MSCKF points
+    void SetUpUpdate() {
+        SetUpWindow();
+        auto& solver = *solver_;
+        solver._ClearStackedMatrix();
+        solver.msckf_points_.clear();
+        for (auto& landmark : scene_.landmarks) {
+            // the null space projection needs two observations
+            if (solver.ComputeJacobians(landmark.get()) > 3) {
+                solver.AddMsckfPoint(landmark->point_state_);
+            }
+        }
+        solver._AddMsckfPointConstraint();
+        solver.msckf_points_.clear();
+
+        info_factor_ = solver.info_factor_matrix_;
+        residual_ = solver.residual_;
+        stacked_matrix_ = solver.stacked_matrix_;
+        obs_residual_ = solver.obs_residual_;
+    }
+
+    void RestoreUpdate() {
+        auto& solver = *solver_;
+        const int dim = solver.CURRENT_DIM;
+        const int rows = solver.stacked_rows_;
+        solver.info_factor_matrix_.topLeftCorner(dim, dim) =
+            info_factor_.topLeftCorner(dim, dim);
+        solver.residual_.head(dim) = residual_.head(dim);
+        solver.stacked_matrix_.topLeftCorner(rows, dim) =
+            stacked_matrix_.topLeftCorner(rows, dim);
+        solver.obs_residual_.head(rows) = obs_residual_.head(rows);
+    }
+
+    void Update() {
+        solver_->_UpdateByGivensRotations(solver_->stacked_rows_,
+                                          solver_->CURRENT_DIM + 1);
+    }
+
+    int StackedRows() const { return solver_->stacked_rows_; }
+
+    // the last frame is the new camera state, the oldest one is marginalized
+    // together with the old imu state
+    void SetUpMarginalization() {
+        auto& solver = *solver_;
+        solver.cam_states_.clear();
+        for (size_t i = 0; i + 1 < scene_.frames.size(); ++i) {
+            auto state = scene_.frames[i]->state;
+            state->flag_to_marginalize = i == 0;
+            solver.cam_states_.push_back(state);
+        }
+        solver.new_state_ = scene_.frames.back()->state;
+        const int num_cams = solver.cam_states_.size();
+        _RandomInfoFactor(IMU_STATE_DIM + CAM_STATE_DIM * num_cams +
+                          NEW_STATE_DIM);
+        cam_states_ = solver.cam_states_;
+        dim_ = solver.CURRENT_DIM;
+
+        // the columns in the order MarginalizeGivens() hands them to the
+        // rotations: old imu and oldest camera, then new imu and the rest
+        std::vector<int> order;
+        for (int i = 0; i < IMU_STATE_DIM + CAM_STATE_DIM; ++i) {
+            order.push_back(i);
+        }
+        for (int i = 0; i < IMU_STATE_DIM; ++i) {
+            order.push_back(dim_ - IMU_STATE_DIM + i);
+        }
+        for (int i = IMU_STATE_DIM + CAM_STATE_DIM; i < dim_ - IMU_STATE_DIM;
+             ++i) {
+            order.push_back(i);
+        }
+        for (int i = 0; i < dim_; ++i) {
+            to_marginal_.col(i).head(dim_) =
+                solver.info_factor_matrix_.col(order[i]).head(dim_);
+        }
+    }
+
+    void RestoreMarginalization() {
+        solver_->cam_states_ = cam_states_;
+        solver_->CURRENT_DIM = dim_;
+        solver_->info_factor_matrix_to_marginal_.topLeftCorner(dim_, dim_) =
+            to_marginal_.topLeftCorner(dim_, dim_);
+    }
+
+    void MarginalizeGivens() { solver_->MarginalizeGivens(); }
+
+    void MarginByGivensRotation() { solver_->_MarginByGivensRotation(); }
+
+   private:
+    // well conditioned, dense upper triangle
+    void _RandomInfoFactor(int dim) {
+        std::mt19937 rng(1);
+        std::uniform_real_distribution<float> dist(-1.f, 1.f);
+        auto& info_factor = solver_->info_factor_matrix_;
+        info_factor.setZero();
+        for (int i = 0; i < dim; ++i) {
+            info_factor(i, i) = 10.f + dist(rng);
+            for (int j = i + 1; j < dim; ++j) info_factor(i, j) = dist(rng);
+            solver_->residual_(i) = dist(rng);
+        }
+        solver_->CURRENT_DIM = dim;
+    }
+
+    SyntheticScene scene_;
+    std::unique_ptr<SquareRootEKFSolver> solver_;
+    Vector3f vel_;
+    bool static_ = false;
+
+    MatrixMf info_factor_;
+    VectorMf residual_;
+    MatrixOfR stacked_matrix_;
+    VectorOf obs_residual_;
+
+    MatrixMfR to_marginal_;
+    std::vector<CamState*> cam_states_;
+    int dim_ = 0;
+};
+
+}  // namespace DeltaVins
+
+using namespace DeltaVins;
+
+namespace {
+
+// window sizes up to MAX_WINDOW_SIZE, points per update up to
+// MAX_ALL_POINT_SIZE
+void WindowAndPoints(benchmark::internal::Benchmark* b) {
+    b->ArgNames({"window", "points"})
+        ->ArgsProduct({{4, 7, MAX_WINDOW_SIZE}, {8, 16, MAX_ALL_POINT_SIZE}});
+}
+
+void Window(benchmark::internal::Benchmark* b) {
+    b->ArgName("window")->DenseRange(4, MAX_WINDOW_SIZE, 3);
+}
+
+void BM_ComputeJacobians(benchmark::State& state) {
+    auto bench =
+        std::make_unique<SolverBenchmark>(state.range(0), state.range(1));
+    bench->SetUpWindow();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(bench->ComputeJacobians());
+    }
+    state.SetItemsProcessed(state.iterations() * state.range(1));
+}
+BENCHMARK(BM_ComputeJacobians)->Apply(WindowAndPoints);
+
+void BM_UpdateByGivensRotations(benchmark::State& state) {
+    auto bench =
+        std::make_unique<SolverBenchmark>(state.range(0), state.range(1));
+    bench->SetUpUpdate();
+    for (auto _ : state) {
+        state.PauseTiming();
+        bench->RestoreUpdate();
+        state.ResumeTiming();
+        bench->Update();
+    }
+    state.counters["rows"] = bench->StackedRows();
+}
+// the stacked rows are pre-reduced on the cv::parallel_for_ pool
+BENCHMARK(BM_UpdateByGivensRotations)->Apply(WindowAndPoints)->UseRealTime();
+
+void BM_MarginByGivensRotation(benchmark::State& state) {
+    auto bench = std::make_unique<SolverBenchmark>(state.range(0) + 1, 0);
+    bench->SetUpMarginalization();
+    for (auto _ : state) {
+        state.PauseTiming();
+        bench->RestoreMarginalization();
+        state.ResumeTiming();
+        bench->MarginByGivensRotation();
+    }
+}
+BENCHMARK(BM_MarginByGivensRotation)->Apply(Window);
+
+void BM_MarginalizeGivens(benchmark::State& state) {
+    auto bench = std::make_unique<SolverBenchmark>(state.range(0) + 1, 0);
+    bench->SetUpMarginalization();
+    for (auto _ : state) {
+        state.PauseTiming();
+        bench->RestoreMarginalization();
+        state.ResumeTiming();
+        bench->MarginalizeGivens();
+    }
+}
+BENCHMARK(BM_MarginalizeGivens)->Apply(Window);
+
+}  // namespace
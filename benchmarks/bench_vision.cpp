@@ -0,0 +1,153 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <random>
+
+#include "Algorithm/DataAssociation/TwoPointRansac.h"
+#include "Algorithm/VIO_Constexprs.h"
+#include "fast/fast.h"
+#include "precompile.h"
+#include "synthetic.h"
+#include "utils/SensorConfig.h"
+
+using namespace DeltaVins;
+
+namespace {
+
+// FastScoreThreshold of Config.yaml
+constexpr short FAST_THRESHOLD = 15;
+
+// detection, scoring and non maximum suppression as in _ExtractFast, the
+// corners sorted by score
+void DetectFast(const cv::Mat& image, const cv::Mat& mask,
+                std::vector<cv::Point2f>& corners) {
+    thread_local std::vector<fast::fast_xy> xys;
+    thread_local std::vector<int> scores, nms;
+    thread_local std::vector<std::pair<int, fast::fast_xy>> sorted;
+    xys.clear();
+    scores.clear();
+    nms.clear();
+    sorted.clear();
+    fast::fast_corner_detect_10_mask(image.data, mask.data, image.cols,
+                                     image.rows, image.step1(), FAST_THRESHOLD,
+                                     xys);
+    fast::fast_corner_score_10(image.data, image.step1(), xys, FAST_THRESHOLD,
+                               scores);
+    fast::fast_nonmax_3x3(xys, scores, nms);
+    for (int idx : nms) sorted.emplace_back(scores[idx], xys[idx]);
+    std::sort(sorted.begin(), sorted.end(),
+              [](auto& a, auto& b) { return a.first > b.first; });
+    corners.clear();
+    for (auto& corner : sorted) {
+        corners.emplace_back(corner.second.x, corner.second.y);
+    }
+}
+
+void BM_FastDetect(benchmark::State& state) {
+    const cv::Mat image = MakeTexturedImage(state.range(0), state.range(1));
+    const cv::Mat mask(image.size(), CV_8UC1, cv::Scalar(255));
+    std::vector<cv::Point2f> corners;
+    for (auto _ : state) {
+        DetectFast(image, mask, corners);
+        benchmark::DoNotOptimize(corners.data());
+    }
+    state.counters["corners"] = corners.size();
+    state.SetItemsProcessed(state.iterations() * image.total());
+}
+BENCHMARK(BM_FastDetect)
+    ->ArgNames({"width", "height"})
+    ->Args({640, 480})
+    ->Args({752, 480})
+    ->Args({1280, 720});
+
+// pyramidal LK between two frames, with the window, levels and flags of
+// FeatureTrackerOpticalFlow_Chen
+void BM_OpticalFlowPyrLK(benchmark::State& state) {
+    const cv::Mat image0 = MakeTexturedImage(752, 480);
+    const cv::Mat image1 = MoveImage(image0, 1.f, 4.f, -3.f);
+    std::vector<cv::Mat> pyramid0, pyramid1;
+    cv::buildOpticalFlowPyramid(image0, pyramid0, cv::Size(21, 21), 3);
+    cv::buildOpticalFlowPyramid(image1, pyramid1, cv::Size(21, 21), 3);
+
+    std::vector<cv::Point2f> pre;
+    DetectFast(image0, cv::Mat(image0.size(), CV_8UC1, cv::Scalar(255)), pre);
+    pre.resize(std::min<size_t>(pre.size(), state.range(0)));
+
+    std::vector<cv::Point2f> now;
+    std::vector<unsigned char> status;
+    std::vector<float> err;
+    for (auto _ : state) {
+        now = pre;
+        cv::calcOpticalFlowPyrLK(
+            pyramid0, pyramid1, pre, now, status, err, cv::Size(21, 21), 3,
+            cv::TermCriteria(cv::TermCriteria::COUNT + cv::TermCriteria::EPS,
+                             30, 0.01),
+            cv::OPTFLOW_USE_INITIAL_FLOW | cv::OPTFLOW_LK_GET_MIN_EIGENVALS,
+            5e-3);
+        benchmark::DoNotOptimize(status.data());
+    }
+    state.counters["tracked"] = std::count(status.begin(), status.end(), 1);
+    state.SetItemsProcessed(state.iterations() * pre.size());
+}
+// up to MaxNumToTrack of Config.yaml
+BENCHMARK(BM_OpticalFlowPyrLK)->ArgName("points")->Arg(50)->Arg(150)->Arg(350);
+
+// matches between two frames of the synthetic scene, a fifth of them wrong
+void BM_TwoPointRansac(benchmark::State& state) {
+    SyntheticScene scene = MakeScene(2, state.range(0));
+    CamModel::Ptr cam_model = SensorConfig::Instance().GetCamModel(0);
+    const Matrix3f& Rci = cam_model->getRci(0);
+    const Matrix3f dR = Rci * scene.frames[1]->state->Rwi.transpose() *
+                        scene.frames[0]->state->Rwi * Rci.transpose();
+
+    std::mt19937 rng(2);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    std::vector<Vector2f> px0, px1;
+    std::vector<Vector3f> ray0, ray1;
+    for (auto& landmark : scene.landmarks) {
+        auto& obs = landmark->visual_obs[0];
+        if (obs.size() < 2) continue;
+        px0.push_back((*obs.begin())->px);
+        ray0.push_back((*obs.begin())->ray_in_cam);
+        if (px0.size() % 5 == 0) {
+            Vector2f px(cam_model->width() * unit(rng),
+                        cam_model->height() * unit(rng));
+            px1.push_back(px);
+            ray1.push_back(cam_model->imageToCam(px));
+        } else {
+            px1.push_back((*obs.rbegin())->px);
+            ray1.push_back((*obs.rbegin())->ray_in_cam);
+        }
+    }
+
+    TwoPointRansac ransac;
+    std::vector<bool> inliers;
+    int num_inliers = 0;
+    for (auto _ : state) {
+        num_inliers = ransac.FindInliers(px0, ray0, px1, ray1, dR, inliers, 0);
+        benchmark::DoNotOptimize(num_inliers);
+    }
+    state.counters["inliers"] = num_inliers;
+    state.SetItemsProcessed(state.iterations() * px0.size());
+}
+BENCHMARK(BM_TwoPointRansac)->ArgName("points")->Arg(50)->Arg(150)->Arg(350);
+
+// points seen by the frames of the window they stay in view of
+void BM_Triangulate(benchmark::State& state) {
+    constexpr int NUM_POINTS = 32;
+    SyntheticScene scene = MakeScene(state.range(0), NUM_POINTS);
+    int num_triangulated = 0;
+    for (auto _ : state) {
+        num_triangulated = 0;
+        for (auto& landmark : scene.landmarks) {
+            num_triangulated += landmark->Triangulate();
+        }
+    }
+    state.counters["triangulated"] = num_triangulated;
+    state.SetItemsProcessed(state.iterations() * NUM_POINTS);
+}
+BENCHMARK(BM_Triangulate)
+    ->ArgName("window")
+    ->DenseRange(4, MAX_WINDOW_SIZE, 3);
+
+}  // namespace
@@ -0,0 +1,323 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+
+#include "IO/dataBuffer/imuBuffer.h"
+#include "IO/dataSource/dataSource_External.h"
+#include "cmdparser.hpp"
+#include "framework/VIOModule.h"
+#include "framework/VioContext.h"
+#include "precompile.h"
+#include "syntheticSequence.h"
+#include "utils/AllocTracker.h"
+#include "utils/Profiler.h"
+#include "utils/SensorConfig.h"
+#include "utils/log.h"
+#include "utils/tf.h"
+
+using namespace DeltaVins;
+
+// Run the whole VIO headless on a generated sequence and report the frames
+// per second, the latency of every profiled stage and the absolute trajectory
+// error. Frames are fed one at a time with DeterministicReplay, so the
+// numbers of two builds compare on the same box. Exits with 1 when a given
+// bound is missed, for gating merges. Built with ENABLE_ALLOC_TRACKING it
+// also counts the heap allocations per frame once the window is full.
+
+namespace {
+
+// frames before this share of the sequence fill the window and the pools
+constexpr double WARM_UP = 0.25;
+
+struct PoseRecorder : public VIOModule::PoseObserver {
+    void OnPoseAvailable(const Pose& pose) override {
+        std::lock_guard<std::mutex> lck(mtx);
+        poses.push_back(pose);
+    }
+
+    std::mutex mtx;
+    std::vector<Pose> poses;
+};
+
+void configure_parser(cli::Parser& parser) {
+    parser.set_optional<std::string>("c", "calibration",
+                                     BENCHMARK_CALIBRATION_DIR,
+                                     "calibration folder of the rig");
+    parser.set_optional<std::string>("o", "output", "./SyntheticBenchmark",
+                                     "result directory");
+    parser.set_optional<double>("d", "duration", 30.0, "sequence length in s");
+    parser.set_optional<int>("n", "landmarks", 3000, "landmarks in the room");
+    parser.set_optional<int>("s", "seed", 0, "seed of the sequence");
+    parser.set_optional<double>("i", "imu_noise", 1.0,
+                                "multiple of the imu noise of the calibration");
+    parser.set_optional<double>("p", "image_noise", 2.0,
+                                "image noise in grey levels");
+    parser.set_optional<bool>("m", "mono", false,
+                              "left camera only with a stereo calibration");
+    parser.set_optional<bool>("e", "perf_counters", false,
+                              "hardware counters of the stages, Linux");
+    parser.set_optional<double>("f", "min_fps", 0.0,
+                                "fail below this frame rate, 0: off");
+    parser.set_optional<double>("a", "max_ate", 0.0,
+                                "fail above this ATE in m, 0: off");
+    parser.set_optional<double>("l", "max_allocs", 0.0,
+                                "fail above this many heap allocations per "
+                                "frame after the warm-up, 0: off");
+}
+
+// system and data source config of an External system at output
+std::string WriteConfig(const std::string& output,
+                        const std::string& calibration, bool stereo,
+                        bool perf_counters) {
+    const std::string source_file = output + "/source.yaml";
+    std::ofstream source(source_file);
+    source << "%YAML:1.0\n---\n"
+           << "DataSourceType: \"External\"\n";
+
+    // the tracker parameters of Config.yaml
+    const std::string config_file = output + "/config.yaml";
+    std::ofstream config(config_file);
+    config << "%YAML:1.0\n---\n"
+           << "DeterministicReplay: 1\n"
+           << "NoGUI: 1\n"
+           << "NoDebugOutput: 1\n"
+           << "LogLevel: 2\n"
+           << "RunVIO: 1\n"
+           << "ResultOutputPath: \"" << output << "/\"\n"
+           << "ResultOutputFormat: \"TUM\"\n"
+           << "UseGnss: 0\n"
+           << "UseStereo: " << stereo << "\n"
+           << "PerfCounters: " << perf_counters << "\n"
+           << "DataSourceConfigFilePath: \"" << source_file << "\"\n"
+           << "CalibrationPath: \"" << calibration << "\"\n"
+           << "MaxNumToTrack: 350\n"
+           << "MaskSize: 41\n"
+           << "UseBackTracking: 1\n"
+           << "FastScoreThreshold: 15\n";
+    return config_file;
+}
+
+// rmse of the body positions after a rigid alignment to the ground truth,
+// also writes the ground truth in TUM format
+double AbsoluteTrajectoryError(const std::vector<Pose>& poses,
+                               const SyntheticSequence& sequence,
+                               const std::string& groundtruth_file) {
+    Transform<float> Tib;
+    if (!Tfs<float>::Instance().GetTransform("imu0", "body", Tib)) {
+        Tib.T_parent_child.setIdentity();
+    }
+
+    FILE* fp = fopen(groundtruth_file.c_str(), "w");
+    Eigen::Matrix3Xd estimated(3, poses.size()), truth(3, poses.size());
+    for (size_t i = 0; i < poses.size(); ++i) {
+        Matrix3d Rwi;
+        Vector3d Pwi;
+        sequence.GroundTruth(poses[i].timestamp, Rwi, Pwi);
+        const Matrix3d Rwb = Rwi * Tib.Rotation().cast<double>();
+        const Vector3d Pwb = Pwi + Rwi * Tib.Translation().cast<double>();
+        estimated.col(i) = poses[i].Pwb.cast<double>();
+        truth.col(i) = Pwb;
+        if (fp) {
+            const Eigen::Quaterniond q(Rwb);
+            fprintf(fp, "%lf %f %f %f %f %f %f %f\n", poses[i].timestamp / 1e9,
+                    Pwb.x(), Pwb.y(), Pwb.z(), q.x(), q.y(), q.z(), q.w());
+        }
+    }
+    if (fp) fclose(fp);
+    if (poses.size() < 3) return -1;
+
+    const Eigen::Matrix4d T = Eigen::umeyama(estimated, truth, false);
+    const Eigen::Matrix3Xd aligned =
+        (T.topLeftCorner<3, 3>() * estimated).colwise() +
+        T.topRightCorner<3, 1>();
+    return std::sqrt((aligned - truth).colwise().squaredNorm().mean());
+}
+
+double Percentile(std::vector<double> values, double p) {
+    if (values.empty()) return 0;
+    const size_t k = std::min(values.size() - 1, size_t(p * values.size()));
+    std::nth_element(values.begin(), values.begin() + k, values.end());
+    return values[k];
+}
+
+int RunBenchmark(const std::string& config_file,
+                 const SyntheticSequenceOptions& options,
+                 const std::string& output, double min_fps, double max_ate,
+                 double max_allocs) {
+    auto& config = Config::Instance();
+    if (!config.loadConfigFile(config_file)) return 1;
+    Logger::SetLevel(static_cast<LogLevel>(config.LogLevel));
+    if (config.PerfCounters && !Profiler::Instance().EnablePerfCounters()) {
+        LOGW("No hardware counters, see perf_event_paranoid");
+    }
+    if (!SensorConfig::Instance().LoadConfig(config.CalibrationPath)) return 1;
+    const bool stereo =
+        config.UseStereo && SensorConfig::Instance().GetCamModel(0)->IsStereo();
+
+    const SyntheticSequence sequence(options);
+    const auto& imus = sequence.ImuSamples();
+    const auto& timestamps = sequence.FrameTimestamps();
+
+    // the modules of a system with an External data source, as slamAPI.cpp
+    // wires them
+    PoseRecorder recorder;
+    auto source = std::make_shared<DataSource_External>();
+    auto vio = std::make_shared<VIOModule>();
+    vio->AddPoseObserver(&recorder);
+    source->AddImageObserver(vio.get());
+    source->AddImuObserver(&ImuBuffer::Instance());
+    vio->Start();
+
+    // rendering is not part of the pipeline, only the pushes are timed
+    std::vector<double> latencies, allocations;
+    const size_t warm_up = timestamps.size() * WARM_UP;
+    int64_t warm_live_bytes = 0;
+    size_t next_imu = 0;
+    for (size_t i = 0; i < timestamps.size(); ++i) {
+        auto image = std::make_shared<ImageData>();
+        image->timestamp = timestamps[i];
+        image->image = sequence.Render(i, 0);
+        if (stereo) image->right_image = sequence.Render(i, 1);
+
+        if (i == warm_up) warm_live_bytes = AllocTracker::LiveBytes();
+        // of all threads, the pipeline is idle between two pushes
+        const uint64_t allocations_before = AllocTracker::Allocations();
+        const auto start = std::chrono::steady_clock::now();
+        // up to the first sample at or after the frame, see _DueBeforeImage
+        while (next_imu < imus.size() &&
+               (next_imu == 0 ||
+                imus[next_imu - 1].timestamp < image->timestamp)) {
+            source->PushImu(imus[next_imu++]);
+        }
+        // returns once the frame is processed
+        source->PushImage(image);
+        latencies.push_back(std::chrono::duration<double, std::milli>(
+                                std::chrono::steady_clock::now() - start)
+                                .count());
+        if (i >= warm_up) {
+            allocations.push_back(AllocTracker::Allocations() -
+                                  allocations_before);
+        }
+    }
+    const int64_t heap_growth = AllocTracker::LiveBytes() - warm_live_bytes;
+    vio->Stop();
+
+    double total_ms = 0;
+    for (double latency : latencies) total_ms += latency;
+    const double fps = latencies.size() * 1e3 / std::max(total_ms, 1e-3);
+    const double ate = AbsoluteTrajectoryError(
+        recorder.poses, sequence, output + "/groundtruth.tum");
+
+    printf("%zu frames, %zu poses, %.1f fps, %.1f x real time\n",
+           latencies.size(), recorder.poses.size(), fps, fps / options.fps);
+    printf("Frame: p50 %.3f p90 %.3f p99 %.3f max %.3f ms\n",
+           Percentile(latencies, 0.5), Percentile(latencies, 0.9),
+           Percentile(latencies, 0.99), Percentile(latencies, 1.0));
+    for (auto& s : Profiler::Instance().Collect()) {
+        printf("%s: mean %.3f p50 %.3f p90 %.3f p99 %.3f max %.3f ms\n",
+               s.name.c_str(), s.mean_ms, s.p50_ms, s.p90_ms, s.p99_ms,
+               s.max_ms);
+        if (Profiler::Instance().PerfCountersEnabled()) {
+            const auto& c = s.counters;
+            printf("    per call: %llu cycles, %llu instructions, %llu cache "
+                   "misses, %llu branch misses\n",
+                   static_cast<unsigned long long>(c.cycles),
+                   static_cast<unsigned long long>(c.instructions),
+                   static_cast<unsigned long long>(c.cache_misses),
+                   static_cast<unsigned long long>(c.branch_misses));
+        }
+    }
+    printf("ATE: %.4f m\n", ate);
+
+    double allocs_per_frame = 0;
+    for (double n : allocations) allocs_per_frame += n;
+    allocs_per_frame /= std::max<size_t>(allocations.size(), 1);
+    const long peak_rss_kb = AllocTracker::PeakRssKb();
+    if (AllocTracker::Enabled()) {
+        printf("Allocations per frame: mean %.1f p99 %.0f max %.0f, heap "
+               "growth %.1f kB\n",
+               allocs_per_frame, Percentile(allocations, 0.99),
+               Percentile(allocations, 1.0), heap_growth / 1024.0);
+        for (auto& s : AllocTracker::Collect()) {
+            printf("%s: %llu allocations, %.1f kB live\n", s.name.c_str(),
+                   static_cast<unsigned long long>(s.allocations),
+                   s.live_bytes / 1024.0);
+        }
+        AllocTracker::OutputResult(output + "/Memory.txt");
+    }
+    printf("Peak RSS: %.1f MB\n", peak_rss_kb / 1024.0);
+    Profiler::Instance().OutputResult(output + "/Time.txt");
+
+    FILE* fp = fopen((output + "/summary.csv").c_str(), "w");
+    if (fp) {
+        fprintf(fp,
+                "#frames,poses,fps,frame_p50_ms,frame_p99_ms,ate_m,"
+                "allocs_per_frame,heap_growth_kb,peak_rss_kb\n");
+        fprintf(fp, "%zu,%zu,%.3f,%.3f,%.3f,%.5f,%.1f,%.1f,%ld\n",
+                latencies.size(), recorder.poses.size(), fps,
+                Percentile(latencies, 0.5), Percentile(latencies, 0.99), ate,
+                allocs_per_frame, heap_growth / 1024.0, peak_rss_kb);
+        fclose(fp);
+    }
+
+    int status = 0;
+    if (min_fps > 0 && fps < min_fps) {
+        LOGE("%.1f fps is below %.1f", fps, min_fps);
+        status = 1;
+    }
+    // no pose at all is a failure, too
+    if (max_ate > 0 && !(ate >= 0 && ate <= max_ate)) {
+        LOGE("ATE %.4f m is above %.4f m", ate, max_ate);
+        status = 1;
+    }
+    if (max_allocs > 0 && !AllocTracker::Enabled()) {
+        LOGE("--max_allocs needs a build with ENABLE_ALLOC_TRACKING");
+        status = 1;
+    } else if (max_allocs > 0 && allocs_per_frame > max_allocs) {
+        LOGE("%.1f allocations per frame are above %.1f", allocs_per_frame,
+             max_allocs);
+        status = 1;
+    }
+    return status;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    cli::Parser parser(argc, argv);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+
+    SyntheticSequenceOptions options;
+    options.duration = parser.get<double>("d");
+    options.num_landmarks = parser.get<int>("n");
+    options.seed = parser.get<int>("s");
+    options.imu_noise = parser.get<double>("i");
+    options.image_noise = parser.get<double>("p");
+
+    const auto output = std::filesystem::absolute(parser.get<std::string>("o"));
+    std::filesystem::create_directories(output);
+    const std::string config_file =
+        WriteConfig(output.string(), parser.get<std::string>("c"),
+                    !parser.get<bool>("m"), parser.get<bool>("e"));
+
+    logInit();
+    int status = 1;
+    {
+        // the modules bind this context to their threads
+        VioContext context;
+        VioContext::Scope scope(&context);
+        try {
+            status = RunBenchmark(config_file, options, output.string(),
+                                  parser.get<double>("f"),
+                                  parser.get<double>("a"),
+                                  parser.get<double>("l"));
+        } catch (const std::exception& e) {
+            LOGE("%s", e.what());
+        }
+    }
+    finishLogging();
+    return status;
+}
@@ -0,0 +1,100 @@
+#include "synthetic.h"
+
+#include <random>
+
+#include "precompile.h"
+#include "utils/SensorConfig.h"
+
+namespace DeltaVins {
+
+SyntheticScene MakeScene(int num_frames, int num_points, uint32_t seed) {
+    CamModel::Ptr cam_model = SensorConfig::Instance().GetCamModel(0);
+    const Matrix3f Rci = cam_model->getRci(0);
+    const Vector3f tci = cam_model->getTci(0);
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    std::normal_distribution<float> pixel_noise(0.f, 0.5f);
+    std::normal_distribution<float> point_noise(0.f, 0.01f);
+
+    // the world frame is the imu frame of the first camera, which moves 5cm
+    // to its right and turns by 0.3 degree per frame
+    SyntheticScene scene;
+    for (int i = 0; i < num_frames; ++i) {
+        const Matrix3f R_c0_c =
+            Eigen::AngleAxisf(0.005f * i, Vector3f::UnitY()).matrix();
+        const Vector3f P_c_in_c0(0.05f * i, 0.f, 0.f);
+
+        auto frame = std::make_unique<Frame>(0);
+        frame->timestamp = i * 50000000LL;
+        CamState* state = frame->state;
+        state->Rwi = Rci.transpose() * R_c0_c * Rci;
+        state->Pwi = Rci.transpose() * (R_c0_c * tci + P_c_in_c0) +
+                     cam_model->getPic(0);
+        state->Pw_FEJ = state->Pwi;
+        state->vel.setZero();
+        state->index_in_window = i;
+        scene.frames.push_back(std::move(frame));
+    }
+
+    const int width = cam_model->width();
+    const int height = cam_model->height();
+    for (int i = 0; i < num_points; ++i) {
+        // 2m to 6m in front of the central part of the first image
+        Vector2f px0(width * (0.2f + 0.6f * unit(rng)),
+                     height * (0.2f + 0.6f * unit(rng)));
+        const float depth = 2.f + 4.f * unit(rng);
+        Vector3f ray = cam_model->imageToCam(px0);
+        Vector3f Pw = cam_model->camToImu(ray / ray.z() * depth);
+
+        auto landmark = std::make_shared<Landmark>();
+        for (auto& frame : scene.frames) {
+            const CamState* state = frame->state;
+            Vector3f Pi = state->Rwi.transpose() * (Pw - state->Pwi);
+            Vector2f px = cam_model->imuToImage(Pi, 0);
+            px += Vector2f(pixel_noise(rng), pixel_noise(rng));
+            if (!cam_model->inView(px, 20)) continue;
+            landmark->AddVisualObservation(frame->AddVisualObservation(px, 0),
+                                           0);
+        }
+
+        landmark->point_state_ = new PointState();
+        landmark->point_state_->host = landmark.get();
+        landmark->point_state_->Pw =
+            Pw + Vector3f(point_noise(rng), point_noise(rng), point_noise(rng));
+        landmark->point_state_->Pw_FEJ = landmark->point_state_->Pw;
+        landmark->host_frame = scene.frames.front().get();
+        scene.landmarks.push_back(landmark);
+    }
+    return scene;
+}
+
+cv::Mat MakeTexturedImage(int width, int height, uint32_t seed) {
+    cv::RNG rng(seed);
+    cv::Mat image(height, width, CV_8UC1, cv::Scalar(128));
+    for (int i = 0, n = width * height / 800; i < n; ++i) {
+        const cv::Point corner(rng.uniform(0, width), rng.uniform(0, height));
+        const int size = rng.uniform(4, 24);
+        const cv::Scalar color(rng.uniform(0, 256));
+        if (i % 2) {
+            cv::circle(image, corner, size / 2, color, cv::FILLED);
+        } else {
+            cv::rectangle(image, corner, corner + cv::Point(size, size), color,
+                          cv::FILLED);
+        }
+    }
+    cv::GaussianBlur(image, image, cv::Size(3, 3), 0);
+    return image;
+}
+
+cv::Mat MoveImage(const cv::Mat& image, float angle_deg, float dx, float dy) {
+    cv::Mat affine = cv::getRotationMatrix2D(
+        cv::Point2f(image.cols * 0.5f, image.rows * 0.5f), angle_deg, 1.0);
+    affine.at<double>(0, 2) += dx;
+    affine.at<double>(1, 2) += dy;
+    cv::Mat moved;
+    cv::warpAffine(image, moved, affine, image.size(), cv::INTER_LINEAR,
+                   cv::BORDER_REFLECT_101);
+    return moved;
+}
+
+}  // namespace DeltaVins
@@ -0,0 +1,29 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "dataStructure/vioStructures.h"
+
+namespace DeltaVins {
+
+/**
+ * @brief A camera sliding sideways in front of a cloud of points, every
+ * point observed by the left camera of every frame. Generated from a fixed
+ * seed with the camera model of the current context, so runs compare.
+ */
+struct SyntheticScene {
+    std::vector<std::unique_ptr<Frame>> frames;
+    // declared after the frames, landmarks unlink from them on destruction
+    std::vector<Landmark::Ptr> landmarks;
+};
+
+SyntheticScene MakeScene(int num_frames, int num_points, uint32_t seed = 0);
+
+// grey image of random boxes and discs, i.e. plenty of corners
+cv::Mat MakeTexturedImage(int width, int height, uint32_t seed = 0);
+
+// image moved by a small rotation and translation, for optical flow
+cv::Mat MoveImage(const cv::Mat& image, float angle_deg, float dx, float dy);
+
+}  // namespace DeltaVins
@@ -0,0 +1,167 @@
+#include "syntheticSequence.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+
+#include "Algorithm/vision/camModel/camModel.h"
+#include "precompile.h"
+#include "utils/SensorConfig.h"
+#include "utils/constantDefine.h"
+
+namespace DeltaVins {
+
+namespace {
+
+constexpr double ROOM_RADIUS = 5.0;  // m
+constexpr double ROOM_HEIGHT = 4.0;  // m, centered on the start
+constexpr double BLOB_SIZE = 0.03;   // m
+// frames fall between imu samples, as with real sensors
+constexpr double FIRST_FRAME = 0.1013;  // s
+// step of the numerical derivatives of the trajectory
+constexpr double DIFF_STEP = 1e-3;  // s
+
+long long ToNs(double t) { return std::llround(t * 1e9); }
+
+// 0 before t0, 1 after t0 + duration, C2 continuous in between
+double SmoothStep(double t, double t0, double duration) {
+    const double x = std::clamp((t - t0) / duration, 0.0, 1.0);
+    return x * x * x * (x * (6 * x - 15) + 10);
+}
+
+}  // namespace
+
+SyntheticSequence::SyntheticSequence(const SyntheticSequenceOptions& options)
+    : options_(options) {
+    std::mt19937 rng(options_.seed);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    for (int i = 0; i < options_.num_landmarks; ++i) {
+        const double angle = 2 * M_PI * unit(rng);
+        landmarks_.emplace_back(ROOM_RADIUS * std::cos(angle),
+                                ROOM_RADIUS * std::sin(angle),
+                                ROOM_HEIGHT * (unit(rng) - 0.5));
+        // dark or bright, never close to the background
+        const int grey = 20 + int(50 * unit(rng));
+        colors_.push_back(unit(rng) < 0.5 ? grey : 255 - grey);
+    }
+
+    const int num_frames = (options_.duration - FIRST_FRAME) * options_.fps;
+    for (int i = 0; i < num_frames; ++i) {
+        const double t = FIRST_FRAME + double(i) / options_.fps;
+        frame_timestamps_.push_back(ToNs(t));
+    }
+    _GenerateImu();
+}
+
+void SyntheticSequence::_Pose(double t, Matrix3d& Rwi, Vector3d& Pwi) const {
+    // at rest, then easing into a slow swing with all six degrees of freedom
+    const double s = SmoothStep(t, options_.static_duration, 2.0);
+    const double tm = t - options_.static_duration;
+    Pwi = s * Vector3d(1.0 * std::sin(0.5 * tm), 0.8 * std::sin(0.7 * tm),
+                       0.3 * std::sin(0.9 * tm));
+
+    // optical axis along x, image y along -z, then yaw, pitch and roll
+    Matrix3d R_level;
+    R_level << 0, 0, 1, -1, 0, 0, 0, -1, 0;
+    const Matrix3d Rwc =
+        Eigen::AngleAxisd(s * 0.8 * std::sin(0.3 * tm), Vector3d::UnitZ()) *
+        Eigen::AngleAxisd(s * 0.1 * std::sin(0.8 * tm), Vector3d::UnitY()) *
+        Eigen::AngleAxisd(s * 0.1 * std::sin(1.1 * tm), Vector3d::UnitX()) *
+        R_level;
+    const Matrix3f Rci = SensorConfig::Instance().GetCamModel(0)->getRci(0);
+    Rwi = Rwc * Rci.cast<double>();
+}
+
+void SyntheticSequence::_GenerateImu() {
+    const IMUParams params = SensorConfig::Instance().GetIMUParams(0);
+    const double dt = 1.0 / params.fps;
+    const double noise = options_.imu_noise;
+    std::mt19937 rng(options_.seed + 1);
+    std::normal_distribution<double> gyro_noise(
+        0.0, noise * params.gyro_noise / std::sqrt(dt));
+    std::normal_distribution<double> acc_noise(
+        0.0, noise * params.acc_noise / std::sqrt(dt));
+    std::normal_distribution<double> gyro_walk(
+        0.0, noise * params.gyro_bias_noise * std::sqrt(dt));
+    std::normal_distribution<double> acc_walk(
+        0.0, noise * params.acc_bias_noise * std::sqrt(dt));
+
+    const Vector3d gravity(0, 0, -GRAVITY);
+    Vector3d bg = Vector3d::Zero(), ba = Vector3d::Zero();
+    // up to one sample past the last frame for the interpolation
+    const double end = frame_timestamps_.back() * 1e-9 + dt;
+    for (int i = 0; i * dt <= end; ++i) {
+        const double t = i * dt, h = DIFF_STEP;
+        Matrix3d R0, R1, R2;
+        Vector3d P0, P1, P2;
+        _Pose(t - h, R0, P0);
+        _Pose(t, R1, P1);
+        _Pose(t + h, R2, P2);
+        const Eigen::AngleAxisd dR(R0.transpose() * R2);
+        const Vector3d gyro = dR.axis() * dR.angle() / (2 * h);
+        const Vector3d acc_w = (P2 - 2 * P1 + P0) / (h * h);
+        const Vector3d acc = R1.transpose() * (acc_w - gravity);
+
+        ImuData imu;
+        imu.timestamp = ToNs(t);
+        for (int k = 0; k < 3; ++k) {
+            imu.gyro(k) = gyro(k) + bg(k) + gyro_noise(rng);
+            imu.acc(k) = acc(k) + ba(k) + acc_noise(rng);
+            bg(k) += gyro_walk(rng);
+            ba(k) += acc_walk(rng);
+        }
+        imus_.push_back(imu);
+    }
+}
+
+void SyntheticSequence::GroundTruth(long long timestamp, Matrix3d& Rwi,
+                                    Vector3d& Pwi) const {
+    _Pose(timestamp * 1e-9, Rwi, Pwi);
+}
+
+cv::Mat SyntheticSequence::Render(size_t frame, int cam_id) const {
+    CamModel::Ptr cam_model = SensorConfig::Instance().GetCamModel(0);
+    const Matrix3d Rci = cam_model->getRci(cam_id).cast<double>();
+    const Vector3d tci = cam_model->getTci(cam_id).cast<double>();
+    Matrix3d Rwi;
+    Vector3d Pwi;
+    GroundTruth(frame_timestamps_[frame], Rwi, Pwi);
+
+    // painter's algorithm, the far blobs first
+    std::vector<std::pair<double, int>> visible;
+    std::vector<Vector2f> pxs(landmarks_.size());
+    for (size_t i = 0; i < landmarks_.size(); ++i) {
+        const Vector3d Pi = Rwi.transpose() * (landmarks_[i] - Pwi);
+        const Vector3d Pc = Rci * Pi + tci;
+        if (Pc.z() < 0.1) continue;
+        pxs[i] = cam_model->imuToImage(Pi.cast<float>(), cam_id);
+        if (!cam_model->inView(pxs[i], -8)) continue;
+        visible.emplace_back(Pc.z(), i);
+    }
+    std::sort(visible.rbegin(), visible.rend());
+
+    // sub-pixel centers, so a blob moves as smoothly as its landmark
+    constexpr int SHIFT = 4;
+    const float scale = 1 << SHIFT;
+    cv::Mat image(cam_model->height(cam_id), cam_model->width(cam_id),
+                  CV_8UC1, cv::Scalar(128));
+    const float focal = cam_model->focal(cam_id);
+    for (auto& [depth, i] : visible) {
+        const float radius =
+            std::clamp<float>(focal * BLOB_SIZE / depth, 2.f, 6.f);
+        const cv::Point center(cvRound(pxs[i].x() * scale),
+                               cvRound(pxs[i].y() * scale));
+        cv::circle(image, center, cvRound(radius * scale),
+                   cv::Scalar(colors_[i]), cv::FILLED, cv::LINE_AA, SHIFT);
+    }
+
+    if (options_.image_noise > 0) {
+        cv::RNG rng(options_.seed + frame * 2 + cam_id);
+        cv::Mat noise(image.size(), CV_16SC1);
+        rng.fill(noise, cv::RNG::NORMAL, 0, options_.image_noise);
+        cv::add(image, noise, image, cv::noArray(), CV_8U);
+    }
+    return image;
+}
+
+}  // namespace DeltaVins
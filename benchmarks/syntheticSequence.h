@@ -0,0 +1,54 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+#include "dataStructure/sensorStructure.h"
+
+namespace DeltaVins {
+
+struct SyntheticSequenceOptions {
+    double duration = 30.0;        // s, including the static start
+    double static_duration = 2.0;  // s at rest for the static initializer
+    int fps = 20;
+    int num_landmarks = 3000;
+    // multiple of the noise densities of the imu calibration, 0: noise free
+    double imu_noise = 1.0;
+    double image_noise = 2.0;  // sigma in grey levels
+    uint32_t seed = 0;
+};
+
+/**
+ * @brief A sensor rig swinging through a round room, generated for the
+ * cameras and the imu of the current context. Landmarks on the wall are
+ * rendered as blobs centered on their projection, the imu samples are the
+ * derivatives of the trajectory with white noise and random walk biases.
+ *
+ * The world frame is z up with its origin at the imu of the first frame.
+ */
+class SyntheticSequence {
+   public:
+    explicit SyntheticSequence(const SyntheticSequenceOptions& options);
+
+    const std::vector<ImuData>& ImuSamples() const { return imus_; }
+    const std::vector<long long>& FrameTimestamps() const {
+        return frame_timestamps_;
+    }
+
+    // true pose of the imu
+    void GroundTruth(long long timestamp, Matrix3d& Rwi, Vector3d& Pwi) const;
+
+    // image of camera cam_id, the same for the same frame
+    cv::Mat Render(size_t frame, int cam_id) const;
+
+   private:
+    void _Pose(double t, Matrix3d& Rwi, Vector3d& Pwi) const;
+    void _GenerateImu();
+
+    SyntheticSequenceOptions options_;
+    std::vector<Vector3d> landmarks_;
+    std::vector<uchar> colors_;
+    std::vector<ImuData> imus_;
+    std::vector<long long> frame_timestamps_;
+};
+
+}  // namespace DeltaVins
@@ -0,0 +1,160 @@
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <opencv2/core.hpp>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "cmdparser.hpp"
+#include "framework/slamAPI.h"
+#include "utils/CsvReader.h"
+#include "utils/log.h"
+
+using namespace DeltaVins;
+
+// Run one config on a list of sequences and write one result directory per
+// sequence, with the log of the sequence, plus a timing summary. Several
+// sequences run at once, each as a system of its own on a thread.
+//
+// sequence list: one "<dataset path>[,<name>]" per line, '#' for comments
+
+struct Sequence {
+    std::string path;
+    std::string name;
+    std::string result_dir;
+    int status = -1;
+    double wall_seconds = 0;
+};
+
+void configure_parser(cli::Parser& parser) {
+    parser.set_required<std::string>("c", "config", "system config file");
+    parser.set_required<std::string>("l", "list", "sequence list file");
+    parser.set_optional<std::string>("o", "output", "./BatchResults",
+                                     "result root directory");
+    parser.set_optional<int>("j", "jobs", 0,
+                             "concurrent sequences, 0: half the cores");
+    parser.set_optional<int>("t", "threads", 0,
+                             "OpenCV threads shared by the sequences, "
+                             "0: default");
+}
+
+static bool LoadSequences(const std::string& list_file,
+                          const std::string& output,
+                          std::vector<Sequence>& sequences) {
+    CsvReader reader(list_file);
+    if (!reader.IsOpen()) return false;
+    while (reader.NextRow()) {
+        Sequence seq;
+        seq.path = std::string(reader.Field(0));
+        if (reader.NumFields() > 1 && !reader.Field(1).empty()) {
+            seq.name = std::string(reader.Field(1));
+        } else {
+            auto path = std::filesystem::path(seq.path);
+            if (!path.has_filename()) path = path.parent_path();
+            seq.name = path.filename().string();
+        }
+        seq.result_dir = output + "/" + seq.name + "/";
+        sequences.push_back(seq);
+    }
+    return true;
+}
+
+// 0 on success, 1 if the system can not be created, 2 if it failed
+static int RunSequence(const std::string& config_file, const Sequence& seq,
+                       size_t index) {
+    std::filesystem::create_directories(seq.result_dir);
+    // keep the logs and other outputs of concurrent sequences apart, no
+    // window or viewer can follow several sequences at once
+    const std::string log_file = seq.result_dir + "log.txt";
+    const std::string metrics_file = seq.result_dir + "metrics.prom";
+    const std::string metrics_socket = seq.result_dir + "metrics.sock";
+    const std::string shm_name = "/deltavins_batch" + std::to_string(index);
+    VioSystemOptions options = {};
+    options.data_source_path = seq.path.c_str();
+    options.result_output_path = seq.result_dir.c_str();
+    options.log_file = log_file.c_str();
+    options.no_gui = 1;
+    options.metrics_file = metrics_file.c_str();
+    options.metrics_socket = metrics_socket.c_str();
+    options.shm_transport_name = shm_name.c_str();
+    VioHandle handle = CreateSlamSystemEx(config_file.c_str(), &options);
+    if (!handle) return 1;
+
+    int status = 0;
+    try {
+        StartAndJoinSlamSystem(handle);
+    } catch (const std::exception& e) {
+        LOGE("%s: %s", seq.name.c_str(), e.what());
+        status = 2;
+    }
+    DestroySlamSystem(handle);
+    return status;
+}
+
+static void WriteSummary(const std::string& output,
+                         const std::vector<Sequence>& sequences) {
+    const std::string summary_file = output + "/summary.csv";
+    FILE* fp = fopen(summary_file.c_str(), "w");
+    if (!fp) {
+        LOGE("Failed to write %s", summary_file.c_str());
+        return;
+    }
+    fprintf(fp, "#name,status,wall_s,path\n");
+    for (const auto& seq : sequences) {
+        fprintf(fp, "%s,%d,%.3f,%s\n", seq.name.c_str(), seq.status,
+                seq.wall_seconds, seq.path.c_str());
+    }
+    fclose(fp);
+    LOGI("Write summary to %s", summary_file.c_str());
+}
+
+int main(int argc, char** argv) {
+    cli::Parser parser(argc, argv);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+    const auto config_file = parser.get<std::string>("c");
+    const auto list_file = parser.get<std::string>("l");
+    const auto output = parser.get<std::string>("o");
+
+    std::vector<Sequence> sequences;
+    if (!LoadSequences(list_file, output, sequences)) {
+        LOGE("Failed to open sequence list %s", list_file.c_str());
+        return 1;
+    }
+    std::filesystem::create_directories(output);
+
+    const int cores =
+        std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    int jobs = parser.get<int>("j");
+    if (jobs <= 0) jobs = std::max(1, cores / 2);
+    jobs = std::min<int>(jobs, sequences.size());
+    const int threads = parser.get<int>("t");
+    if (threads > 0) cv::setNumThreads(threads);
+    LOGI("Run %zu sequences, %d at a time", sequences.size(), jobs);
+
+    std::atomic<size_t> next{0};
+    std::atomic<int> failed{0};
+    std::vector<std::thread> workers;
+    for (int i = 0; i < jobs; ++i) {
+        workers.emplace_back([&]() {
+            for (size_t j = next++; j < sequences.size(); j = next++) {
+                auto& seq = sequences[j];
+                LOGI("Start %s", seq.name.c_str());
+                const auto start = std::chrono::steady_clock::now();
+                seq.status = RunSequence(config_file, seq, j);
+                seq.wall_seconds =
+                    std::chrono::duration<double>(
+                        std::chrono::steady_clock::now() - start)
+                        .count();
+                if (seq.status) failed++;
+                LOGI("Finish %s: status %d, %.1f s", seq.name.c_str(),
+                     seq.status, seq.wall_seconds);
+            }
+        });
+    }
+    for (auto& worker : workers) worker.join();
+
+    WriteSummary(output, sequences);
+    return failed ? 1 : 0;
+}
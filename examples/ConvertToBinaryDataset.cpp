@@ -0,0 +1,105 @@
+#include <fstream>
+
+#include "IO/dataSource/binaryDataset.h"
+#include "cmdparser.hpp"
+#include "utils/CsvReader.h"
+#include "utils/log.h"
+#include "utils/utils.h"
+
+using namespace DeltaVins;
+
+// Convert an EuRoC-style dataset (cam0/, imu0/) into a single binary file
+// which is replayed by DataSource_Binary.
+
+void configure_parser(cli::Parser& parser) {
+    parser.set_required<std::string>("i", "input", "EuRoC dataset directory");
+    parser.set_required<std::string>("o", "output", "binary dataset file");
+    parser.set_optional<int>("png", "keep_png", 0,
+                             "keep PNG encoded images instead of raw pixels");
+    parser.set_optional<int>("w", "max_width", 640,
+                             "center crop images to this width");
+}
+
+int main(int argc, char** argv) {
+    cli::Parser parser(argc, argv);
+    configure_parser(parser);
+    parser.run_and_exit_if_error();
+    const auto input = parser.get<std::string>("i");
+    const auto output = parser.get<std::string>("o");
+    const bool keep_png = parser.get<int>("png");
+    const int max_width = parser.get<int>("w");
+
+    BinaryDatasetWriter writer(output);
+
+    CsvReader imuCsv(input + "/imu0/data.csv");
+    if (!imuCsv.IsOpen()) {
+        LOGE("Failed to open %s/imu0/data.csv", input.c_str());
+        return 1;
+    }
+    int num_imus = 0;
+    while (imuCsv.NextRow()) {
+        ImuData imuData;
+        if (imuCsv.NumFields() < 7 || !imuCsv.GetInt64(0, imuData.timestamp))
+            continue;
+        for (int i = 0; i < 3; i++) {
+            imuData.gyro(i) = imuCsv.GetFloat(i + 1);
+            imuData.acc(i) = imuCsv.GetFloat(i + 4);
+        }
+        writer.AddImu(imuData);
+        num_imus++;
+    }
+
+    const std::string cam_dir = input + "/cam0";
+    CsvReader camCsv(cam_dir + "/data.csv");
+    if (!camCsv.IsOpen()) {
+        LOGE("Failed to open %s/data.csv", cam_dir.c_str());
+        return 1;
+    }
+    int num_images = 0;
+    while (camCsv.NextRow()) {
+        int64_t timestamp;
+        if (!camCsv.GetInt64(0, timestamp)) continue;
+        const std::string path =
+            cam_dir + "/data/" + std::string(camCsv.Field(0)) + ".png";
+
+        std::vector<uchar> bytes;
+        cv::Mat img;
+        if (keep_png) {
+            std::ifstream file(path, std::ios::binary);
+            bytes.assign(std::istreambuf_iterator<char>(file),
+                         std::istreambuf_iterator<char>());
+            img = cv::imdecode(bytes, cv::IMREAD_GRAYSCALE);
+        } else {
+            img = cv::imread(path, cv::IMREAD_GRAYSCALE);
+        }
+        if (img.empty()) {
+            LOGE("Failed to load image %s", path.c_str());
+            return 1;
+        }
+        int width_crop = 0;
+        int width = img.cols;
+        if (width > max_width) {
+            width_crop = (width - max_width) / 2;
+            width = max_width;
+        }
+        const cv::Mat cropped = img.colRange(width_crop, width_crop + width);
+
+        if (keep_png) {
+            // the replay decodes as is, so a cropped image is encoded again
+            if (width != img.cols && !cv::imencode(".png", cropped, bytes)) {
+                LOGE("Failed to encode image %s", path.c_str());
+                return 1;
+            }
+            writer.AddEncodedImage(timestamp, bytes, img.rows, width,
+                                   BinaryImageEncoding::PNG);
+        } else {
+            writer.AddImage(timestamp, cropped);
+        }
+        num_images++;
+    }
+
+    writer.Close();
+    LOGI("Wrote %d images and %d imus to %s", num_images, num_imus,
+         output.c_str());
+    return 0;
+}
@@ -28,6 +28,21 @@ namespace DeltaVins {
  */
 
 struct TwoPointRansac {
+    // number of hypotheses scored together in one pass over the points
+    static constexpr int HYPOTHESIS_BATCH = 8;
+    // number of points scored between two preemption checks
+    static constexpr int POINT_BLOCK = 32;
+
+    using AlignedVectorf = std::vector<float, Eigen::aligned_allocator<float>>;
+    using PointBlock = Eigen::Array<float, POINT_BLOCK, 1>;
+
+    // essential matrix of formulation (7), only the non-trivial entries
+    struct Hypothesis {
+        float cos_beta;
+        float sin_beta_sin_alpha;
+        float sin_beta_cos_alpha;
+    };
+
     TwoPointRansac(float maxReprojErr = 2.f, int maxIterNum = 25);
 
     int FindInliers(const std::vector<Eigen::Vector2f>& px0,
@@ -37,29 +52,37 @@ struct TwoPointRansac {
                     const Eigen::Matrix3f& dR, std::vector<bool>& inliers,
                     int sensor_id);
 
-    void ComputeEssentialMatrix();
-    int SelectInliers(std::vector<bool>& inliers, int sensor_id);
+    Hypothesis ComputeEssentialMatrix() const;
+    int ScoreHypotheses(int num_hypotheses, int min_inliers,
+                        int& best_hypothesis);
+    // the scored hypotheses of iterations first_iter... in order, as long as
+    // they are below the adaptive bound max_iter, returns the updated bound
+    int AcceptHypotheses(int num_hypotheses, int first_iter, int max_iter,
+                         int& max_inliers, Hypothesis& best) const;
+    int SelectInliers(const Hypothesis& hypothesis,
+                      std::vector<bool>& inliers) const;
     bool NextSample();
-    bool IsGoodSample();
-    int UpdateIterNum(int nInliers);
+    bool IsGoodSample() const;
+    int UpdateIterNum(int nInliers) const;
 
-    std::vector<Eigen::Vector3f> ray10_;
-    const std::vector<Eigen::Vector3f>*ray0_, *ray1_;
-    const std::vector<Eigen::Vector2f>*px0_, *px1_;
+    // rotation compensated rays of the previous frame and rays of the current
+    // frame in SoA layout, padded with zero rays to a multiple of POINT_BLOCK
+    AlignedVectorf ray10_x_, ray10_y_, ray10_z_;
+    AlignedVectorf ray1_x_, ray1_y_, ray1_z_;
+    const std::vector<Eigen::Vector2f>* px0_;
     int sample0_index_, sample1_index_;
 
-    std::vector<float> reproj_err_;
-    Eigen::Matrix3f mdR_;
-    Eigen::Matrix3f mE_;
-    Eigen::Matrix3f mF_;
+    Hypothesis hypotheses_[HYPOTHESIS_BATCH];
+    int hypothesis_inliers_[HYPOTHESIS_BATCH];
 
     int num_samples_ = 1000;
     int sample_index_;
     int max_iter_num_;
-    std::vector<std::pair<int, int>> samples_;
 
     float max_sqr_reproj_err_;
+    float focal2_;
     int num_points_;
+    int num_padded_points_;
     float confidence_ = 0.99;
 };
 
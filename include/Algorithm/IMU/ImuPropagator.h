@@ -0,0 +1,51 @@
+#pragma once
+#include <deque>
+#include <mutex>
+
+#include "dataStructure/IO_Structures.h"
+#include "dataStructure/sensorStructure.h"
+#include "utils/tf.h"
+
+namespace DeltaVins {
+
+/**
+ * @brief Forward propagation of the latest filtered state with the imu
+ * samples received since, giving a pose per imu sample between two frames.
+ *
+ * SetState is called by the VIO thread after each update and replays the
+ * samples newer than the state, AddImu by the data source thread for every
+ * sample. Both are cheap: the replay only covers the processing latency of
+ * one frame.
+ */
+class ImuPropagator {
+   public:
+    struct State {
+        EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+        long long timestamp = -1;
+        Matrix3f Rwi;
+        Vector3f Pwi;
+        Vector3f Vwi;
+        Vector3f bg;
+        Vector3f ba;
+    };
+
+    // anchors the propagation at a filtered state, returns the body pose
+    // propagated to the newest sample
+    bool SetState(const State& state, Pose& pose);
+
+    // returns false until the first state is set
+    bool AddImu(const ImuData& imuData, Pose& pose);
+
+   private:
+    void _Integrate(const ImuData& imuData);
+    void _GetPose(Pose& pose) const;
+
+    std::mutex mtx_;
+    State state_;  // propagated to the timestamp of last_imu_
+    ImuData last_imu_;
+    // samples after the last filtered state, bounded before initialization
+    std::deque<ImuData> imus_;
+    Transform<float> Tib_;
+};
+
+}  // namespace DeltaVins
@@ -17,7 +17,8 @@ class StaticInitializer {
     void _Initialization(const ImageData::Ptr imageData);
 
     std::vector<cv::Point2f> last_points_;
-    cv::Mat last_image_;
+    // keeps borrowed image buffers alive
+    ImageData::Ptr last_image_;
 
     float moved_pixels_last_few_frames_ = 3.0f;
 };
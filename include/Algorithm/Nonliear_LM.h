@@ -1,7 +1,12 @@
 #pragma once
+#include <algorithm>
+#include <cmath>
 #include <limits>
+#include <ostream>
 #include <Eigen/Dense>
 
+#include "utils/log.h"
+
 struct LM_Result {
     bool bConverged;
     float cost;
@@ -20,32 +25,77 @@ struct LM_Result {
     }
 };
 
-template <int nDim, typename Type>
+/**
+ * @brief Robust weighting policies used by NonLinear_LM at compile time.
+ * Weight() returns the IRLS weight of a residual with norm err, Cost() its
+ * contribution to the total cost.
+ */
+template <typename Type>
+struct LM_HuberLoss {
+    static Type Weight(Type err, Type thresh) {
+        return err > thresh ? thresh / err : Type(1);
+    }
+    static Type Cost(Type err, Type thresh) {
+        return err > thresh ? thresh * (2 * err - thresh) : err * err;
+    }
+};
+
+template <typename Type>
+struct LM_L2Loss {
+    static Type Weight(Type, Type) { return Type(1); }
+    static Type Cost(Type err, Type) { return err * err; }
+};
+
+/**
+ * @brief Levenberg-Marquardt solver with the problem bound at compile time.
+ *
+ * The solver owns all scratch (H, b, z), the problem only describes the
+ * residuals. Problem must provide:
+ *   template <typename Func>
+ *   void ForEachResidual(const Vector& z, Func&& f) const;
+ *       calls f(r, J) for every residual block, r is a fixed size vector and
+ *       J its jacobian wrt z (r.rows() x nDim)
+ *   bool DecentFail(const Vector& z_new) const;
+ *   void ConvergeCriteria(LM_Result& result) const;
+ * All calls are resolved statically so residual evaluation is inlined.
+ */
+template <typename Problem, int nDim, typename Type,
+          template <typename> class Loss = LM_HuberLoss>
 class NonLinear_LM {
    public:
-    NonLinear_LM(Type Epsilon1, Type Epsilon2, Type tau, int nMaxIters,
-                 bool verbose = false)
-        : max_b_(Epsilon1),
+    EIGEN_MAKE_ALIGNED_OPERATOR_NEW
+    using Matrix = Eigen::Matrix<Type, nDim, nDim>;
+    using Vector = Eigen::Matrix<Type, nDim, 1>;
+
+    NonLinear_LM(const Problem& problem, Type Epsilon1, Type Epsilon2,
+                 Type tau, int nMaxIters, bool verbose = false)
+        : problem_(problem),
+          max_b_(Epsilon1),
           max_dz_(Epsilon2),
           max_iters_(nMaxIters),
           tau_(tau),
           verbose_(verbose) {
+        clear();
+    }
 
-          };
-    ~NonLinear_LM() {}
     void clear();
-    virtual Type EvaluateF(bool bNewZ, Type huberThresh) = 0;
-    virtual bool UserDefinedDecentFail() = 0;
-    virtual bool UserDefinedConvergeCriteria() = 0;
     void solve();
 
+    Vector& State() { return z_; }
+    const Vector& State() const { return z_; }
+    // Gauss-Newton approximated hessian at the accepted state
+    const Matrix& Hessian() const { return H_; }
+
     LM_Result m_Result;
 
-   protected:
-    Eigen::Matrix<Type, nDim, nDim> H, HTemp;
-    Eigen::Matrix<Type, nDim, 1> b, bTemp;
-    Eigen::Matrix<Type, nDim, 1> z, zNew;
-    Eigen::Matrix<Type, nDim, 1> dZ;
+   private:
+    Type Evaluate(const Vector& z, Type huberThresh);
+
+    const Problem& problem_;
+    Matrix H_, HTemp_;
+    Vector b_, bTemp_;
+    Vector z_, zNew_;
+    Vector dZ_;
     Type max_b_, max_dz_;
     int max_iters_;
     int num_iter_;
@@ -53,90 +103,108 @@ class NonLinear_LM {
     bool verbose_;
 };
 
-template <int nDim, typename Type>
-void NonLinear_LM<nDim, Type>::clear() {
-    H.setZero();
-    b.setZero();
-    HTemp.setZero();
-    bTemp.setZero();
-    z.setZero();
-    dZ.setZero();
+template <typename Problem, int nDim, typename Type,
+          template <typename> class Loss>
+void NonLinear_LM<Problem, nDim, Type, Loss>::clear() {
+    H_.setZero();
+    b_.setZero();
+    HTemp_.setZero();
+    bTemp_.setZero();
+    z_.setZero();
+    dZ_.setZero();
     m_Result.clear();
 }
 
-template <int nDim, typename Type>
-void NonLinear_LM<nDim, Type>::solve() {
-    float nu = 2;
+template <typename Problem, int nDim, typename Type,
+          template <typename> class Loss>
+Type NonLinear_LM<Problem, nDim, Type, Loss>::Evaluate(const Vector& z,
+                                                      Type huberThresh) {
+    Type cost = 0;
+    HTemp_.setZero();
+    bTemp_.setZero();
+    problem_.ForEachResidual(z, [&](const auto& r, const auto& J) {
+        const Type err = r.norm();
+        const Type w = Loss<Type>::Weight(err, huberThresh);
+        cost += Loss<Type>::Cost(err, huberThresh);
+        HTemp_.noalias() += J.transpose() * J * w;
+        bTemp_.noalias() += J.transpose() * r * w;
+    });
+    return cost;
+}
 
-    float cost0 = EvaluateF(false, 10.f);
-    H = HTemp;
-    b = bTemp;
-    float mu = H.diagonal().maxCoeff() * tau_;
-    if (b.cwiseAbs().maxCoeff() < max_b_) {
-        m_Result.bMax = b.cwiseAbs().maxCoeff();
+template <typename Problem, int nDim, typename Type,
+          template <typename> class Loss>
+void NonLinear_LM<Problem, nDim, Type, Loss>::solve() {
+    Type nu = 2;
+
+    Type cost0 = Evaluate(z_, Type(10));
+    H_ = HTemp_;
+    b_ = bTemp_;
+    Type mu = H_.diagonal().maxCoeff() * tau_;
+    if (b_.cwiseAbs().maxCoeff() < max_b_) {
+        m_Result.bMax = b_.cwiseAbs().maxCoeff();
         m_Result.bConverged = true;
     }
 
     for (num_iter_ = 1; !m_Result.bConverged && num_iter_ < max_iters_;
          ++num_iter_) {
-        Eigen::Matrix<Type, nDim, nDim> H_ =
-            H + Eigen::Matrix<Type, nDim, nDim>::Identity(3, 3) * mu;
+        Matrix H_damped = H_ + Matrix::Identity() * mu;
 
-        dZ = H_.ldlt().solve(b);
+        dZ_ = H_damped.ldlt().solve(b_);
 
-        if (dZ.norm() < max_dz_ * (z.norm() + max_dz_)) {
+        if (dZ_.norm() < max_dz_ * (z_.norm() + max_dz_)) {
             m_Result.bConverged = true;
             if (verbose_)
-                LOGI("\t%.6f / %.6f\n", dZ.norm(),
-                     max_dz_ * (z.norm() + max_dz_));
+                LOGI("\t%.6f / %.6f\n", dZ_.norm(),
+                     max_dz_ * (z_.norm() + max_dz_));
         }
 
-        zNew = z + dZ;
+        zNew_ = z_ + dZ_;
 
         if (verbose_) {
             LOGI("#Iter:\t %02d\n", num_iter_);
             LOGI("\t#mu:%.6f\n", mu);
             LOGI("\t#dZ:");
             for (int i = 0; i < nDim; ++i) {
-                LOGI("  %.6f", dZ[i]);
+                LOGI("  %.6f", dZ_[i]);
             }
             LOGI("\n\t#z:\t");
             for (int i = 0; i < nDim; ++i) {
-                LOGI("  %.6f", z[i]);
+                LOGI("  %.6f", z_[i]);
             }
             LOGI("  ->  ");
             for (int i = 0; i < nDim; ++i) {
-                LOGI("  %.6f", zNew[i]);
+                LOGI("  %.6f", zNew_[i]);
             }
             LOGI("\n");
             LOGI("\n\t#b:\t");
             for (int i = 0; i < nDim; ++i) {
-                LOGI("  %.6f", b[i]);
+                LOGI("  %.6f", b_[i]);
             }
             LOGI("\n");
         }
 
         // compute rho for estimating decent performance
-        float cost1 = EvaluateF(true, num_iter_ > 2 ? 3.f : 10.f);
-        float rho = (cost0 - cost1) / (0.5 * dZ.dot(mu * dZ + b));
+        Type cost1 = Evaluate(zNew_, num_iter_ > 2 ? Type(3) : Type(10));
+        Type rho = (cost0 - cost1) / (Type(0.5) * dZ_.dot(mu * dZ_ + b_));
         if (verbose_) LOGI("\trho:%.6f\n", rho);
-        if (rho > 0 && !UserDefinedDecentFail()) {
-            z = zNew;
-            H = HTemp;
-            b = bTemp;
+        if (rho > 0 && !problem_.DecentFail(zNew_)) {
+            z_ = zNew_;
+            H_ = HTemp_;
+            b_ = bTemp_;
             if (verbose_) {
                 LOGI("\t#cost:\t %.6f  ->  %.6f\n", cost0, cost1);
                 LOGI("\t#Status: Accept\n");
             }
             cost0 = cost1;
 
-            m_Result.bMax = b.cwiseAbs().maxCoeff();
-            m_Result.dZMax = dZ.cwiseAbs().maxCoeff();
+            m_Result.bMax = b_.cwiseAbs().maxCoeff();
+            m_Result.dZMax = dZ_.cwiseAbs().maxCoeff();
             m_Result.cost = cost0;
 
-            if (b.cwiseAbs().maxCoeff() < max_b_) m_Result.bConverged = true;
-            mu = mu *
-                 std::max(1.f / 3.f, 1.f - float(std::pow(2.f * rho - 1.f, 3)));
+            if (b_.cwiseAbs().maxCoeff() < max_b_) m_Result.bConverged = true;
+            mu = mu * std::max(Type(1) / Type(3),
+                               Type(1) - std::pow(Type(2) * rho - Type(1), 3));
             nu = 2;
 
         } else {
@@ -150,5 +218,5 @@ void NonLinear_LM<nDim, Type>::solve() {
                 "--------------------------------------------------------------"
                 "\n");
     }
-    UserDefinedConvergeCriteria();
-}
\ No newline at end of file
+    problem_.ConvergeCriteria(m_Result);
+}
@@ -3,11 +3,16 @@
 #include "FrameAdapter.h"
 #include "WorldPointAdapter.h"
 #include "IMU/ImuPreintergration.h"
+#include "IMU/ImuPropagator.h"
+#include "IO/dataOuput/TelemetryWriter.h"
+#include "IO/dataOuput/TrajectoryWriter.h"
+#include "IO/dataOuput/VisualizerPublisher.h"
 #include "dataStructure/IO_Structures.h"
 #include "solver/SquareRootEKFSolver.h"
 #include "vision/FeatureTrackerOpticalFlow.h"
 #include "vision/FeatureTrackerOpticalFlow_Chen.h"
 #include "Initializer/StaticInitializer.h"
+#include "utils/tf.h"
 
 namespace DeltaVins {
 class VIOAlgorithm {
@@ -15,11 +20,19 @@ class VIOAlgorithm {
     VIOAlgorithm();
     ~VIOAlgorithm();
 
-    void AddNewFrame(const ImageData::Ptr imageData, Pose::Ptr pose);
+    // returns whether pose was written, i.e. the system is initialized
+    bool AddNewFrame(const ImageData::Ptr imageData, Pose::Ptr pose);
+
+    // imu state of the last frame, false before initialization
+    bool GetImuState(ImuPropagator::State& state) const;
 
     void SetWorldPointAdapter(WorldPointAdapter* adapter);
     void SetFrameAdapter(FrameAdapter* adapter);
 
+    // writes out the trajectory and telemetry and stops the visualizer,
+    // nothing is recorded afterwards
+    void FinishOutput();
+
    private:
     enum class InitState {
         NeedFirstFrame,
@@ -40,7 +53,9 @@ class VIOAlgorithm {
 
     void _PreProcess(const ImageData::Ptr imageData);
     void _PostProcess(ImageData::Ptr data, Pose::Ptr pose);
+    bool _AcquireVisualSnapshot();
     void _UpdatePointsAndCamsToVisualizer();
+    void _TakeTracksSnapshot(ImageData::Ptr dataPtr);
     void _DrawTrackImage(ImageData::Ptr dataPtr, cv::Mat& trackImage,
                          int cam_id);
     void _DrawPredictImage(ImageData::Ptr dataPtr, cv::Mat& predictImage,
@@ -56,6 +71,8 @@ class VIOAlgorithm {
     void _TestVisionModule(const ImageData::Ptr data, Pose::Ptr pose);
     void _AddMeasurement();
     void _SelectFrames2Margin();
+    void _PublishMetrics();
+    void _WriteTelemetry();
 
     bool _VisionStatic();
 
@@ -70,9 +87,19 @@ class VIOAlgorithm {
 
     Frame::Ptr last_keyframe_ = nullptr;
     void _SelectKeyframe();
+    int cam_idx_to_margin_ = 0;
 
     /************* Output **********************/
 
+    Transform<float> Tib_;  // imu in body frame
+    std::unique_ptr<TrajectoryWriter> trajectory_writer_;
+    std::unique_ptr<TelemetryWriter> telemetry_writer_;
+    FrameTelemetry telemetry_;  // of the frame being processed
+    int vis_counter_ = 0;
+    // drawn by the visualizer_ thread, filled for a frame now and then
+    std::unique_ptr<VisualizerPublisher> visualizer_;
+    VisualSnapshot::Ptr visual_snapshot_;
+
     FrameAdapter* frame_adapter_ = nullptr;
     WorldPointAdapter* world_point_adapter_ = nullptr;
     StaticInitializer static_initializer_;
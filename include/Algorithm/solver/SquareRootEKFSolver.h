@@ -12,6 +12,7 @@ struct CamState;
 class SquareRootEKFSolver {
    public:
     friend class VIOAlgorithm;
+    friend class SolverBenchmark;  // benchmarks/bench_solver.cpp
 
     SquareRootEKFSolver();
 
@@ -53,9 +54,15 @@ class SquareRootEKFSolver {
 
     int _AddMsckfPointConstraint();
 
+    // stack the rows of stack_points_, copies run in parallel
+    int _StackPointConstraints(bool slam_point);
+
    private:
     void _UpdateByGivensRotations(int row, int col);
 
+    // reduce the stacked rows to at most CURRENT_DIM rows by parallel QR
+    int _CompressStackedRowsByTreeQR(int row);
+
     int _AddPositionContraint(int nRows);
 
 #ifdef PLATFORM_ARM
@@ -66,6 +73,9 @@ class SquareRootEKFSolver {
 
     void _ClearStackedMatrix();
 
+    // lazily recompute the inverse of the marginalized information factor
+    void _UpdateInfoFactorInverse();
+
     // MatrixMf m_infoFactorInverseMatrix;
 
     MatrixMfR info_factor_matrix_to_marginal_;
@@ -74,11 +84,19 @@ class SquareRootEKFSolver {
     VectorOf obs_residual_;
 
     int stacked_rows_ = 0;
+    std::vector<PointState *> stack_points_;
+    std::vector<int> stack_row_offsets_;
+    // scratch of _CompressStackedRowsByTreeQR, [R | r] per group of rows
+    std::vector<MatrixXf> tree_qr_blocks_;
+    std::vector<MatrixXf> tree_qr_merged_;
 
     MatrixMf info_factor_matrix_;  // Upper Triangle Matrix, parameter order:
                                    // [bg, v, ba, slam pt, cam state]
 
     MatrixMf info_factor_matrix_after_mariginal_;
+    // R^-1 of info_factor_matrix_after_mariginal_, used for gating
+    MatrixMf info_factor_inverse_matrix_;
+    bool info_factor_inverse_dirty_ = true;
     VectorMf residual_;
 
     int CURRENT_DIM = 0;
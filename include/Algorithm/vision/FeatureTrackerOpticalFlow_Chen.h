@@ -16,6 +16,12 @@ class FeatureTrackerOpticalFlow_Chen {
                        const ImageData::Ptr image, Frame* camState);
 
     bool IsStaticLastFrame();
+
+    // features of the last frame, tracked from the frame before or new
+    int NumTrackedFeatures() const {
+        return num_features_tracked_ - num_new_features_;
+    }
+    int NumNewFeatures() const { return num_new_features_; }
     ~FeatureTrackerOpticalFlow_Chen();
 
    private:
@@ -42,6 +48,7 @@ class FeatureTrackerOpticalFlow_Chen {
     int max_num_to_track_;
     int mask_size_;
     int num_features_tracked_;
+    int num_new_features_ = 0;
     int mask_buffer_size_;
     bool use_back_tracking_;
     // cv::Mat image_;
@@ -8,10 +8,9 @@ class GnssBuffer : public CircularBuffer<NavSatFixData, 10>,
                    public DataSource::NavSatFixObserver {
    public:
     friend class DataRecorder;
-    static GnssBuffer& Instance() {
-        static GnssBuffer gnssBuffer;
-        return gnssBuffer;
-    }
+    friend class VioContext;
+    // buffer of the current VioContext
+    static GnssBuffer& Instance();
     ~GnssBuffer() = default;
 
     void OnNavSatFixReceived(const NavSatFixData& navSatFixData) override;
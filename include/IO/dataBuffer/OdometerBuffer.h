@@ -9,10 +9,9 @@ class OdometerBuffer : public CircularBuffer<OdometerData, 10>,
                        public DataSource::OdometerObserver {
    public:
     friend class DataRecorder;
-    static OdometerBuffer& Instance() {
-        static OdometerBuffer odom_buffer;
-        return odom_buffer;
-    }
+    friend class VioContext;
+    // buffer of the current VioContext
+    static OdometerBuffer& Instance();
     ~OdometerBuffer() = default;
 
     void OnOdometerReceived(const OdometerData& odometerData) override;
@@ -1,22 +1,25 @@
 #pragma once
 #include "IO/dataSource/dataSource.h"
 #include "dataStructure/ringBuffer.h"
+#include "utils/Profiler.h"
 
 namespace DeltaVins {
 
 class ImageBuffer : public CircularBuffer<ImageData::Ptr, 6> {
    public:
     friend class DataRecorder;
-    static ImageBuffer& Instance() {
-        static ImageBuffer imageBuffer;
-        return imageBuffer;
-    }
+    friend class VioContext;
+    // buffer of the current VioContext
+    static ImageBuffer& Instance();
     void PushImage(const ImageData::Ptr imageData) {
+        // the oldest image is overwritten
+        if (Full()) dropped_++;
         buf_[head_] = imageData;
         PushIndex();
         if (Full()) {
-            LOGW("Image Buffer is Full");
+            LOGW_EVERY_MS(1000, "Image Buffer is Full");
         }
+        TRACE_COUNTER("ImageBuffer", Size());
     }
 
     ImageData::Ptr PopHeadImage() { return buf_[getDeltaIndex(head_, -1)]; };
@@ -24,12 +27,18 @@ class ImageBuffer : public CircularBuffer<ImageData::Ptr, 6> {
         if (empty()) return nullptr;
         int tail = tail_;
         PopIndex();
+        TRACE_COUNTER("ImageBuffer", Size());
         return buf_[tail];
     }
+    int Size() const { return (head_ - tail_ + _BUFSIZE) & _END; }
+    // images dropped since the last call
+    int TakeDropped() { return dropped_.exchange(0); }
     ~ImageBuffer() {};
 
    private:
     ImageBuffer() {};
+
+    std::atomic<int> dropped_{0};
 };
 
 }  // namespace DeltaVins
\ No newline at end of file
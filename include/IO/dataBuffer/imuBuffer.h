@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+
 #include "IO/dataSource/dataSource.h"
 #include "dataStructure/ringBuffer.h"
 
@@ -10,10 +12,9 @@ class ImuBuffer : public CircularBuffer<ImuData, 10>,
                   public DataSource::ImuObserver {
    public:
     friend class DataRecorder;
-    static ImuBuffer& Instance() {
-        static ImuBuffer imuBuffer;
-        return imuBuffer;
-    }
+    friend class VioContext;
+    // buffer of the current VioContext
+    static ImuBuffer& Instance();
     void OnImuReceived(const ImuData& imuData) override;
     Vector3f GetGravity(long long timestamp);
     Vector3f GetGravity();
@@ -39,6 +40,11 @@ class ImuBuffer : public CircularBuffer<ImuData, 10>,
 
     ImuData GetOldestImuData() const { return buf_[tail_]; }
 
+    // of the newest sample, safe to call from any thread
+    long long LatestTimestamp() const {
+        return latest_timestamp_.load(std::memory_order_relaxed);
+    }
+
    private:
     ImuBuffer();
 
@@ -49,6 +55,9 @@ class ImuBuffer : public CircularBuffer<ImuData, 10>,
 
     std::mutex gravity_mutex_;
     Vector3f gravity_;
+    Vector3f gravity_filter_;  // low pass of acc, only used by the writer
+    bool gravity_filter_init_ = false;
+    std::atomic<long long> latest_timestamp_{0};
 };
 
 }  // namespace DeltaVins
\ No newline at end of file
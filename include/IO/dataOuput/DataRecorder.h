@@ -26,6 +26,8 @@ class DataRecorder : public DataSource::ImageObserver, public AbstractModule {
     std::string dat_dir_;
     FILE* imu_file_ = nullptr;
     FILE* cam_file_ = nullptr;
+    int imu_per_image_ = 0;
+    int imu_tail_ = -1;  // next imu to record
 
     std::thread* thread_ = nullptr;
     FrameAdapter* frame_adapter_ = nullptr;
@@ -0,0 +1,78 @@
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "utils/Metrics.h"
+#include "utils/Profiler.h"
+#include "utils/targetDefine.h"
+
+namespace DeltaVins {
+
+// what MetricsReporter hands to the exporters
+struct MetricsSnapshot {
+    double timestamp;  // unix time in s
+    std::vector<Metrics::Sample> metrics;
+    // latency of the profiled stages since start
+    std::vector<Profiler::Stats> stages;
+};
+
+/**
+ * @brief Destination of the metrics of a running estimator. Export() is
+ * only called on the thread of the MetricsReporter.
+ */
+class MetricsExporter {
+   public:
+    using Ptr = std::shared_ptr<MetricsExporter>;
+
+    virtual ~MetricsExporter() = default;
+    virtual void Export(const MetricsSnapshot& snapshot) = 0;
+
+    // Prometheus text format, the stages as summaries with quantile labels
+    static std::string FormatText(const MetricsSnapshot& snapshot);
+};
+
+/**
+ * @brief Rewrites a text file at every export. The text goes to a
+ * temporary file first and is renamed over the old one, so a scraper never
+ * reads half of it, e.g. the textfile collector of the node exporter.
+ */
+class MetricsFileExporter : public MetricsExporter {
+   public:
+    explicit MetricsFileExporter(const std::string& path);
+    void Export(const MetricsSnapshot& snapshot) override;
+
+   private:
+    std::string path_;
+};
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+/**
+ * @brief Serves the text of the latest export to everyone connecting to a
+ * unix domain socket, then closes the connection, e.g.
+ * `socat - UNIX-CONNECT:<path>`. A thread of its own accepts the
+ * connections, exports only swap the text.
+ */
+class MetricsSocketExporter : public MetricsExporter {
+   public:
+    explicit MetricsSocketExporter(const std::string& path);
+    ~MetricsSocketExporter();
+
+    void Export(const MetricsSnapshot& snapshot) override;
+
+   private:
+    void _Serve();
+
+    std::string path_;
+    int fd_ = -1;
+    std::atomic_bool running_{false};
+    std::thread thread_;
+    std::mutex mtx_text_;
+    std::string text_;  // guarded by mtx_text_
+};
+#endif
+
+}  // namespace DeltaVins
@@ -0,0 +1,42 @@
+#pragma once
+#include <chrono>
+#include <vector>
+
+#include "IO/dataOuput/MetricsExporter.h"
+#include "framework/abstractModule.h"
+
+namespace DeltaVins {
+
+/**
+ * @brief Takes a snapshot of the Metrics and the Profiler of its context
+ * every interval and hands it to the exporters, on a thread of its own so
+ * the pipeline never waits for a slow exporter. Adds the frame rate since
+ * the previous snapshot. The last snapshot is taken on Stop().
+ */
+class MetricsReporter : public AbstractModule {
+   public:
+    using Ptr = std::shared_ptr<MetricsReporter>;
+
+    explicit MetricsReporter(int interval_ms);
+    // the last snapshot needs the exporters, stop before they are gone
+    ~MetricsReporter() { Stop(); }
+
+    // before Start()
+    void AddExporter(MetricsExporter::Ptr exporter);
+
+    MetricsSnapshot TakeSnapshot();
+
+   private:
+    void RunThread() override;
+    bool HaveThingsTodo() override { return false; }
+    void DoWhatYouNeedToDo() override;
+
+    const std::chrono::milliseconds interval_;
+    std::vector<MetricsExporter::Ptr> exporters_;
+
+    // frames at the previous snapshot, for the frame rate
+    double last_frames_ = 0;
+    std::chrono::steady_clock::time_point last_time_;
+};
+
+}  // namespace DeltaVins
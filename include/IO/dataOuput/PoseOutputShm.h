@@ -0,0 +1,48 @@
+#pragma once
+#include "utils/targetDefine.h"
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+
+#include <FrameAdapter.h>
+#include <WorldPointAdapter.h>
+
+#include <memory>
+#include <string>
+
+#include "IO/dataOuput/ShmTransport.h"
+
+namespace DeltaVins {
+
+/**
+ * @brief Publishes what the visualizer would draw into a shared memory
+ * segment, see ShmTransport.h. Every push converts or copies straight into
+ * a slot of the segment: no encoding, no allocation, no socket on the
+ * thread of the estimator.
+ */
+class PoseOutputShm : public WorldPointAdapter, public FrameAdapter {
+   public:
+    using Ptr = std::shared_ptr<PoseOutputShm>;
+
+    PoseOutputShm(const std::string& name, const shm::Layout& layout);
+
+    void PushViewMatrix(std::vector<FrameGL>& v_Rcw) override;
+
+    // the first image of a frame goes to IMAGE0, the second to IMAGE1
+    void PushImageTexture(unsigned char* imageTexture, const int width,
+                          const int height, const int channels,
+                          const std::string& name) override;
+
+    void PushWorldPoint(const std::vector<WorldPointGL>& v_Point3f) override;
+
+    void FinishFrame() override;
+
+   private:
+    shm::ShmWriter writer_;
+    uint64_t frame_ = 0;
+    int image_index_ = 0;
+    bool warned_ = false;  // about something not fitting the segment
+};
+
+}  // namespace DeltaVins
+
+#endif
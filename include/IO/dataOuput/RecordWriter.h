@@ -0,0 +1,108 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <type_traits>
+
+#include "dataStructure/spscQueue.h"
+#include "framework/abstractModule.h"
+#include "utils/log.h"
+
+namespace DeltaVins {
+
+/**
+ * @brief Writes records to a file on its own thread, so a slow disk never
+ * stalls the estimator. Records are handed over through a lock-free queue,
+ * formatted in batches and flushed periodically and on Stop().
+ * @tparam Record POD copied through the queue
+ */
+template <typename Record>
+class RecordWriter : public AbstractModule {
+   public:
+    static_assert(std::is_trivially_copyable_v<Record>,
+                  "records are copied through a lock-free queue");
+
+    // appends the record to out, as text or as raw bytes
+    using FormatFn = std::function<void(const Record&, std::string& out)>;
+
+    // header: written once at the top of the file, e.g. csv column names
+    RecordWriter(const std::string& path, bool binary, FormatFn format,
+                 const std::string& header = "")
+        : format_(std::move(format)), queue_(QUEUE_SIZE) {
+        file_ = fopen(path.c_str(), binary ? "wb" : "w");
+        if (!file_) LOGE("Failed to open %s", path.c_str());
+        text_.reserve(1 << 16);
+        text_ = header;
+        last_flush_ = std::chrono::steady_clock::now();
+    }
+
+    ~RecordWriter() { Stop(); }
+
+    bool IsOpen() const { return file_ != nullptr; }
+
+    // producer thread, drops the record if the writer falls too far behind
+    void Write(const Record& record) {
+        // the writer polls the queue, so the producer never touches a lock
+        if (!queue_.Push(record)) dropped_++;
+    }
+
+    // drains the queue and closes the file
+    void Stop() override {
+        AbstractModule::Stop();
+        if (!file_) return;
+        DoWhatYouNeedToDo();
+        _Flush();
+        fclose(file_);
+        file_ = nullptr;
+        if (dropped_ > 0) {
+            LOGW("Record writer dropped %lld records", dropped_.load());
+        }
+    }
+
+   private:
+    static constexpr size_t QUEUE_SIZE = 4096;
+    static constexpr std::chrono::milliseconds FLUSH_PERIOD{500};
+
+    bool HaveThingsTodo() override { return !queue_.Empty(); }
+
+    void DoWhatYouNeedToDo() override {
+        Record record;
+        while (queue_.Pop(record)) {
+            if (file_) format_(record, text_);
+        }
+        if (file_ && !text_.empty()) {
+            fwrite(text_.data(), 1, text_.size(), file_);
+            text_.clear();
+        }
+    }
+
+    void RunThread() override {
+        while (keep_running_) {
+            {
+                std::unique_lock<std::mutex> ul(wake_up_mutex_);
+                wake_up_condition_variable_.wait_for(
+                    ul, FLUSH_PERIOD, [this]() { return !keep_running_; });
+            }
+            RunOnce();
+            if (std::chrono::steady_clock::now() - last_flush_ >=
+                FLUSH_PERIOD)
+                _Flush();
+        }
+    }
+
+    void _Flush() {
+        if (file_) fflush(file_);
+        last_flush_ = std::chrono::steady_clock::now();
+    }
+
+    FILE* file_ = nullptr;
+    FormatFn format_;
+    SpscQueue<Record> queue_;
+    std::string text_;  // formatted records not yet handed to the file
+    std::chrono::steady_clock::time_point last_flush_;
+    std::atomic<long long> dropped_{0};
+};
+
+}  // namespace DeltaVins
@@ -0,0 +1,175 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "utils/targetDefine.h"
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+
+namespace DeltaVins {
+
+/**
+ * Shared memory transport of the estimator output to local processes, e.g.
+ * a visualizer or a recorder. One POSIX shared memory segment holds a ring
+ * of fixed size slots per channel. Every slot is guarded by a seqlock: the
+ * writer makes the sequence odd, fills the slot and makes it even again, a
+ * reader copies the slot out and keeps the copy only if the sequence was
+ * even and did not change meanwhile. The writer never waits for a reader
+ * and never allocates; a slow reader just skips messages.
+ *
+ * Only this header and ShmTransport.cpp are needed to read, they depend on
+ * nothing else of the estimator.
+ */
+namespace shm {
+
+constexpr uint32_t MAGIC = 0x534d5644;  // "DVMS"
+constexpr uint32_t VERSION = 1;
+
+enum Channel : uint32_t {
+    POSES = 0,   // ShmFrame of the sliding window
+    POINTS = 1,  // ShmPoint of the slam points
+    IMAGE0 = 2,  // first image pushed in a frame, the left track image
+    IMAGE1 = 3,  // second image pushed in a frame, the right track image
+    NUM_CHANNELS = 4
+};
+
+// payload of POSES, same units as FrameGL
+struct ShmFrame {
+    int32_t id;
+    int32_t type;
+    float Twc[16];  // column major
+};
+
+// payload of POINTS, same units as WorldPointGL
+struct ShmPoint {
+    int32_t id;
+    float P[3];
+};
+
+// capacity of the segment, chosen by the writer
+struct Layout {
+    uint32_t slots = 4;  // per channel, >= 2 so a reader seldom collides
+    uint32_t max_frames = 256;
+    uint32_t max_points = 8192;
+    uint32_t max_image_bytes = 1280 * 1024 * 3;
+};
+
+// what the writer tells about a message
+struct MessageInfo {
+    uint64_t frame = 0;  // frames finished before, same for one frame
+    uint32_t size = 0;   // payload bytes
+    uint32_t count = 0;  // ShmFrame or ShmPoint in the payload
+    int32_t width = 0;   // of an image, pixels row by row
+    int32_t height = 0;
+    int32_t channels = 0;
+    char name[36] = {};  // of an image, null terminated
+};
+
+struct alignas(64) SlotHeader {
+    std::atomic<uint64_t> sequence;  // odd while the slot is written
+    MessageInfo info;
+};
+
+struct alignas(64) ChannelHeader {
+    std::atomic<uint64_t> published;  // messages, the last in slot n-1
+    uint64_t offset;                  // of slot 0 from the segment start
+    uint64_t slot_size;               // header and payload
+    uint32_t num_slots;
+    uint32_t capacity;  // payload bytes of a slot
+};
+
+struct alignas(64) SegmentHeader {
+    std::atomic<uint32_t> magic;  // set last by the writer
+    uint32_t version;
+    uint64_t size;                // of the segment
+    std::atomic<uint32_t> closed;  // writer gone, reopen for a new one
+    ChannelHeader channels[NUM_CHANNELS];
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the seqlock must not depend on a process local lock");
+
+/**
+ * @brief Owns the segment, unlinked again on destruction. Only one thread
+ * may write a channel, different channels may be written concurrently.
+ */
+class ShmWriter {
+   public:
+    ShmWriter() = default;
+    ~ShmWriter();
+    ShmWriter(const ShmWriter&) = delete;
+    ShmWriter& operator=(const ShmWriter&) = delete;
+
+    // replaces a segment of the same name left behind by a killed run
+    bool Create(const std::string& name, const Layout& layout);
+    bool IsOpen() const { return header_ != nullptr; }
+    uint32_t Capacity(Channel channel) const;
+
+    // payload of the next slot to be filled in place, nullptr if larger
+    // than the capacity; readers skip the slot until Publish()
+    uint8_t* Begin(Channel channel, uint32_t size);
+    void Publish(Channel channel, const MessageInfo& info);
+
+    // Begin(), one copy and Publish()
+    bool Write(Channel channel, const void* data, const MessageInfo& info);
+
+   private:
+    SlotHeader* _Slot(Channel channel, uint64_t index) const;
+
+    std::string name_;
+    uint8_t* base_ = nullptr;
+    SegmentHeader* header_ = nullptr;
+    int fd_ = -1;
+};
+
+/**
+ * @brief Maps a segment of a writer read only. Not thread safe, one reader
+ * per thread.
+ */
+class ShmReader {
+   public:
+    struct Message {
+        MessageInfo info;
+        std::vector<uint8_t> payload;
+
+        const ShmFrame* Frames() const {
+            return reinterpret_cast<const ShmFrame*>(payload.data());
+        }
+        const ShmPoint* Points() const {
+            return reinterpret_cast<const ShmPoint*>(payload.data());
+        }
+    };
+
+    ShmReader() = default;
+    ~ShmReader();
+    ShmReader(const ShmReader&) = delete;
+    ShmReader& operator=(const ShmReader&) = delete;
+
+    // false while no writer has created the segment yet
+    bool Open(const std::string& name);
+    void Close();
+    bool IsOpen() const { return header_ != nullptr; }
+    // the writer has gone, a new one creates a new segment
+    bool WriterClosed() const;
+
+    uint64_t Published(Channel channel) const;
+
+    // newest message of the channel not read before, false if there is
+    // none or the writer kept overwriting it; message keeps its capacity
+    bool ReadLatest(Channel channel, Message& message);
+
+   private:
+    const uint8_t* base_ = nullptr;
+    const SegmentHeader* header_ = nullptr;
+    size_t size_ = 0;
+    int fd_ = -1;
+    uint64_t last_read_[NUM_CHANNELS] = {};
+};
+
+}  // namespace shm
+}  // namespace DeltaVins
+
+#endif
@@ -0,0 +1,54 @@
+#pragma once
+#include <string>
+
+#include "IO/dataOuput/RecordWriter.h"
+#include "utils/PerfCounters.h"
+
+namespace DeltaVins {
+
+// what one frame cost and why, to correlate latency spikes with workload
+struct FrameTelemetry {
+    long long timestamp;
+    // time of the stages in this frame, 0 with ENABLE_PROFILER=0
+    float add_frame_ms;
+    float propagate_ms;
+    float track_ms;
+    float margin_ms;
+    float data_association_ms;
+    float stack_ms;
+    float solve_ms;
+    int tracked_features;     // landmarks tracked from the last frame
+    int new_features;         // landmarks detected in this frame
+    int msckf_points;         // msckf points used in the update
+    int slam_points;          // slam points in the state
+    int stacked_rows;         // rows of the stacked measurement matrix
+    int state_dim;            // dimension of the filter state
+    int marginalized_frames;  // frames removed from the window
+    int dropped_frames;       // images overwritten in the full image buffer
+    int queue_depth;          // images waiting behind this one
+    // hardware counters of the stages in this frame, 0 without
+    // Config::PerfCounters
+    PerfCounters::Values track_counters;
+    PerfCounters::Values margin_counters;
+    PerfCounters::Values data_association_counters;
+    PerfCounters::Values solve_counters;
+    // heap allocations of the VIO thread in this frame and heap in use by
+    // the process, 0 without ENABLE_ALLOC_TRACKING
+    long long allocations;
+    long long live_bytes;
+    long long peak_rss_kb;  // of the process so far
+};
+
+/**
+ * @brief Writes one FrameTelemetry per frame, as csv with a header line or
+ * as the raw structs.
+ */
+class TelemetryWriter : public RecordWriter<FrameTelemetry> {
+   public:
+    TelemetryWriter(const std::string& path, bool binary);
+
+   private:
+    static void _FormatCsv(const FrameTelemetry& record, std::string& out);
+};
+
+}  // namespace DeltaVins
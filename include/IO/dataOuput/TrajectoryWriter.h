@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+
+#include "IO/dataOuput/RecordWriter.h"
+#include "utils/Config.h"
+
+namespace DeltaVins {
+
+// one pose of the body in the world frame
+struct TrajectoryRecord {
+    long long timestamp;
+    float position[3];
+    float rotation[4];  // quaternion w, x, y, z
+    float velocity[3];
+    float gyro_bias[3];
+    float acc_bias[3];
+};
+
+/**
+ * @brief Writes the estimated trajectory in one of the ResultOutputFormats.
+ */
+class TrajectoryWriter : public RecordWriter<TrajectoryRecord> {
+   public:
+    using Record = TrajectoryRecord;
+
+    TrajectoryWriter(const std::string& path, ResultOutputFormat format);
+
+   private:
+    static void _Format(ResultOutputFormat format, const Record& record,
+                        std::string& out);
+};
+
+}  // namespace DeltaVins
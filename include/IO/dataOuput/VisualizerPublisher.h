@@ -0,0 +1,81 @@
+#pragma once
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <opencv2/core.hpp>
+#include <vector>
+
+#include "FrameAdapter.h"
+#include "WorldPointAdapter.h"
+#include "dataStructure/sensorStructure.h"
+#include "framework/abstractModule.h"
+#include "utils/basicTypes.h"
+
+namespace DeltaVins {
+
+// what the visualizer shows of a frame, taken on the VIO thread
+struct VisualSnapshot {
+    using Ptr = std::unique_ptr<VisualSnapshot>;
+
+    // the newest observations of a track in one camera
+    struct Track {
+        static constexpr int MAX_PX = 6;
+        cv::Scalar color;
+        int cam_id;
+        int num_px;
+        Vector2f px[MAX_PX];  // newest first
+        Vector2f last_px;     // of the last observation, circled
+    };
+
+    long long timestamp = 0;
+    int num_cams = 1;
+    cv::Mat images[2];          // gray, never written
+    ImageData::Ptr image_data;  // keeps pooled images from being reused
+    int num_tracked[2] = {0, 0};
+    std::vector<Track> tracks;
+    bool has_map = false;  // frames and points below were taken
+    std::vector<FrameGL> frames;
+    std::vector<WorldPointGL> points;
+};
+
+/**
+ * @brief Hands the snapshots of the VIO thread to the adapters of the
+ * visualizer on a thread of its own, which draws the track images. The VIO
+ * thread only takes a snapshot every 1 / fps of sensor time and never waits:
+ * a snapshot not drawn yet is replaced by the next one. The snapshots are
+ * recycled, taking one does not allocate once the vectors have grown.
+ */
+class VisualizerPublisher : public AbstractModule {
+   public:
+    VisualizerPublisher(FrameAdapter* frame_adapter,
+                        WorldPointAdapter* world_point_adapter, int fps);
+    // the thread uses the members, stop it before they are gone
+    ~VisualizerPublisher() { Stop(); }
+
+    // VIO thread: snapshot to fill for the frame, nullptr to skip the frame
+    VisualSnapshot::Ptr Acquire(long long timestamp);
+    // VIO thread
+    void Publish(VisualSnapshot::Ptr snapshot);
+
+    // BGR image of a camera with its tracks
+    static void DrawTrackImage(const VisualSnapshot& snapshot, int cam_id,
+                               cv::Mat& image);
+
+   private:
+    void RunThread() override;
+    bool HaveThingsTodo() override;
+    void DoWhatYouNeedToDo() override;
+
+    FrameAdapter* frame_adapter_;
+    WorldPointAdapter* world_point_adapter_;
+    const long long period_ns_;                 // sensor time per snapshot
+    const std::chrono::milliseconds interval_;  // between two draws
+    long long next_timestamp_ = 0;              // VIO thread only
+
+    std::mutex mtx_snapshot_;
+    VisualSnapshot::Ptr latest_;              // guarded by mtx_snapshot_
+    std::vector<VisualSnapshot::Ptr> spare_;  // guarded by mtx_snapshot_
+    cv::Mat track_images_[2];                 // reused by the thread
+};
+
+}  // namespace DeltaVins
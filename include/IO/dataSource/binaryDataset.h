@@ -0,0 +1,112 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "dataStructure/sensorStructure.h"
+
+namespace DeltaVins {
+
+/**
+ * Single-file binary dataset, replayed by DataSource_Binary through mmap.
+ *
+ * Layout:
+ *   BinaryDatasetHeader
+ *   image blobs, each aligned to BINARY_DATASET_ALIGNMENT
+ *   BinaryImageRecord[num_images]
+ *   BinaryImuRecord[num_imus]
+ *   OdometerData[num_odometers]
+ *   NavSatFixData[num_gnss]
+ * All records are sorted by timestamp.
+ */
+constexpr char BINARY_DATASET_MAGIC[8] = {'D', 'V', 'I', 'O',
+                                          'B', 'I', 'N', '\0'};
+constexpr uint32_t BINARY_DATASET_VERSION = 1;
+constexpr uint64_t BINARY_DATASET_ALIGNMENT = 64;
+
+enum class BinaryImageEncoding : uint32_t {
+    Raw8U = 0,  // rows * cols bytes, replayed without copy
+    PNG = 1,    // encoded bytes, decoded on replay
+};
+
+struct BinaryDatasetHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t num_images;
+    uint32_t num_imus;
+    uint32_t num_odometers;
+    uint32_t num_gnss;
+    // sizes of the records, to reject files written by an incompatible build
+    uint32_t imu_record_size;
+    uint32_t odometer_record_size;
+    uint32_t gnss_record_size;
+    uint64_t image_index_offset;
+    uint64_t imu_offset;
+    uint64_t odometer_offset;
+    uint64_t gnss_offset;
+};
+
+struct BinaryImageRecord {
+    int64_t timestamp;
+    uint64_t offset;
+    uint64_t size;
+    int32_t rows;
+    int32_t cols;
+    int32_t sensor_id;
+    BinaryImageEncoding encoding;
+};
+
+struct BinaryImuRecord {
+    int64_t timestamp;
+    int32_t sensor_id;
+    float gyro[3];
+    float acc[3];
+    int32_t reserved;
+};
+
+static_assert(std::is_trivially_copyable<OdometerData>::value,
+              "OdometerData is stored as is");
+static_assert(std::is_trivially_copyable<NavSatFixData>::value,
+              "NavSatFixData is stored as is");
+
+/**
+ * @brief Check that the header, every section and every image of a binary
+ * dataset of size bytes lie within it, before any record is read.
+ * @return false with the reason in error otherwise
+ */
+bool ValidateBinaryDataset(const uchar* data, size_t size, std::string& error);
+
+/**
+ * @brief Streaming writer of the binary dataset, images are written as they
+ * come so long sequences never need to be held in memory.
+ */
+class BinaryDatasetWriter {
+   public:
+    explicit BinaryDatasetWriter(const std::string& path);
+    ~BinaryDatasetWriter();
+
+    void AddImage(int64_t timestamp, const cv::Mat& image, int sensor_id = 0);
+    void AddEncodedImage(int64_t timestamp, const std::vector<uchar>& bytes,
+                         int rows, int cols, BinaryImageEncoding encoding,
+                         int sensor_id = 0);
+    void AddImu(const ImuData& imu);
+    void AddOdometer(const OdometerData& odometer);
+    void AddNavSatFix(const NavSatFixData& nav_sat_fix);
+
+    // write the index and the header, called by the destructor as well
+    void Close();
+
+   private:
+    void _Write(const void* data, size_t size);
+    void _Align();
+
+    FILE* file_ = nullptr;
+    uint64_t offset_ = 0;
+    std::vector<BinaryImageRecord> images_;
+    std::vector<BinaryImuRecord> imus_;
+    std::vector<OdometerData> odometers_;
+    std::vector<NavSatFixData> gnss_;
+};
+
+}  // namespace DeltaVins
@@ -1,8 +1,11 @@
 #pragma once
+#include <chrono>
+#include <climits>
 #include <opencv2/opencv.hpp>
 
 #include "dataStructure/IO_Structures.h"
 #include "framework/abstractModule.h"
+#include "utils/Config.h"
 
 namespace DeltaVins {
 
@@ -79,6 +82,42 @@ class DataSource : public AbstractModule {
     }
 
    protected:
+    // sensors run this far ahead of the images in free running replay
+    static constexpr long long SENSOR_LOOKAHEAD_NS = 50000000;
+
+    /**
+     * @brief Whether the next sample of a sensor stream has to be delivered
+     * before the image. With Config::DeterministicReplay the virtual clock is
+     * the sensor time: samples are delivered in timestamp order up to the
+     * first one at or after the image, which interpolation at the image time
+     * needs, so nothing ever waits on the wall clock.
+     * @param last_sample timestamp of the last delivered sample of the stream
+     */
+    static bool _DueBeforeImage(long long last_sample, long long sample,
+                                long long image) {
+        if (Config::Instance().DeterministicReplay) return last_sample < image;
+        return sample < image + SENSOR_LOOKAHEAD_NS;
+    }
+
+    // sleep until the frame is due according to Config::Instance().PlaybackRate
+    void _WaitForPlaybackTime(long long timestamp) {
+        if (Config::Instance().PlaybackRate <= 0) return;
+        auto now = std::chrono::steady_clock::now();
+        if (playback_start_timestamp_ < 0) {
+            playback_start_timestamp_ = timestamp;
+            playback_start_time_ = now;
+            return;
+        }
+        auto due = playback_start_time_ +
+                   std::chrono::nanoseconds(static_cast<long long>(
+                       (timestamp - playback_start_timestamp_) /
+                       Config::Instance().PlaybackRate));
+        if (due > now) {
+            PROFILE_SCOPE("PlaybackWait");
+            std::this_thread::sleep_until(due);
+        }
+    }
+
     std::vector<ImuObserver*> imu_observers_;
     std::vector<ImageObserver*> image_observers_;
     std::vector<NavSatFixObserver*> nav_sat_fix_observers_;
@@ -87,6 +126,8 @@ class DataSource : public AbstractModule {
     std::mutex mtx_image_observer_;
     std::mutex mtx_nav_sat_fix_observer_;
     std::mutex mtx_odometer_observer_;
+    long long playback_start_timestamp_ = -1;
+    std::chrono::steady_clock::time_point playback_start_time_;
 };
 
 }  // namespace DeltaVins
\ No newline at end of file
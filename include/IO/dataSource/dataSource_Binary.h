@@ -0,0 +1,35 @@
+#pragma once
+#include "binaryDataset.h"
+#include "dataSource.h"
+
+namespace DeltaVins {
+
+/**
+ * @brief Replays a binary dataset (see binaryDataset.h) from a read-only
+ * memory map. Raw images are handed out as cv::Mat headers on the mapping.
+ */
+class DataSource_Binary : public DataSource {
+   public:
+    DataSource_Binary();
+    ~DataSource_Binary();
+
+   private:
+    void _Map(const std::string& path);
+    bool HaveThingsTodo() override;
+    void DoWhatYouNeedToDo() override;
+
+    const uchar* data_ = nullptr;
+    size_t size_ = 0;
+    const BinaryDatasetHeader* header_ = nullptr;
+    const BinaryImageRecord* images_ = nullptr;
+    const BinaryImuRecord* imus_ = nullptr;
+    const OdometerData* odometers_ = nullptr;
+    const NavSatFixData* gnss_ = nullptr;
+
+    size_t image_idx_;
+    size_t imu_index_ = 0;
+    size_t odometer_index_ = 0;
+    size_t gnss_index_ = 0;
+};
+
+}  // namespace DeltaVins
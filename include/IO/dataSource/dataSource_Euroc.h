@@ -1,6 +1,10 @@
 #pragma once
+#include <memory>
+
 #include "dataSource.h"
 #include "dataStructure/IO_Structures.h"
+#include "imagePrefetcher.h"
+#include "utils/CsvReader.h"
 
 namespace DeltaVins {
 
@@ -10,7 +14,8 @@ class DataSource_Euroc : public DataSource {
     ~DataSource_Euroc();
 
    private:
-    void _LoadIMU();
+    // IMU rows are streamed from the csv while replaying
+    bool _ReadNextImu();
     void _LoadImage();
     bool HaveThingsTodo() override;
     void DoWhatYouNeedToDo() override;
@@ -18,9 +23,12 @@ class DataSource_Euroc : public DataSource {
     std::string cam_dir_;
     std::string imu_dir_;
     size_t image_idx_;
-    size_t imu_index_;
     std::vector<_ImageData> images_;
-    std::vector<ImuData> imus_;
+    std::unique_ptr<CsvReader> imu_reader_;
+    ImuData next_imu_;
+    bool has_next_imu_ = false;
+    long long last_imu_timestamp_ = LLONG_MIN;
+    std::unique_ptr<ImagePrefetcher> image_prefetcher_;
 };
 
 }  // namespace DeltaVins
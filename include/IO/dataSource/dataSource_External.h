@@ -0,0 +1,30 @@
+#pragma once
+#include "dataSource.h"
+
+namespace DeltaVins {
+
+/**
+ * @brief Data source fed by the embedding process through the push API of
+ * slamAPI.h. Samples are handed to the observers on the calling thread, so
+ * the caller has to bind the context of the system (see VioContext).
+ */
+class DataSource_External : public DataSource {
+   public:
+    DataSource_External() {}
+    ~DataSource_External() {}
+
+    void PushImu(const ImuData& imuData);
+    // blocks until the frame is processed with Config::SerialRun
+    void PushImage(const ImageData::Ptr imageData);
+    void PushOdometer(const OdometerData& odometerData);
+
+   private:
+    // nothing to poll, the caller drives the data flow
+    bool HaveThingsTodo() override { return false; }
+    void DoWhatYouNeedToDo() override {}
+
+    long long last_imu_timestamp_ = -1;    // guarded by mtx_imu_observer_
+    long long last_image_timestamp_ = -1;  // guarded by mtx_image_observer_
+};
+
+}  // namespace DeltaVins
@@ -63,6 +63,9 @@ class DataSource_ROS2 : public DataSource, public rclcpp::Node {
     // for data synchronization
     // only used when acc and gyro messages are separate
     float imu_gyro_interval_{1.f};
+    std::deque<std::pair<int64_t, Eigen::Vector3f>> acc_buff_;
+    std::deque<std::pair<int64_t, Eigen::Vector3f>> gyro_buff_;
+    std::mutex mtx_buff_;
 
     bool is_bag_;
     std::shared_ptr<rosbag2_cpp::Reader> reader_;
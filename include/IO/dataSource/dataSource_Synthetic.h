@@ -17,6 +17,7 @@ class DataSource_Synthetic : public DataSource {
     std::string imu_dir_;
     size_t image_idx_;
     size_t imu_index_;
+    long long last_timestamp_ = -1;  // of the generated images
     std::vector<_ImageData> images_;
     std::vector<ImuData> imus_;
 };
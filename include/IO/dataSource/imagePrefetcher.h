@@ -0,0 +1,66 @@
+#pragma once
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "IO/dataSource/dataSource.h"
+
+namespace DeltaVins {
+
+/**
+ * @brief Read-ahead image loader for file based data sources.
+ *
+ * A small pool of workers decodes the next images into reused buffers while
+ * the data source thread replays the previous ones. Pop() hands the images
+ * out strictly in timestamp order. The image is a pooled buffer which goes
+ * back to the pool when the last ImageData::Ptr is released, so whoever
+ * reads the pixels later holds the ImageData, not only its cv::Mat.
+ */
+class ImagePrefetcher {
+   public:
+    ImagePrefetcher(const std::vector<DataSource::_ImageData>& images,
+                    size_t start_idx, int read_ahead, int num_threads,
+                    int max_width = 640);
+    ~ImagePrefetcher();
+
+    // blocks until the next image is decoded
+    ImageData::Ptr Pop();
+
+   private:
+    struct Slot {
+        size_t index = 0;
+        bool ready = false;
+        ImageData::Ptr data;
+        std::vector<uchar> file_buffer;
+        cv::Mat decoded;
+    };
+
+    // buffers of released images, shared with the deleters of the images
+    // which may outlive the prefetcher
+    struct BufferPool {
+        std::mutex mtx;
+        std::vector<cv::Mat> free;
+    };
+
+    void _WorkerLoop();
+    void _Load(size_t index, Slot& slot);
+    cv::Mat _AcquireBuffer(int rows, int cols);
+
+    const std::vector<DataSource::_ImageData>& images_;
+    const int max_width_;
+    std::vector<Slot> slots_;
+    size_t next_to_load_;
+    size_t next_to_pop_;
+    bool stop_ = false;
+
+    std::mutex mtx_;
+    std::condition_variable cv_loaded_;
+    std::condition_variable cv_free_;
+    std::vector<std::thread> workers_;
+
+    std::shared_ptr<BufferPool> buffer_pool_;
+};
+
+}  // namespace DeltaVins
@@ -1,4 +1,5 @@
 #pragma once
+#include <atomic>
 #include <memory>
 
 #include "utils/typedefs.h"
@@ -25,7 +26,7 @@ struct PointState {
     int m_id = 0;  // only used in visualizer
     int m_idVis = -1;
     PointState() {
-        static int counter = 0;
+        static std::atomic_int counter{0};
         m_id = counter++;
         flag_slam_point = false;
     }
@@ -46,7 +47,7 @@ struct CamState {
     int m_id = 0;  // only used in visualizer
 
     CamState() {
-        static int counter = 0;
+        static std::atomic_int counter{0};
         m_id = counter++;
     }
 };
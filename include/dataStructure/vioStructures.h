@@ -60,7 +60,7 @@ struct Frame {
     using Ptr = std::shared_ptr<Frame>;
 };
 
-struct Landmark : public NonLinear_LM<3, double> {
+struct Landmark {
     EIGEN_MAKE_ALIGNED_OPERATOR_NEW
 
     struct VisualObservationComparator {
@@ -95,8 +95,7 @@ struct Landmark : public NonLinear_LM<3, double> {
     PointState* point_state_;  // pointer to point state
     Frame* host_frame;
     bool flag_slam_point_candidate;
-    std::vector<Matrix3d> dRs[2];  // used in Triangulate
-    std::vector<Vector3d> dts[2];
+    LM_Result m_Result;  // result of the last triangulation
 
     void SetDeadFlag(bool dead, int cam_id);  // -1: all, 0: left, 1: right
 
@@ -115,14 +114,11 @@ struct Landmark : public NonLinear_LM<3, double> {
     void RemoveUselessObservationForSlamPoint();
 
     // Triangulation
-    bool UserDefinedConvergeCriteria() override;
     void PrintPositions();
     bool Triangulate();
     bool TriangulateLM(float depth_prior);
     bool TriangulationAnchorDepth(float& anchor_depth);
     bool StereoTriangulate();
-    double EvaluateF(bool bNewZ, double huberThresh) override;
-    bool UserDefinedDecentFail() override;
     using Ptr = std::shared_ptr<Landmark>;
 };
 
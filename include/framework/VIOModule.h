@@ -7,12 +7,22 @@
 #include "IO/dataSource/dataSource.h"
 #include "abstractModule.h"
 namespace DeltaVins {
+class ImageBuffer;
 
-class VIOModule : public AbstractModule, public DataSource::ImageObserver {
+class VIOModule : public AbstractModule,
+                  public DataSource::ImageObserver,
+                  public DataSource::ImuObserver {
    public:
     using Ptr = std::shared_ptr<VIOModule>;
     struct PoseObserver {
+        // filtered pose of every frame
         virtual void OnPoseAvailable(const Pose& pose) = 0;
+        // pose propagated to each imu sample with Config::ImuRatePose, called
+        // on the data source thread between frames and on the VIO thread
+        // right after an update
+        virtual void OnPropagatedPoseAvailable(const Pose& pose) {
+            (void)pose;
+        }
     };
 
    public:
@@ -20,14 +30,23 @@ class VIOModule : public AbstractModule, public DataSource::ImageObserver {
     ~VIOModule();
 
     void OnImageReceived(const ImageData::Ptr imageData) override;
+    // feeds the imu rate propagation, only registered with ImuRatePose
+    void OnImuReceived(const ImuData& imuData) override;
 
     void SetFrameAdapter(FrameAdapter* adapter);
     void SetPointAdapter(WorldPointAdapter* adapter);
+    // also writes out the results
+    void Stop() override;
+    // called on the VIO thread, add observers before Start()
+    void AddPoseObserver(PoseObserver* observer);
 
    private:
     bool HaveThingsTodo() override;
     void DoWhatYouNeedToDo() override;
     VIOAlgorithm vio_algorithm_;
+    ImuPropagator imu_propagator_;
+    ImageBuffer& image_buffer_;
+    int image_counter_ = 0;
 
     std::vector<PoseObserver*> pose_observers_;
 };
@@ -0,0 +1,104 @@
+#pragma once
+#include <memory>
+#include <mutex>
+#include <typeindex>
+#include <typeinfo>
+#include <unordered_map>
+
+namespace DeltaVins {
+
+struct Config;
+class SensorConfig;
+class ImuBuffer;
+class ImageBuffer;
+class OdometerBuffer;
+class GnssBuffer;
+class Profiler;
+class Metrics;
+template <typename T>
+class Tfs;
+
+/**
+ * @brief Everything one estimator shares between its modules: configs,
+ * sensor buffers, transforms, timers, metrics and the state of modules
+ * without an object of their own. Several contexts can run side by side in
+ * one process.
+ *
+ * The Instance() accessors resolve to the context bound to the calling
+ * thread, or to the default context when none is bound. Modules bind the
+ * context they were created in to their threads, so the algorithm code
+ * never has to pass it around.
+ */
+class VioContext {
+   public:
+    VioContext();
+    ~VioContext();
+
+    VioContext(const VioContext&) = delete;
+    VioContext& operator=(const VioContext&) = delete;
+
+    // context of the calling thread
+    static VioContext& Current();
+    // context of threads which never bound one
+    static VioContext& Default();
+    // context bound to the calling thread, nullptr if none is
+    static const VioContext* Bound();
+
+    // binds a context to the calling thread for its lifetime
+    class Scope {
+       public:
+        explicit Scope(VioContext* context);
+        ~Scope();
+
+        Scope(const Scope&) = delete;
+        Scope& operator=(const Scope&) = delete;
+
+       private:
+        VioContext* previous_;
+    };
+
+    Config& GetConfig() { return *config_; }
+    SensorConfig& GetSensorConfig() { return *sensor_config_; }
+    Tfs<float>& GetTfs() { return *tfs_; }
+    Profiler& GetProfiler() { return *profiler_; }
+    Metrics& GetMetrics() { return *metrics_; }
+
+    // buffers read the config on construction, create them on first use
+    ImuBuffer& GetImuBuffer();
+    ImageBuffer& GetImageBuffer();
+    OdometerBuffer& GetOdometerBuffer();
+    GnssBuffer& GetGnssBuffer();
+
+    /**
+     * @brief State of a module that is not a class, e.g. the globals of the
+     * data association. One default constructed T per context.
+     */
+    template <typename T>
+    T& GetState() {
+        std::lock_guard<std::mutex> lck(mtx_states_);
+        auto& state = states_[std::type_index(typeid(T))];
+        if (!state) state = std::make_shared<T>();
+        return *static_cast<T*>(state.get());
+    }
+
+   private:
+    std::unique_ptr<Config> config_;
+    std::unique_ptr<SensorConfig> sensor_config_;
+    std::unique_ptr<Tfs<float>> tfs_;
+    std::unique_ptr<Profiler> profiler_;
+    std::unique_ptr<Metrics> metrics_;
+
+    std::once_flag imu_buffer_once_;
+    std::once_flag image_buffer_once_;
+    std::once_flag odometer_buffer_once_;
+    std::once_flag gnss_buffer_once_;
+    std::unique_ptr<ImuBuffer> imu_buffer_;
+    std::unique_ptr<ImageBuffer> image_buffer_;
+    std::unique_ptr<OdometerBuffer> odometer_buffer_;
+    std::unique_ptr<GnssBuffer> gnss_buffer_;
+
+    std::mutex mtx_states_;
+    std::unordered_map<std::type_index, std::shared_ptr<void>> states_;
+};
+
+}  // namespace DeltaVins
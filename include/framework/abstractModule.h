@@ -1,14 +1,24 @@
 #pragma once
+#include <cxxabi.h>
+
 #include <atomic>
 #include <condition_variable>
+#include <cstdlib>
 #include <mutex>
+#include <string>
 #include <thread>
+#include <typeinfo>
+
+#include "framework/VioContext.h"
+#include "utils/Profiler.h"
 
 namespace DeltaVins {
 
 class AbstractModule {
    public:
-    AbstractModule() { keep_running_.store(true); }
+    AbstractModule() : context_(&VioContext::Current()) {
+        keep_running_.store(true);
+    }
 
     virtual ~AbstractModule() {
         Stop();
@@ -42,11 +52,14 @@ class AbstractModule {
 
     void WakeUpAndWait() {
         std::unique_lock<std::mutex> lck(serial_mutex_);
+        serial_done_ = false;
         {
             std::lock_guard<std::mutex> lk(wake_up_mutex_);
             wake_up_condition_variable_.notify_one();
         }
-        serial_condition_variable_.wait(lck);
+        // predicate guards against spurious wake ups, which would let the
+        // producer run ahead and make serial runs non-deterministic
+        serial_condition_variable_.wait(lck, [this]() { return serial_done_; });
     }
 
     virtual void RunThread() {
@@ -60,12 +73,13 @@ class AbstractModule {
             }
             // do something when wake up
             while (HaveThingsTodo() && this->keep_running_) {
-                DoWhatYouNeedToDo();
+                RunOnce();
             }
         }
     }
 
    protected:
+    VioContext* context_;  // context the module was created in
     std::thread* modules_thread_ = nullptr;
     std::mutex wake_up_mutex_;
     std::mutex serial_mutex_;
@@ -74,17 +88,41 @@ class AbstractModule {
     std::atomic_bool keep_running_;
     bool run_ = false;
     bool detached_ = false;
+    bool serial_done_ = true;  // guarded by serial_mutex_
+    int profile_section_ = -1;
 
     virtual bool HaveThingsTodo() = 0;
     virtual void DoWhatYouNeedToDo() = 0;
 
+    // DoWhatYouNeedToDo, profiled under the name of the module
+    void RunOnce() {
+#if ENABLE_PROFILER
+        ProfileScope scope(profile_section_);
+#endif
+        DoWhatYouNeedToDo();
+    }
+
+    // class name of the module without the namespace
+    std::string ModuleName() const {
+        int status = 0;
+        const char* mangled = typeid(*this).name();
+        char* demangled =
+            abi::__cxa_demangle(mangled, nullptr, nullptr, &status);
+        std::string name = status == 0 ? demangled : mangled;
+        free(demangled);
+        const auto pos = name.rfind("::");
+        return pos == std::string::npos ? name : name.substr(pos + 2);
+    }
+
     void WaitForThingsToBeDone() {
         std::unique_lock<std::mutex> lck(serial_mutex_);
-        serial_condition_variable_.wait(lck);
+        serial_done_ = false;
+        serial_condition_variable_.wait(lck, [this]() { return serial_done_; });
     }
 
     void TellOthersThingsToBeDone() {
         std::unique_lock<std::mutex> ul(serial_mutex_);
+        serial_done_ = true;
         serial_condition_variable_.notify_all();
     }
 
@@ -107,7 +145,15 @@ class AbstractModule {
         if (run_) return;
         keep_running_.store(true);
 
-        modules_thread_ = new std::thread([&]() { this->RunThread(); });
+        modules_thread_ = new std::thread([&]() {
+            VioContext::Scope scope(context_);
+#if ENABLE_PROFILER
+            const std::string name = ModuleName();
+            profile_section_ = Profiler::Register(name.c_str());
+            context_->GetProfiler().NameThread(name);
+#endif
+            this->RunThread();
+        });
         run_ = true;
     }
 
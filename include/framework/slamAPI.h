@@ -4,10 +4,91 @@
 extern "C" {
 #endif
 
+// single system in the default context
 bool InitSlamSystem(const char* configFile);
 void StartAndJoin();
 void StopSystem();
 
+// independent systems, each with its own buffers, configs and state, so
+// several of them can run in one process. StartAndJoinSlamSystem blocks
+// until the data source is exhausted, run it on one thread per system.
+typedef struct VioSystem* VioHandle;
+
+// returns NULL if the config can not be loaded
+VioHandle CreateSlamSystem(const char* configFile);
+
+// settings of CreateSlamSystemEx, NULL members keep those of the config
+typedef struct {
+    const char* data_source_path;    // replaces DataSourcePath
+    const char* result_output_path;  // replaces ResultOutputPath
+    // messages of the system instead of the console, ignored with ROS2
+    // logging, which has no sink per system
+    const char* log_file;
+    // process-wide outputs of the config, which concurrent systems can not
+    // share: nonzero no_gui turns off the visualizer, the names move the
+    // metrics exports the config turns on and the shared memory segment
+    int no_gui;
+    const char* metrics_file;        // replaces a MetricsFile
+    const char* metrics_socket;      // replaces a MetricsSocket
+    const char* shm_transport_name;  // replaces ShmTransportName
+} VioSystemOptions;
+
+// as CreateSlamSystem, e.g. to run one config on many sequences at once
+VioHandle CreateSlamSystemEx(const char* configFile,
+                             const VioSystemOptions* options);
+void StartAndJoinSlamSystem(VioHandle handle);
+// stops the system and releases everything it owns
+void DestroySlamSystem(VioHandle handle);
+
+// Embedding: with DataSourceType "External" the caller feeds the sensors.
+// StartSlamSystem starts the modules and returns, the Push functions may then
+// be called from the driver threads. Timestamps are in ns and increasing per
+// sensor, samples out of order are dropped.
+bool StartSlamSystem(VioHandle handle);
+
+// gyro in rad/s and acc in m/s^2 of the imu frame
+void PushImu(VioHandle handle, long long timestamp, const float gyro[3],
+             const float acc[3]);
+
+// Called once the system no longer reads a pushed image, possibly on another
+// thread than the one which pushed it.
+typedef void (*VioReleaseCallback)(void* user_data);
+
+// 8 bit gray image of the calibrated size borrowed until release is called,
+// stride in bytes. An image with padded rows (stride > width) is copied and
+// released before the call returns. Blocks until the frame is processed with
+// SerialRun, returns false if the system has no external data source or the
+// image does not match the camera.
+bool PushImage(VioHandle handle, long long timestamp, const unsigned char* data,
+               int width, int height, int stride, VioReleaseCallback release,
+               void* user_data);
+// both images of a stereo pair with the same layout, released together
+bool PushStereoImage(VioHandle handle, long long timestamp,
+                     const unsigned char* left, const unsigned char* right,
+                     int width, int height, int stride,
+                     VioReleaseCallback release, void* user_data);
+
+// forward velocity in m/s and yaw rate in rad/s of the body
+void PushOdometer(VioHandle handle, long long timestamp, float velocity,
+                  float angular_velocity);
+
+// body pose in the world frame
+typedef struct {
+    long long timestamp;
+    float position[3];
+    float rotation[4];  // quaternion w, x, y, z
+} VioPose;
+
+// newest pose, propagated to the last imu sample with ImuRatePose. Returns
+// false until the system is initialized.
+bool GetLatestPose(VioHandle handle, VioPose* pose);
+
+// called for every estimated pose, keep it short. With ImuRatePose also for
+// every imu sample, then possibly on the thread which delivers the imu.
+typedef void (*VioPoseCallback)(const VioPose* pose, void* user_data);
+void SetPoseCallback(VioHandle handle, VioPoseCallback callback,
+                     void* user_data);
+
 #ifdef __cplusplus
 }
-#endif
\ No newline at end of file
+#endif
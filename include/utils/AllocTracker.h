@@ -0,0 +1,55 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// build with -DENABLE_ALLOC_TRACKING=1 to replace malloc and count the heap
+#ifndef ENABLE_ALLOC_TRACKING
+#define ENABLE_ALLOC_TRACKING 0
+#endif
+
+namespace DeltaVins {
+
+/**
+ * @brief Heap usage of the process by profiled stage.
+ *
+ * With ENABLE_ALLOC_TRACKING the library replaces malloc and its family
+ * (glibc only), so operator new, Eigen and OpenCV allocations are all
+ * seen. Every block is charged to the innermost PROFILE_SCOPE of the
+ * allocating thread, or to "Other" outside of any, and credited back to
+ * that section when freed, on whatever thread. Blocks carry a 16 byte
+ * header and realloc always copies, so this is meant for benchmarks and
+ * soak tests, not for deployment.
+ */
+class AllocTracker {
+   public:
+    struct Stats {
+        std::string name;
+        uint64_t allocations;      // since start
+        uint64_t allocated_bytes;  // since start
+        int64_t live_blocks;
+        int64_t live_bytes;
+    };
+
+    // whether this build replaces the allocator
+    static constexpr bool Enabled() { return ENABLE_ALLOC_TRACKING; }
+
+    // charges the allocations of the calling thread to a profiler section,
+    // -1 for none, and returns the previous one; see ProfileScope
+    static int SwapSection(int section);
+
+    // of the whole process
+    static uint64_t Allocations();
+    static int64_t LiveBytes();
+    // allocations of the calling thread since its last call, e.g. per frame
+    static uint64_t TakeThreadAllocations();
+
+    // sections which ever allocated, the most live bytes first
+    static std::vector<Stats> Collect();
+    // peak resident set size of the process, also without tracking
+    static long PeakRssKb();
+
+    static bool OutputResult(const std::string& output_file);
+};
+
+}  // namespace DeltaVins
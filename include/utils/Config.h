@@ -7,7 +7,9 @@ enum DataSrcType {
     DataSrcEuroc,
     DataSrcSynthetic,
     DataSrcROS2,
-    DataSrcROS2_bag
+    DataSrcROS2_bag,
+    DataSrcBinary,
+    DataSrcExternal  // pushed through slamAPI.h
 };
 
 enum class ROS2SensorType {
@@ -31,44 +33,78 @@ enum class ResultOutputFormat {
     TUM,
     KITTI,
     EUROC,
+    BINARY,  // TrajectoryWriter::Record as is
 };
 
+/**
+ * @brief Runtime configuration of one estimator. Every VioContext owns one,
+ * Instance() returns the config of the context bound to the calling thread.
+ */
 struct Config {
-    static bool loadConfigFile(const std::string& configFile);
+    static Config& Instance();
 
-    static int DataSourceType;
-    static std::string DataSourcePath;
-    static int ImageStartIdx;
-    static std::string CalibrationPath;
-    static int SerialRun;
-    static int NoGUI;
-    static int NoDebugOutput;
-    static int NoResultOutput;
-    static int MaxRunFPS;
-    static std::string outputFileName;
-    static std::string ResultOutputPath;
-    static int CameraCalibration;
-    static int RecordData;
-    static int RunVIO;
-    static int RecordIMU;
-    static int RecordImage;
-    static float ExposureTime;
-    static float Gain;
-    static int PlaneConstraint;
-    static std::string DataSourceConfigFilePath;
-    static ResultOutputFormat OutputFormat;
-    static void _clear();
-    static int MaxNumToTrack;
-    static int MaskSize;
-    static int FastScoreThreshold;
+    bool loadConfigFile(const std::string& configFile);
 
-    static std::string VisualizerServerIP;
-    static int UploadImage;
+    // replace the paths of the config files when not empty, so that one
+    // config can be run on many sequences (see CreateSlamSystemEx)
+    std::string DataSourcePathOverride;
+    std::string ResultOutputPathOverride;
+    // outputs shared by the process, moved per system when not empty
+    int NoGUIOverride = 0;                 // nonzero: no visualizer
+    std::string MetricsFileOverride;       // if MetricsFile is set
+    std::string MetricsSocketOverride;     // if MetricsSocket is set
+    std::string ShmTransportNameOverride;  // replaces ShmTransportName
 
-    static std::vector<ROS2SensorTopic> ROS2SensorTopics;
-    static bool UseGnss;
-    static bool UseStereo;
-    static bool UseOdometer;
-    static bool UseBackTracking;
+    int DataSourceType = 0;
+    std::string DataSourcePath;
+    int ImageStartIdx = 0;
+    int ImageReadAhead = 0;      // images decoded ahead of the replay
+    int ImageLoaderThreads = 0;  // decoding threads of file data sources
+    float PlaybackRate = 0.f;    // 0: as fast as possible, N: N x real time
+    std::string CalibrationPath;
+    int SerialRun = 0;
+    // serial run driven by sensor timestamps only, bit-identical results
+    int DeterministicReplay = 0;
+    int NoGUI = 0;
+    int NoDebugOutput = 0;
+    int NoResultOutput = 0;
+    int MaxRunFPS = 0;
+    int ImuRatePose = 0;   // publish poses propagated to every imu sample
+    int LogLevel = 1;      // 0: debug, 1: info, 2: warn, 3: error, 4: off
+    int ExportTrace = 0;   // write a Chrome trace of all threads on stop
+    int PerfCounters = 0;  // hardware counters of the profiled stages, Linux
+    int Telemetry = 0;     // per-frame timings and workload, 1: csv, 2: bin
+    // metrics of the running estimator for monitoring, see MetricsReporter
+    int MetricsInterval = 0;    // ms between two exports, 0: off
+    std::string MetricsFile;    // text file rewritten at every export
+    std::string MetricsSocket;  // unix socket serving the latest export
+    std::string outputFileName;
+    std::string ResultOutputPath;
+    int CameraCalibration = 0;
+    int RecordData = 0;
+    int RunVIO = 0;
+    int RecordIMU = 0;
+    int RecordImage = 0;
+    float ExposureTime = 0.f;
+    float Gain = 0.f;
+    int PlaneConstraint = 0;
+    std::string DataSourceConfigFilePath;
+    ResultOutputFormat OutputFormat = ResultOutputFormat::TUM;
+    void _clear();
+    int MaxNumToTrack = 0;
+    int MaskSize = 0;
+    int FastScoreThreshold = 0;
+
+    std::string VisualizerServerIP;
+    int UploadImage = 0;
+    int VisualizerFPS = 10;  // track images drawn per second, 0: every frame
+    // segment of ENABLE_VISUALIZER_SHM, see ShmTransport.h
+    std::string ShmTransportName = "/deltavins";
+
+    std::vector<ROS2SensorTopic> ROS2SensorTopics;
+    bool UseGnss = false;
+    bool UseStereo = false;
+    bool UseOdometer = false;
+    bool UseBackTracking = false;
 };
 }  // namespace DeltaVins
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace DeltaVins {
+
+/**
+ * @brief Streaming CSV reader for the file based data sources.
+ *
+ * The file is read in large blocks into one reused buffer and every row is
+ * split in place, so reading does not allocate per line. Blank lines and
+ * lines starting with '#' are skipped.
+ */
+class CsvReader {
+   public:
+    static constexpr int MAX_FIELDS = 32;
+
+    explicit CsvReader(const std::string& path, char delimiter = ',',
+                       size_t block_size = 1 << 20);
+    ~CsvReader();
+
+    CsvReader(const CsvReader&) = delete;
+    CsvReader& operator=(const CsvReader&) = delete;
+
+    bool IsOpen() const { return file_ != nullptr; }
+
+    // move to the next row, false at the end of the file
+    bool NextRow();
+
+    int NumFields() const { return num_fields_; }
+    std::string_view Field(int i) const {
+        return std::string_view(fields_[i], field_sizes_[i]);
+    }
+    int64_t GetInt64(int i) const;
+    // false if the field is not an integer, e.g. of a header row
+    bool GetInt64(int i, int64_t& value) const;
+    float GetFloat(int i) const;
+
+   private:
+    bool _FillBuffer();
+
+    FILE* file_ = nullptr;
+    char delimiter_;
+    std::vector<char> buffer_;
+    size_t begin_ = 0;  // start of the unread data in buffer_
+    size_t end_ = 0;    // end of the valid data in buffer_
+    bool eof_ = false;
+
+    int num_fields_ = 0;
+    const char* fields_[MAX_FIELDS];
+    int field_sizes_[MAX_FIELDS];
+};
+
+}  // namespace DeltaVins
@@ -0,0 +1,73 @@
+#pragma once
+#include <atomic>
+#include <string>
+#include <vector>
+
+namespace DeltaVins {
+
+/**
+ * @brief Counters and gauges of one VioContext, for monitoring a running
+ * estimator.
+ *
+ * Metrics are registered once per call site and referred to by index, as
+ * profiler sections are. Setting a gauge is a relaxed store and adding to
+ * a counter a compare and swap, cheap enough to stay on in production.
+ * MetricsReporter reads them at its own pace and hands them to exporters.
+ */
+class Metrics {
+   public:
+    static constexpr int MAX_METRICS = 64;
+
+    enum class Type { Counter, Gauge };
+
+    struct Sample {
+        std::string name;
+        std::string help;
+        Type type;
+        double value;
+    };
+
+    Metrics() = default;
+
+    Metrics(const Metrics&) = delete;
+    Metrics& operator=(const Metrics&) = delete;
+
+    // metrics of the context bound to the calling thread
+    static Metrics& Instance();
+
+    // index of a metric, the same name always gives the same index; -1
+    // when MAX_METRICS are taken
+    static int Register(const char* name, Type type, const char* help);
+
+    void Add(int metric, double value);  // counters
+    void Set(int metric, double value);  // gauges
+
+    // metrics updated at least once, in registration order
+    std::vector<Sample> Collect() const;
+    bool Get(const char* name, double& value) const;
+
+   private:
+    struct Slot {
+        std::atomic<double> value{0.0};
+        std::atomic_bool updated{false};
+    };
+
+    Slot slots_[MAX_METRICS];
+};
+
+}  // namespace DeltaVins
+
+// adds value to a counter, name and help have to be string literals
+#define METRIC_ADD(name, help, value)                                      \
+    do {                                                                   \
+        static const int _metric_ = ::DeltaVins::Metrics::Register(        \
+            name, ::DeltaVins::Metrics::Type::Counter, help);              \
+        ::DeltaVins::Metrics::Instance().Add(_metric_, value);             \
+    } while (false)
+// sets a gauge, name and help have to be string literals
+#define METRIC_SET(name, help, value)                                      \
+    do {                                                                   \
+        static const int _metric_ = ::DeltaVins::Metrics::Register(        \
+            name, ::DeltaVins::Metrics::Type::Gauge, help);                \
+        ::DeltaVins::Metrics::Instance().Set(_metric_, value);             \
+    } while (false)
@@ -0,0 +1,44 @@
+#pragma once
+#include <cstdint>
+
+namespace DeltaVins {
+
+/**
+ * @brief Hardware counters of the calling thread from Linux perf_event_open,
+ * counted in user space only. Every thread opens its counters as one group
+ * on first use and reads all of them with a single system call.
+ *
+ * Unavailable on other systems, in VMs without a virtual PMU and when
+ * /proc/sys/kernel/perf_event_paranoid is above 2; Read() then fails. A
+ * counter the CPU does not have reads 0.
+ */
+class PerfCounters {
+   public:
+    struct Values {
+        uint64_t cycles = 0;
+        uint64_t instructions = 0;
+        uint64_t cache_misses = 0;  // last level cache
+        uint64_t branch_misses = 0;
+
+        Values& operator+=(const Values& other) {
+            cycles += other.cycles;
+            instructions += other.instructions;
+            cache_misses += other.cache_misses;
+            branch_misses += other.branch_misses;
+            return *this;
+        }
+        Values operator-(const Values& other) const {
+            Values diff;
+            diff.cycles = cycles - other.cycles;
+            diff.instructions = instructions - other.instructions;
+            diff.cache_misses = cache_misses - other.cache_misses;
+            diff.branch_misses = branch_misses - other.branch_misses;
+            return diff;
+        }
+    };
+
+    // counts of the calling thread since its first call
+    static bool Read(Values& values);
+};
+
+}  // namespace DeltaVins
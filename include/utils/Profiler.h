@@ -0,0 +1,231 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "utils/AllocTracker.h"
+#include "utils/PerfCounters.h"
+
+// build with -DENABLE_PROFILER=0 to compile the PROFILE_* macros away
+#ifndef ENABLE_PROFILER
+#define ENABLE_PROFILER 1
+#endif
+
+namespace DeltaVins {
+
+/**
+ * @brief Latency statistics of the code sections of one VioContext.
+ *
+ * Sections are registered once per call site and referred to by index.
+ * Every thread records into a histogram block of its own, so recording
+ * takes no lock and no read-modify-write instruction; the report merges
+ * the blocks of all threads. Histograms have 8 buckets per power of two
+ * nanoseconds, percentiles are accurate to about 6%.
+ *
+ * With EnableTrace() every thread also keeps its latest spans and counter
+ * values in a ring buffer, which OutputTrace() writes as a Chrome trace
+ * (chrome://tracing, ui.perfetto.dev) with one row per thread.
+ *
+ * With EnablePerfCounters() the scopes also count the cycles, instructions,
+ * cache misses and branch misses of their thread (see PerfCounters), at the
+ * cost of a system call at either end.
+ */
+class Profiler {
+   public:
+    static constexpr int MAX_SECTIONS = 64;
+    static constexpr size_t TRACE_EVENTS_PER_THREAD = 1 << 16;
+
+    struct Stats {
+        std::string name;
+        uint64_t count;
+        double mean_ms;
+        double p50_ms;
+        double p90_ms;
+        double p99_ms;
+        double max_ms;
+        // mean per call, 0 without EnablePerfCounters()
+        PerfCounters::Values counters;
+    };
+
+    Profiler();
+    ~Profiler();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    // profiler of the context bound to the calling thread
+    static Profiler& Instance();
+
+    // index of a section, the same name always gives the same index;
+    // -1 when MAX_SECTIONS are taken
+    static int Register(const char* name);
+    // empty for an index which is not registered
+    static std::string SectionName(int section);
+
+    void Record(int section, int64_t duration_ns);
+    // span from begin to end, in ns of the steady clock
+    void Record(int section, int64_t begin_ns, int64_t end_ns) {
+        _Record(section, begin_ns, end_ns - begin_ns);
+    }
+    // same with the hardware counters of the span
+    void Record(int section, int64_t begin_ns, int64_t end_ns,
+                const PerfCounters::Values& counters);
+    // value of a counter, only kept in the trace
+    void Count(int section, int64_t value);
+
+    // time the calling thread spent in section since its last call, e.g.
+    // per frame
+    int64_t TakeThreadTotal(int section);
+    // same for the hardware counters
+    PerfCounters::Values TakeThreadCounters(int section);
+
+    // shown as the name of the calling thread in the trace
+    void NameThread(const std::string& name);
+
+    void EnableTrace(size_t events_per_thread = TRACE_EVENTS_PER_THREAD);
+    bool TraceEnabled() const {
+        return trace_enabled_.load(std::memory_order_acquire);
+    }
+    bool OutputTrace(const std::string& output_file) const;
+
+    // false if the counters of the calling thread can not be opened
+    bool EnablePerfCounters();
+    bool PerfCountersEnabled() const {
+        return perf_enabled_.load(std::memory_order_relaxed);
+    }
+
+    // sections recorded at least once, in registration order
+    std::vector<Stats> Collect() const;
+    bool Get(const char* name, Stats& stats) const;
+    // forgets the samples and the untaken totals of all threads, any time
+    void Reset();
+
+    void OutputResult(const std::string& output_file) const;
+    // through LOGI, e.g. once on stop
+    void OutputResultConsole() const;
+
+   private:
+    struct ThreadBlock;
+
+    ThreadBlock& _ThreadBlock();
+    static void _ClearBlock(ThreadBlock& block, uint64_t generation);
+    void _Record(int section, int64_t begin_ns, int64_t duration_ns);
+    void _Trace(ThreadBlock& block, int section, bool counter, int64_t ts_ns,
+                int64_t value);
+
+    const uint64_t serial_;  // tells contexts at the same address apart
+    const int64_t origin_ns_;  // time 0 of the trace
+    std::atomic_bool trace_enabled_{false};
+    std::atomic_bool perf_enabled_{false};
+    std::atomic<uint64_t> generation_{0};  // of Reset()
+    mutable std::mutex mtx_blocks_;
+    size_t trace_capacity_ = 0;  // guarded by mtx_blocks_
+    std::vector<std::shared_ptr<ThreadBlock>> blocks_;
+};
+
+/**
+ * @brief Records the time from construction to Stop() or destruction.
+ * Heap allocations in between are charged to the section as well, see
+ * AllocTracker.
+ */
+class ProfileScope {
+   public:
+    explicit ProfileScope(int section) : section_(section) {
+        // read before the clock, so the system call is not timed
+        if (section_ >= 0 && Profiler::Instance().PerfCountersEnabled())
+            counting_ = PerfCounters::Read(begin_counters_);
+        begin_ = Now();
+#if ENABLE_ALLOC_TRACKING
+        if (section_ >= 0)
+            alloc_section_ = AllocTracker::SwapSection(section_);
+#endif
+    }
+    ~ProfileScope() { Stop(); }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+    void Stop() {
+        if (section_ < 0) return;
+        const int64_t end = Now();
+        PerfCounters::Values end_counters;
+        if (counting_ && PerfCounters::Read(end_counters)) {
+            Profiler::Instance().Record(section_, begin_, end,
+                                        end_counters - begin_counters_);
+        } else {
+            Profiler::Instance().Record(section_, begin_, end);
+        }
+        _Leave();
+    }
+
+    // leaves the measurement out, e.g. on an early return
+    void Cancel() {
+        if (section_ >= 0) _Leave();
+    }
+
+    static int64_t Now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
+   private:
+    void _Leave() {
+#if ENABLE_ALLOC_TRACKING
+        AllocTracker::SwapSection(alloc_section_);
+#endif
+        section_ = -1;
+    }
+
+    int section_;
+    int64_t begin_;
+    bool counting_ = false;
+    PerfCounters::Values begin_counters_;
+    int alloc_section_ = -1;  // of the enclosing scope
+};
+
+// stands in for ProfileScope when profiling is compiled out
+class NullProfileScope {
+   public:
+    void Stop() {}
+    void Cancel() {}
+};
+
+}  // namespace DeltaVins
+
+#define DELTA_PROFILE_CAT2(a, b) a##b
+#define DELTA_PROFILE_CAT(a, b) DELTA_PROFILE_CAT2(a, b)
+
+#if ENABLE_PROFILER
+// times the rest of the enclosing scope, name has to be a string literal
+#define PROFILE_SCOPE(name) \
+    PROFILE_SCOPE_NAMED(DELTA_PROFILE_CAT(_profile_scope_, __LINE__), name)
+// same, as a variable named var which can be stopped early
+#define PROFILE_SCOPE_NAMED(var, name)                               \
+    static const int DELTA_PROFILE_CAT(_profile_section_, __LINE__) = \
+        ::DeltaVins::Profiler::Register(name);                        \
+    ::DeltaVins::ProfileScope var(                                    \
+        DELTA_PROFILE_CAT(_profile_section_, __LINE__))
+// level of a queue or buffer over time, shown in the trace
+#define TRACE_COUNTER(name, value)                                    \
+    do {                                                              \
+        static const int _profile_counter_ =                          \
+            ::DeltaVins::Profiler::Register(name);                    \
+        auto& _profiler_ = ::DeltaVins::Profiler::Instance();         \
+        if (_profiler_.TraceEnabled())                                \
+            _profiler_.Count(_profile_counter_, value);               \
+    } while (false)
+#else
+#define PROFILE_SCOPE(name) static_assert(true, name)
+#define PROFILE_SCOPE_NAMED(var, name) \
+    static_assert(true, name);         \
+    ::DeltaVins::NullProfileScope var
+#define TRACE_COUNTER(name, value) \
+    do {                           \
+        (void)sizeof(value);       \
+    } while (false)
+#endif
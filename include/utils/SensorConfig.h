@@ -27,10 +27,8 @@ struct CameraParams {
 
 class SensorConfig {
    public:
-    static SensorConfig& Instance() {
-        static SensorConfig instance;
-        return instance;
-    }
+    // sensor config of the current VioContext
+    static SensorConfig& Instance();
 
     CamModel::Ptr GetCamModel(int sensor_id) { return cam_models_[sensor_id]; }
 
@@ -43,6 +41,7 @@ class SensorConfig {
     bool LoadConfig(const std::string& config_path);
 
    private:
+    friend class VioContext;
     SensorConfig() {}
 
     SensorConfig(const SensorConfig&) = delete;
@@ -13,132 +13,63 @@ extern void logInit();
 extern void finishLogging();
 
 #if !USE_ROS2
+#include "utils/logger.h"
 
-#if OUTPUT_FILE
+// The printf call is never executed, it only keeps the format checks.
+#define DELTA_LOG(level, ...)                             \
+    do {                                                  \
+        if (false) printf(__VA_ARGS__);                   \
+        if (::DeltaVins::Logger::Enabled(level))          \
+            ::DeltaVins::Logger::Log(level, __VA_ARGS__); \
+    } while (0)
 
-extern FILE* infoLog;
-extern FILE* warnLog;
-extern FILE* errLog;
-
-#endif
+// at most one message per period_ms from this call site
+#define DELTA_LOG_EVERY_MS(level, period_ms, ...)                           \
+    do {                                                                    \
+        if (false) printf(__VA_ARGS__);                                     \
+        static ::DeltaVins::LogThrottle log_throttle_(period_ms);           \
+        int log_suppressed_ = 0;                                            \
+        if (::DeltaVins::Logger::Enabled(level) &&                          \
+            log_throttle_.Allow(&log_suppressed_)) {                        \
+            ::DeltaVins::Logger::Log(level, __VA_ARGS__);                   \
+            if (log_suppressed_)                                            \
+                ::DeltaVins::Logger::Log(                                   \
+                    level, "(%d similar messages suppressed)",              \
+                    log_suppressed_);                                       \
+        }                                                                   \
+    } while (0)
 
 #if OUTPUT_DEBUG
-#if OUTPUT_CONSOLE && OUTPUT_FILE
-#define LOGD(...)                      \
-    {                                  \
-        printf("[Debug] ");            \
-        printf(__VA_ARGS__);           \
-        printf("\n");                  \
-        fprintf(infoLog, __VA_ARGS__); \
-        fprintf(infoLog, "\n");        \
-    }
-#elif OUTPUT_CONSOLE
-#define LOGD(...)            \
-    {                        \
-        printf("[Debug] ");  \
-        printf(__VA_ARGS__); \
-        printf("\n");        \
-    }
-#elif OUTPUT_FILE
-#define LOGD(...)                      \
-    {                                  \
-        fprintf(infoLog, __VA_ARGS__); \
-        fprintf(infoLog, "\n");        \
-    }
-#else
-#define LOGD(...) void(0)
-#endif
+#define LOGD(...) DELTA_LOG(::DeltaVins::LogLevel::Debug, __VA_ARGS__)
 #else
 #define LOGD(...) void(0)
 #endif
 
 #if OUTPUT_INFO
-#if OUTPUT_CONSOLE && OUTPUT_FILE
-#define LOGI(...)                      \
-    {                                  \
-        printf("[Info] ");             \
-        printf(__VA_ARGS__);           \
-        printf("\n");                  \
-        fprintf(infoLog, __VA_ARGS__); \
-        fprintf(infoLog, "\n");        \
-    }
-#elif OUTPUT_CONSOLE
-#define LOGI(...)            \
-    {                        \
-        printf("[Info] ");   \
-        printf(__VA_ARGS__); \
-        printf("\n");        \
-    }
-#elif OUTPUT_FILE
-#define LOGI(...)                      \
-    {                                  \
-        fprintf(infoLog, __VA_ARGS__); \
-        fprintf(infoLog, "\n");        \
-    }
-#else
-#define LOGI(...) void(0)
-#endif
+#define LOGI(...) DELTA_LOG(::DeltaVins::LogLevel::Info, __VA_ARGS__)
+#define LOGI_EVERY_MS(period_ms, ...) \
+    DELTA_LOG_EVERY_MS(::DeltaVins::LogLevel::Info, period_ms, __VA_ARGS__)
 #else
 #define LOGI(...) void(0)
+#define LOGI_EVERY_MS(...) void(0)
 #endif
 
 #if OUTPUT_WARNING
-#if OUTPUT_CONSOLE && OUTPUT_FILE
-#define LOGW(...)                      \
-    {                                  \
-        printf("[Warn] ");             \
-        printf(__VA_ARGS__);           \
-        ;                              \
-        printf("\n");                  \
-        fprintf(warnLog, __VA_ARGS__); \
-        fprintf(warnLog, "\n");        \
-    }
-#elif OUTPUT_CONSOLE
-#define LOGW(...)            \
-    {                        \
-        printf("[Warn] ");   \
-        printf(__VA_ARGS__); \
-        printf("\n");        \
-    }
-#elif OUTPUT_FILE
-#define LOGW(...)                      \
-    {                                  \
-        fprintf(warnLog, __VA_ARGS__); \
-        fprintf(warnLog, "\n");        \
-    }
-#else
-#define LOGW(...) void(0)
-#endif
+#define LOGW(...) DELTA_LOG(::DeltaVins::LogLevel::Warn, __VA_ARGS__)
+#define LOGW_EVERY_MS(period_ms, ...) \
+    DELTA_LOG_EVERY_MS(::DeltaVins::LogLevel::Warn, period_ms, __VA_ARGS__)
 #else
 #define LOGW(...) void(0)
+#define LOGW_EVERY_MS(...) void(0)
 #endif
 
 #if OUTPUT_ERROR
-#if OUTPUT_CONSOLE && OUTPUT_FILE
-#define LOGE(...)                     \
-    {                                 \
-        printf("[Error] ");           \
-        printf(__VA_ARGS__);          \
-        printf("\n");                 \
-        fprintf(errLog, __VA_ARGS__); \
-        fprintf(errLog, "\n");        \
-    }
-#elif OUTPUT_CONSOLE
-#define LOGE(...)            \
-    {                        \
-        printf("[Error] ");  \
-        printf(__VA_ARGS__); \
-        printf("\n");        \
-    }
-#elif OUTPUT_FILE
-#define LOGE(...)                 \
-    fprintf(errLog, __VA_ARGS__); \
-    fprintf(errLog, "\n")
-#else
-#define LOGE(...) void(0)
-#endif
+#define LOGE(...) DELTA_LOG(::DeltaVins::LogLevel::Error, __VA_ARGS__)
+#define LOGE_EVERY_MS(period_ms, ...) \
+    DELTA_LOG_EVERY_MS(::DeltaVins::LogLevel::Error, period_ms, __VA_ARGS__)
 #else
 #define LOGE(...) void(0)
+#define LOGE_EVERY_MS(...) void(0)
 #endif
 
 #else
@@ -149,4 +80,23 @@ extern FILE* errLog;
 #define LOGW(...) RCLCPP_WARN(rclcpp::get_logger("rclcpp"), __VA_ARGS__)
 #define LOGE(...) RCLCPP_ERROR(rclcpp::get_logger("rclcpp"), __VA_ARGS__)
 
+namespace DeltaVins {
+// the throttle macros keep a reference to the clock, it has to outlive them
+inline rclcpp::Clock& LogClock() {
+    static rclcpp::Clock clock(RCL_SYSTEM_TIME);
+    return clock;
+}
+}  // namespace DeltaVins
+
+// throttled against the system clock
+#define LOGI_EVERY_MS(period_ms, ...)                                   \
+    RCLCPP_INFO_THROTTLE(rclcpp::get_logger("rclcpp"),                  \
+                         ::DeltaVins::LogClock(), period_ms, __VA_ARGS__)
+#define LOGW_EVERY_MS(period_ms, ...)                                   \
+    RCLCPP_WARN_THROTTLE(rclcpp::get_logger("rclcpp"),                  \
+                         ::DeltaVins::LogClock(), period_ms, __VA_ARGS__)
+#define LOGE_EVERY_MS(period_ms, ...)                                   \
+    RCLCPP_ERROR_THROTTLE(rclcpp::get_logger("rclcpp"),                 \
+                          ::DeltaVins::LogClock(), period_ms, __VA_ARGS__)
+
 #endif
\ No newline at end of file
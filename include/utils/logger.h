@@ -0,0 +1,191 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <tuple>
+#include <type_traits>
+
+// formats are checked at the call sites of the LOG macros
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+
+namespace DeltaVins {
+
+class VioContext;
+
+enum class LogLevel : int { Debug = 0, Info, Warn, Error, Off };
+
+/**
+ * @brief Backend of the LOG macros. The logging thread only copies the
+ * format string pointer and the raw arguments into a per-thread lock-free
+ * queue; a background thread formats and writes them. Before logInit() and
+ * after finishLogging() messages are written directly.
+ *
+ * Formats have to be string literals, string arguments are copied.
+ * Messages of different threads are not ordered. Messages of threads bound
+ * to a context with a file of its own go to that file instead of stdout.
+ */
+class Logger {
+   public:
+    static constexpr size_t ARG_BYTES = 240;
+
+    struct Record {
+        // formats the packed arguments with fmt into out
+        using FormatFn = int (*)(char* out, size_t size, const char* fmt,
+                                 const char* args);
+        FormatFn format;
+        const char* fmt;
+        LogLevel level;
+        const VioContext* context;  // bound to the logging thread
+        char args[ARG_BYTES];
+    };
+
+    static void SetLevel(LogLevel level) {
+        level_.store(static_cast<int>(level), std::memory_order_relaxed);
+    }
+    static LogLevel GetLevel() {
+        return static_cast<LogLevel>(level_.load(std::memory_order_relaxed));
+    }
+    static bool Enabled(LogLevel level) {
+        return static_cast<int>(level) >=
+               level_.load(std::memory_order_relaxed);
+    }
+
+    // starts and stops the background thread, see logInit/finishLogging
+    static void Start();
+    static void Stop();
+
+    // writes the messages of the threads bound to context into file, open
+    // until SetContextFile(context, nullptr) returned, which writes the
+    // messages queued so far first
+    static void SetContextFile(const VioContext* context, FILE* file);
+
+    template <size_t N, typename... Args>
+    static void Log(LogLevel level, const char (&fmt)[N],
+                    const Args&... args) {
+        Record record;
+        record.level = level;
+        record.fmt = fmt;
+        Packer packer{record.args, record.args + ARG_BYTES};
+        (Arg<std::decay_t<Args>>::Put(packer, args), ...);
+        if (packer.ok) {
+            record.format = &_Format<std::decay_t<Args>...>;
+        } else {
+            // too large to pack, format here instead, cut to ARG_BYTES
+            _FormatNow(record.args, ARG_BYTES, fmt, args...);
+            record.format = &_FormatText;
+        }
+        _Submit(record);
+    }
+
+   private:
+    struct Packer {
+        char* p;
+        char* end;
+        bool ok = true;
+        template <typename T>
+        void Put(const T& value) {
+            if (!ok || p + sizeof(T) > end) {
+                ok = false;
+                return;
+            }
+            memcpy(p, &value, sizeof(T));
+            p += sizeof(T);
+        }
+        void PutString(const char* s) {
+            if (!s) s = "(null)";
+            const size_t n = strlen(s) + 1;
+            if (!ok || p + n > end) {
+                ok = false;
+                return;
+            }
+            memcpy(p, s, n);
+            p += n;
+        }
+    };
+
+    struct Unpacker {
+        const char* p;
+        template <typename T>
+        T Get() {
+            T value;
+            memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            return value;
+        }
+        const char* GetString() {
+            const char* s = p;
+            p += strlen(s) + 1;
+            return s;
+        }
+    };
+
+    // how an argument is stored: numbers as is (float promoted like in
+    // varargs), strings by value
+    template <typename T, typename = void>
+    struct Arg {
+        using Stored = std::conditional_t<std::is_floating_point_v<T>,
+                                          double, T>;
+        static_assert(std::is_trivially_copyable_v<T>,
+                      "log arguments have to be printf compatible");
+        static void Put(Packer& packer, const T& value) {
+            packer.Put(static_cast<Stored>(value));
+        }
+        static Stored Get(Unpacker& unpacker) {
+            return unpacker.Get<Stored>();
+        }
+    };
+
+    template <typename T>
+    struct Arg<T, std::enable_if_t<std::is_same_v<T, const char*> ||
+                                   std::is_same_v<T, char*>>> {
+        static void Put(Packer& packer, const char* value) {
+            packer.PutString(value);
+        }
+        static const char* Get(Unpacker& unpacker) {
+            return unpacker.GetString();
+        }
+    };
+
+    template <typename... Ts>
+    static int _Format(char* out, size_t size, const char* fmt,
+                       const char* args) {
+        Unpacker unpacker{args};
+        // braced initialization keeps the order of the arguments
+        std::tuple<decltype(Arg<Ts>::Get(unpacker))...> values{
+            Arg<Ts>::Get(unpacker)...};
+        return std::apply(
+            [&](auto... v) { return snprintf(out, size, fmt, v...); },
+            values);
+    }
+
+    static int _FormatText(char* out, size_t size, const char* fmt,
+                           const char* args);
+    static int _FormatNow(char* out, size_t size, const char* fmt, ...);
+
+    static void _Submit(Record& record);
+
+    static std::atomic<int> level_;
+};
+
+/**
+ * @brief Lets one message per period through, counting the others.
+ */
+class LogThrottle {
+   public:
+    explicit LogThrottle(int period_ms) : period_ns_(period_ms * 1000000LL) {}
+
+    // suppressed: messages dropped since the last one let through
+    bool Allow(int* suppressed);
+
+   private:
+    const long long period_ns_;
+    std::atomic<long long> next_{0};
+    std::atomic<int> suppressed_{0};
+};
+
+}  // namespace DeltaVins
+
+#pragma GCC diagnostic pop
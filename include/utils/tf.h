@@ -128,6 +128,7 @@ class Tfs {
     }
 
    private:
+    friend class VioContext;
     Tfs() = default;
     std::set<std::string> frame_ids_;
 
@@ -136,4 +137,8 @@ class Tfs {
         tf_chains_;
 };
 
+// the transforms of the estimator are kept in the current VioContext
+template <>
+Tfs<float>& Tfs<float>::Instance();
+
 }  // namespace DeltaVins
\ No newline at end of file
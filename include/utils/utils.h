@@ -5,7 +5,7 @@
 #include "Config.h"
 #include "FileOutput.h"
 #include "ModuleDefine.h"
-#include "TickTock.h"
+#include "Profiler.h"
 #include "log.h"
 #include "targetDefine.h"
 #include "typedefs.h"
@@ -94,7 +94,7 @@ T bilinearInterploate(const T& v00, const T& v01, const T& v10, const T& v11,
 }
 
 inline long long getTimestamp() {
-    static timespec t;
+    timespec t;
     timespec_get(&t, TIME_UTC);
     return t.tv_nsec + t.tv_sec * 1000000000;
 }
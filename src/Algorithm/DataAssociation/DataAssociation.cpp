@@ -7,6 +7,7 @@
 #include "Algorithm/vision/camModel/camModel.h"
 #include "dataStructure/Grid.h"
 #include "dataStructure/vioStructures.h"
+#include "framework/VioContext.h"
 #include "precompile.h"
 #include "utils/SensorConfig.h"
 #include "utils/utils.h"
@@ -15,40 +16,50 @@
 namespace DeltaVins {
 namespace DataAssociation {
 
-TwoPointRansac* g_two_point_ransac = nullptr;
-SquareRootEKFSolver* g_square_root_solver = nullptr;
-std::vector<LandmarkPtr> g_tracked_feature_to_update;
-std::vector<LandmarkPtr> g_tracked_feature_next_update;
-std::vector<std::vector<LandmarkPtr>> g_grid22;
+// one per VioContext
+struct State {
+    ~State() { delete two_point_ransac; }
 
-cv::Mat reprojImage;
-cv::Mat reprojImage2;
+    TwoPointRansac* two_point_ransac = nullptr;
+    SquareRootEKFSolver* square_root_solver = nullptr;
+    std::vector<LandmarkPtr> tracked_feature_to_update;
+    std::vector<LandmarkPtr> tracked_feature_next_update;
+    std::vector<std::vector<LandmarkPtr>> grid22;
+
+    cv::Mat reproj_image;
+    cv::Mat reproj_image2;
+};
+
+static State& _State() { return VioContext::Current().GetState<State>(); }
 
 void Clear() {
-    g_tracked_feature_next_update.clear();
-    g_tracked_feature_to_update.clear();
-    delete g_two_point_ransac;
+    auto& state = _State();
+    state.tracked_feature_next_update.clear();
+    state.tracked_feature_to_update.clear();
+    delete state.two_point_ransac;
+    state.two_point_ransac = nullptr;
 }
 
 void DrawPointsAfterUpdates(std::vector<PointState*>& m_PointStates,
                             int cam_id) {
-    if (Config::NoGUI) return;
-    reprojImage2 = cv::Mat::zeros(480, 640, CV_8UC3);
-    for (auto& p : g_tracked_feature_to_update) {
+    auto& state = _State();
+    if (Config::Instance().NoGUI) return;
+    state.reproj_image2 = cv::Mat::zeros(480, 640, CV_8UC3);
+    for (auto& p : state.tracked_feature_to_update) {
         p->Reproject();
         for (auto& ob : p->visual_obs[cam_id]) {
-            cv::circle(reprojImage2, cv::Point(ob->px.x(), ob->px.y()), 4,
-                       _BLUE_SCALAR);
-            cv::circle(reprojImage2,
+            cv::circle(state.reproj_image2,
+                       cv::Point(ob->px.x(), ob->px.y()), 4, _BLUE_SCALAR);
+            cv::circle(state.reproj_image2,
                        cv::Point(ob->px_reprj.x(), ob->px_reprj.y()), 4,
                        _RED_SCALAR);
-            cv::line(reprojImage2, cv::Point(ob->px.x(), ob->px.y()),
+            cv::line(state.reproj_image2, cv::Point(ob->px.x(), ob->px.y()),
                      cv::Point(ob->px_reprj.x(), ob->px_reprj.y()),
                      _GREEN_SCALAR);
         }
         // for (size_t i = 0; i < p->visual_obs.size() - 1; ++i) {
         //     cv::line(
-        //         reprojImage2,
+        //         state.reproj_image2,
         //         cv::Point(p->visual_obs[i]->px.x(),
         //         p->visual_obs[i]->px.y()), cv::Point(p->visual_obs[i +
         //         1]->px.x(),
@@ -60,35 +71,37 @@ void DrawPointsAfterUpdates(std::vector<PointState*>& m_PointStates,
         auto p = p2->host;
         p->Reproject();
         auto& ob = p->last_obs_[cam_id];
-        cv::circle(reprojImage2, cv::Point(ob->px.x(), ob->px.y()), 10,
+        cv::circle(state.reproj_image2, cv::Point(ob->px.x(), ob->px.y()), 10,
                    _BLUE_SCALAR);
-        cv::circle(reprojImage2, cv::Point(ob->px_reprj.x(), ob->px_reprj.y()),
-                   10, _RED_SCALAR);
-        cv::line(reprojImage2, cv::Point(ob->px.x(), ob->px.y()),
+        cv::circle(state.reproj_image2,
+                   cv::Point(ob->px_reprj.x(), ob->px_reprj.y()), 10,
+                   _RED_SCALAR);
+        cv::line(state.reproj_image2, cv::Point(ob->px.x(), ob->px.y()),
                  cv::Point(ob->px_reprj.x(), ob->px_reprj.y()), _GREEN_SCALAR);
     }
-    // cv::imshow("Points After Updates", reprojImage2);
+    // cv::imshow("Points After Updates", state.reproj_image2);
 }
 void DrawPointsBeforeUpdates(std::vector<PointState*>& m_PointStates,
                              int cam_id) {
-    if (Config::NoGUI) return;
-    reprojImage = cv::Mat::zeros(480, 640, CV_8UC3);
+    auto& state = _State();
+    if (Config::Instance().NoGUI) return;
+    state.reproj_image = cv::Mat::zeros(480, 640, CV_8UC3);
 
-    for (auto& p : g_tracked_feature_to_update) {
+    for (auto& p : state.tracked_feature_to_update) {
         p->Reproject();
         for (auto& ob : p->visual_obs[cam_id]) {
-            cv::circle(reprojImage, cv::Point(ob->px.x(), ob->px.y()), 4,
+            cv::circle(state.reproj_image, cv::Point(ob->px.x(), ob->px.y()), 4,
                        _BLUE_SCALAR);
-            cv::circle(reprojImage,
+            cv::circle(state.reproj_image,
                        cv::Point(ob->px_reprj.x(), ob->px_reprj.y()), 4,
                        _RED_SCALAR);
-            cv::line(reprojImage, cv::Point(ob->px.x(), ob->px.y()),
+            cv::line(state.reproj_image, cv::Point(ob->px.x(), ob->px.y()),
                      cv::Point(ob->px_reprj.x(), ob->px_reprj.y()),
                      _GREEN_SCALAR);
         }
         // for (size_t i = 0; i < p->visual_obs.size() - 1; ++i) {
         //     cv::line(
-        //         reprojImage,
+        //         state.reproj_image,
         //         cv::Point(p->visual_obs[i]->px.x(),
         //         p->visual_obs[i]->px.y()), cv::Point(p->visual_obs[i +
         //         1]->px.x(),
@@ -101,35 +114,41 @@ void DrawPointsBeforeUpdates(std::vector<PointState*>& m_PointStates,
         auto p = p2->host;
         p->Reproject();
         auto& ob = p->last_obs_[cam_id];
-        cv::circle(reprojImage, cv::Point(ob->px.x(), ob->px.y()), 10,
+        cv::circle(state.reproj_image, cv::Point(ob->px.x(), ob->px.y()), 10,
                    _BLUE_SCALAR);
-        cv::circle(reprojImage, cv::Point(ob->px_reprj.x(), ob->px_reprj.y()),
-                   10, _RED_SCALAR);
-        cv::line(reprojImage, cv::Point(ob->px.x(), ob->px.y()),
+        cv::circle(state.reproj_image,
+                   cv::Point(ob->px_reprj.x(), ob->px_reprj.y()), 10,
+                   _RED_SCALAR);
+        cv::line(state.reproj_image, cv::Point(ob->px.x(), ob->px.y()),
                  cv::Point(ob->px_reprj.x(), ob->px_reprj.y()), _GREEN_SCALAR);
     }
-    // cv::imshow("Points Before Updates", reprojImage);
+    // cv::imshow("Points Before Updates", state.reproj_image);
 }
 
 void InitDataAssociation(SquareRootEKFSolver* solver) {
-    if (!g_two_point_ransac) g_two_point_ransac = new TwoPointRansac();
-    g_square_root_solver = solver;
-    g_grid22.resize(4);
+    auto& state = _State();
+    if (!state.two_point_ransac) state.two_point_ransac = new TwoPointRansac();
+    state.square_root_solver = solver;
+    state.grid22.resize(4);
 }
 
 int RemoveOutlierBy2PointRansac(Matrix3f& dR,
                                 std::list<LandmarkPtr>& vTrackedFeatures,
                                 int sensor_id, int cam_id) {
-    assert(g_two_point_ransac);
-
-    std::vector<Vector3f> ray0, ray1;
-    std::vector<Vector2f> p0, p1;
-    std::vector<Landmark*> goodTracks;
-    ray0.reserve(600);
-    ray1.reserve(600);
-    p0.reserve(600);
-    p1.reserve(600);
-    goodTracks.reserve(600);
+    auto& state = _State();
+    assert(state.two_point_ransac);
+
+    // buffers are reused between frames to avoid reallocation
+    thread_local std::vector<Vector3f> ray0, ray1;
+    thread_local std::vector<Vector2f> p0, p1;
+    thread_local std::vector<Landmark*> goodTracks;
+    thread_local std::vector<bool> vInliers;
+    ray0.clear();
+    ray1.clear();
+    p0.clear();
+    p1.clear();
+    goodTracks.clear();
+    vInliers.clear();
     int nGoodPoints = 0;
 
     for (const auto& tracked_feature : vTrackedFeatures) {
@@ -144,9 +163,8 @@ int RemoveOutlierBy2PointRansac(Matrix3f& dR,
         goodTracks.push_back(tracked_feature.get());
     }
 
-    std::vector<bool> vInliers;
-    g_two_point_ransac->FindInliers(p0, ray0, p1, ray1, dR, vInliers,
-                                    sensor_id);
+    state.two_point_ransac->FindInliers(p0, ray0, p1, ray1, dR, vInliers,
+                                        sensor_id);
     for (int i = 0, n = vInliers.size(); i < n; ++i) {
         if (!vInliers[i]) {
             auto& track = goodTracks[i];
@@ -162,8 +180,9 @@ int RemoveOutlierBy2PointRansac(Matrix3f& dR,
 }
 
 void _addBufferPoints(std::vector<std::shared_ptr<Landmark>>& vDeadFeature) {
+    auto& state = _State();
     constexpr int MAX_BUFFER_OBS = 5;
-    for (auto trackedFeature : g_tracked_feature_next_update) {
+    for (auto trackedFeature : state.tracked_feature_next_update) {
         if (trackedFeature->point_state_)
             assert(!trackedFeature->point_state_->flag_slam_point);
         if (trackedFeature->valid_obs_num > MAX_BUFFER_OBS)
@@ -173,9 +192,9 @@ void _addBufferPoints(std::vector<std::shared_ptr<Landmark>>& vDeadFeature) {
     }
 #if OUTPUT_DEBUG_INFO
     printf("  Add Buffer Points:%d/%d\n", vDeadFeature.size(),
-           g_tracked_feature_next_update.size());
+           state.tracked_feature_next_update.size());
 #endif
-    g_tracked_feature_next_update.clear();
+    state.tracked_feature_next_update.clear();
 }
 
 void _addDeadPoints(std::list<LandmarkPtr>& vTrackedFeatures,
@@ -225,10 +244,11 @@ void _addDeadPoints(std::list<LandmarkPtr>& vTrackedFeatures,
 
 void _pushPoints2Grid(
     const std::vector<std::shared_ptr<Landmark>>& vDeadFeature) {
-    static std::vector<std::vector<LandmarkPtr>> vvGrid44(4 * 4);
-    static CamModel::Ptr camModel = SensorConfig::Instance().GetCamModel(0);
-    static const int STEPX = camModel->width() / 4;
-    static const int STEPY = camModel->height() / 4;
+    auto& state = _State();
+    thread_local std::vector<std::vector<LandmarkPtr>> vvGrid44(4 * 4);
+    CamModel::Ptr camModel = SensorConfig::Instance().GetCamModel(0);
+    const int STEPX = camModel->width() / 4;
+    const int STEPY = camModel->height() / 4;
 
     auto comparator_less = [](const LandmarkPtr& a, const LandmarkPtr& b) {
         return a->flag_dead_all == b->flag_dead_all
@@ -243,14 +263,14 @@ void _pushPoints2Grid(
             for (auto tracked_feature : src) {
                 if (!pSecond || comparator_less(pSecond, tracked_feature)) {
                     if (pSecond && pSecond->flag_dead_all)
-                        g_tracked_feature_next_update.push_back(pSecond);
+                        state.tracked_feature_next_update.push_back(pSecond);
                     pSecond = tracked_feature;
                     if (!pFirst || comparator_less(pFirst, pSecond)) {
                         std::swap(pFirst, pSecond);
                     }
                 } else {
                     if (tracked_feature->flag_dead_all)
-                        g_tracked_feature_next_update.push_back(
+                        state.tracked_feature_next_update.push_back(
                             tracked_feature);
                 }
             }
@@ -292,10 +312,10 @@ void _pushPoints2Grid(
     static int LUT[16] = {0, 0, 1, 1, 0, 0, 1, 1, 2, 2, 3, 3, 2, 2, 3, 3};
 
     for (int i = 0; i < 16; ++i) {
-        selectTop2(vvGrid44[i], g_grid22[LUT[i]]);
+        selectTop2(vvGrid44[i], state.grid22[LUT[i]]);
     }
 
-    for (auto& grid : g_grid22) {
+    for (auto& grid : state.grid22) {
         std::sort(grid.begin(), grid.end(), comparator_less);
     }
 
@@ -304,13 +324,16 @@ void _pushPoints2Grid(
 #if OUTPUT_DEBUG_INFO
     printf("# 2*2 Dead Points:\n");
     printf("____________________\n");
-    printf("|  %03d  |  %03d  |\n", g_grid22[0].size(), g_grid22[1].size());
-    printf("|  %03d  |  %03d  |\n", g_grid22[2].size(), g_grid22[3].size());
+    printf("|  %03d  |  %03d  |\n", state.grid22[0].size(),
+           state.grid22[1].size());
+    printf("|  %03d  |  %03d  |\n", state.grid22[2].size(),
+           state.grid22[3].size());
     printf("____________________\n");
 #endif
 }
 
 bool _tryAddMsckfPoseConstraint(const std::list<LandmarkPtr>& lTrackFeatures) {
+    auto& state = _State();
     int nPointsPerGrid = MAX_MSCKF_FEATURE_UPDATE_PER_FRAME / 4;
     int nPointsLeft = MAX_MSCKF_FEATURE_UPDATE_PER_FRAME;
     int nPointsAllAdded = 0;
@@ -324,7 +347,7 @@ bool _tryAddMsckfPoseConstraint(const std::list<LandmarkPtr>& lTrackFeatures) {
     // int nPointsSlamPerGrid = MAX_POINT_SIZE / 4;
     std::vector<int> vPointsSLAMLeft{0, 0, 0, 0};
     std::vector<int> vPointsSLAMNow{0, 0, 0, 0};
-    static std::vector<std::vector<Landmark*>> m_slamPointGrid22(4);
+    thread_local std::vector<std::vector<Landmark*>> m_slamPointGrid22(4);
     // static Grid<Landmark*, 2, 2> m_slamPointGrid22(halfX, halfY);
     int nSlamPoint = 0;
 
@@ -400,8 +423,8 @@ bool _tryAddMsckfPoseConstraint(const std::list<LandmarkPtr>& lTrackFeatures) {
 #if OUTPUT_DEBUG_INFO
             printf("#### Triangulation Success\n");
 #endif
-            if (g_square_root_solver->ComputeJacobians(track.get())) {
-                if (g_square_root_solver->MahalanobisTest(
+            if (state.square_root_solver->ComputeJacobians(track.get())) {
+                if (state.square_root_solver->MahalanobisTest(
                         track->point_state_)) {
                     nPointsAllAdded++;
                     return true;
@@ -425,7 +448,7 @@ bool _tryAddMsckfPoseConstraint(const std::list<LandmarkPtr>& lTrackFeatures) {
 
 #endif
         for (int i = 0; i < 4; ++i) {
-            auto& grid = g_grid22[i];
+            auto& grid = state.grid22[i];
 #if OUTPUT_DEBUG_INFO
 
             printf("## Grid %d in 2*2:\n", ii);
@@ -446,15 +469,17 @@ bool _tryAddMsckfPoseConstraint(const std::list<LandmarkPtr>& lTrackFeatures) {
                         vPointsSLAMLeft[i]) {  // If it is a slam
                                                // point
 
-                        g_square_root_solver->AddSlamPoint(ft->point_state_);
+                        state.square_root_solver->AddSlamPoint(
+                            ft->point_state_);
                         vPointsSLAMLeft[i]--;
                     } else {
-                        g_square_root_solver->AddMsckfPoint(ft->point_state_);
+                        state.square_root_solver->AddMsckfPoint(
+                            ft->point_state_);
                         ft->SetDeadFlag(true, -1);
                     }
                     vPointsLeft[i]--;
 
-                    g_tracked_feature_to_update.push_back(ft);
+                    state.tracked_feature_to_update.push_back(ft);
                 } else {  // if triangulation failed
                     //?? why here we need to set the flag_dead to false?
                     // should keep unchanged?
@@ -465,10 +490,10 @@ bool _tryAddMsckfPoseConstraint(const std::list<LandmarkPtr>& lTrackFeatures) {
         }
     };
     auto bufferPoints = [&]() {
-        for (auto& grid : g_grid22) {
+        for (auto& grid : state.grid22) {
             for (auto& ft : grid) {
                 if (ft->flag_dead_all) {
-                    g_tracked_feature_next_update.push_back(ft);
+                    state.tracked_feature_next_update.push_back(ft);
                 }
             }
             grid.clear();
@@ -502,6 +527,7 @@ bool _tryAddMsckfPoseConstraint(const std::list<LandmarkPtr>& lTrackFeatures) {
 }
 
 int _tryAddStereoPoint(const std::list<LandmarkPtr>& lTrackFeatures) {
+    auto& state = _State();
     bool use_stereo = SensorConfig::Instance().GetCamModel(0)->IsStereo();
     if (!use_stereo) return 0;
 
@@ -552,15 +578,15 @@ int _tryAddStereoPoint(const std::list<LandmarkPtr>& lTrackFeatures) {
                 break;
             }
             if (point->Triangulate()) {
-                if (g_square_root_solver->ComputeJacobians(point)) {
-                    if (g_square_root_solver->MahalanobisTest(
+                if (state.square_root_solver->ComputeJacobians(point)) {
+                    if (state.square_root_solver->MahalanobisTest(
                             point->point_state_)) {
                         points_added++;
                         if (point->flag_slam_point_candidate) {
-                            g_square_root_solver->AddSlamPoint(
+                            state.square_root_solver->AddSlamPoint(
                                 point->point_state_);
                         } else {
-                            g_square_root_solver->AddMsckfPoint(
+                            state.square_root_solver->AddMsckfPoint(
                                 point->point_state_);
                             point->SetDeadFlag(true, -1);
                         }
@@ -576,16 +602,17 @@ int _tryAddStereoPoint(const std::list<LandmarkPtr>& lTrackFeatures) {
 }
 
 void DoDataAssociation(std::list<LandmarkPtr>& vTrackedFeatures, bool static_) {
-    g_tracked_feature_to_update.clear();
+    auto& state = _State();
+    state.tracked_feature_to_update.clear();
 
 #if USE_STATIC_DETECTION
     if (static_) {
-        g_tracked_feature_next_update.clear();
+        state.tracked_feature_next_update.clear();
         return;
     }
 
 #endif
-    static std::vector<LandmarkPtr> vDeadFeature;
+    thread_local std::vector<LandmarkPtr> vDeadFeature;
 
     _addBufferPoints(vDeadFeature);
 
@@ -23,23 +23,61 @@
 
 namespace DeltaVins {
 
+namespace {
+
+using PointBlock = TwoPointRansac::PointBlock;
+using InlierBlock = Eigen::Array<bool, TwoPointRansac::POINT_BLOCK, 1>;
+using PointBlockMap = Eigen::Map<const PointBlock, Eigen::Aligned16>;
+
+/**
+ * @brief Sampson-like epipolar error test of one block of points.
+ * The error of the original formulation is
+ * max(a^2 * f^2 / |l1.xy|^2, a^2 * f^2 / |l2.xy|^2) with a = ray1' * E * ray10,
+ * which is compared against the threshold without any division here.
+ */
+inline InlierBlock BlockInliers(const TwoPointRansac& ransac,
+                                const TwoPointRansac::Hypothesis& hyp,
+                                float thresh, int start) {
+    PointBlockMap x0(&ransac.ray10_x_[start]), y0(&ransac.ray10_y_[start]),
+        z0(&ransac.ray10_z_[start]);
+    PointBlockMap x1(&ransac.ray1_x_[start]), y1(&ransac.ray1_y_[start]),
+        z1(&ransac.ray1_z_[start]);
+    const float cb = hyp.cos_beta;
+    const float sbsa = hyp.sin_beta_sin_alpha;
+    const float sbca = hyp.sin_beta_cos_alpha;
+
+    // l1 = E * ray10
+    PointBlock l1x = -cb * y0 - sbsa * z0;
+    PointBlock l1y = cb * x0 - sbca * z0;
+    PointBlock l1z = sbsa * x0 + sbca * y0;
+    // l2 = E^T * ray1
+    PointBlock l2x = cb * y1 + sbsa * z1;
+    PointBlock l2y = -cb * x1 + sbca * z1;
+
+    PointBlock a = x1 * l1x + y1 * l1y + z1 * l1z;
+    PointBlock n = (l1x.square() + l1y.square()).min(l2x.square() + l2y.square());
+    return a.square() < thresh * n;
+}
+
+}  // namespace
+
 TwoPointRansac::TwoPointRansac(float max_reproject_err, int max_iter_num) {
     max_iter_num_ = max_iter_num;
     max_sqr_reproj_err_ = max_reproject_err * max_reproject_err;
 }
 
-void TwoPointRansac::ComputeEssentialMatrix() {
-    auto& ray1_0 = (*ray1_)[sample0_index_];
-    auto& ray10_0 = ray10_[sample0_index_];
-    auto& ray1_1 = (*ray1_)[sample1_index_];
-    auto& ray10_1 = ray10_[sample1_index_];
+TwoPointRansac::Hypothesis TwoPointRansac::ComputeEssentialMatrix() const {
+    const int i0 = sample0_index_;
+    const int i1 = sample1_index_;
 
-    float ray1_0_x = ray1_0.x(), ray1_0_y = ray1_0.y(), ray1_0_z = ray1_0.z();
-    float ray10_0_x = ray10_0.x(), ray10_0_y = ray10_0.y(),
-          ray10_0_z = ray10_0.z();
-    float ray1_1_x = ray1_1.x(), ray1_1_y = ray1_1.y(), ray1_1_z = ray1_1.z();
-    float ray10_1_x = ray10_1.x(), ray10_1_y = ray10_1.y(),
-          ray10_1_z = ray10_1.z();
+    float ray1_0_x = ray1_x_[i0], ray1_0_y = ray1_y_[i0],
+          ray1_0_z = ray1_z_[i0];
+    float ray10_0_x = ray10_x_[i0], ray10_0_y = ray10_y_[i0],
+          ray10_0_z = ray10_z_[i0];
+    float ray1_1_x = ray1_x_[i1], ray1_1_y = ray1_y_[i1],
+          ray1_1_z = ray1_z_[i1];
+    float ray10_1_x = ray10_x_[i1], ray10_1_y = ray10_y_[i1],
+          ray10_1_z = ray10_z_[i1];
 
     // formulation (10)
     float c1 = ray10_0_x * ray1_0_y - ray1_0_x * ray10_0_y;
@@ -53,32 +91,65 @@ void TwoPointRansac::ComputeEssentialMatrix() {
     float alpha = -atan2(c4 * c2 - c1 * c5, c4 * c3 - c1 * c6);
     float beta = -atan2(c1, c2 * cos(alpha) + c3 * sin(alpha));
     // formulation (7)
-    mE_ << 0, -cos(beta), -sin(beta) * sin(alpha), cos(beta), 0,
-        -sin(beta) * cos(alpha), sin(beta) * sin(alpha), sin(beta) * cos(alpha),
-        0;
+    // E = [0, -cb, -sb*sa; cb, 0, -sb*ca; sb*sa, sb*ca, 0]
+    Hypothesis hyp;
+    hyp.cos_beta = cos(beta);
+    hyp.sin_beta_sin_alpha = sin(beta) * sin(alpha);
+    hyp.sin_beta_cos_alpha = sin(beta) * cos(alpha);
+    return hyp;
 }
 
-int TwoPointRansac::SelectInliers(std::vector<bool>& inliers, int sensor_id) {
-    static float maxSqrErr = max_sqr_reproj_err_;
-    int nInliers = 0;
-    CamModel::Ptr camModel = SensorConfig::Instance().GetCamModel(sensor_id);
-    static const float focal2 = camModel->focal() * camModel->focal();
-    for (int i = 0; i < num_points_; ++i) {
-        Eigen::Vector3f l1 = mE_ * ray10_[i];
-        float a0 = (*ray1_)[i].dot(l1);
-        float s0 = focal2 / (l1.x() * l1.x() + l1.y() * l1.y());
+int TwoPointRansac::ScoreHypotheses(int num_hypotheses, int min_inliers,
+                                    int& best_hypothesis) {
+    const float thresh = max_sqr_reproj_err_ / focal2_;
+    int alive[HYPOTHESIS_BATCH];
+    int num_alive = num_hypotheses;
+    for (int h = 0; h < num_hypotheses; ++h) {
+        alive[h] = h;
+        hypothesis_inliers_[h] = 0;
+    }
 
-        Eigen::Vector3f l2 = mE_.transpose() * (*ray1_)[i];
-        float a1 = ray10_[i].dot(l2);
-        float s1 = focal2 / (l2.x() * l2.x() + l2.y() * l2.y());
+    for (int start = 0; start < num_padded_points_ && num_alive;
+         start += POINT_BLOCK) {
+        const int remaining = std::max(0, num_points_ - start - POINT_BLOCK);
+        for (int k = 0; k < num_alive;) {
+            const int h = alive[k];
+            hypothesis_inliers_[h] +=
+                BlockInliers(*this, hypotheses_[h], thresh, start).count();
+            // preemption: drop hypotheses which can not beat the best one
+            if (hypothesis_inliers_[h] + remaining <= min_inliers) {
+                hypothesis_inliers_[h] = -1;
+                alive[k] = alive[--num_alive];
+            } else {
+                ++k;
+            }
+        }
+    }
 
-        reproj_err_[i] = std::max(a0 * a0 * s0, a1 * a1 * s1);
+    // prefer the earliest hypothesis on ties, as a sequential scan would do
+    int best_inliers = -1;
+    best_hypothesis = -1;
+    for (int h = 0; h < num_hypotheses; ++h) {
+        if (hypothesis_inliers_[h] > best_inliers) {
+            best_inliers = hypothesis_inliers_[h];
+            best_hypothesis = h;
+        }
+    }
+    return best_inliers;
+}
 
-        if (reproj_err_[i] < maxSqrErr) {
-            inliers[i] = true;
-            nInliers++;
-        } else
-            inliers[i] = false;
+int TwoPointRansac::SelectInliers(const Hypothesis& hypothesis,
+                                  std::vector<bool>& inliers) const {
+    const float thresh = max_sqr_reproj_err_ / focal2_;
+    int nInliers = 0;
+    inliers.resize(num_points_);
+    for (int start = 0; start < num_padded_points_; start += POINT_BLOCK) {
+        InlierBlock block = BlockInliers(*this, hypothesis, thresh, start);
+        const int end = std::min(POINT_BLOCK, num_points_ - start);
+        for (int i = 0; i < end; ++i) {
+            inliers[start + i] = block[i];
+            nInliers += block[i];
+        }
     }
     return nInliers;
 }
@@ -89,56 +160,94 @@ int TwoPointRansac::FindInliers(const std::vector<Eigen::Vector2f>& px0,
                                 const std::vector<Eigen::Vector3f>& ray1,
                                 const Eigen::Matrix3f& dR,
                                 std::vector<bool>& inliers, int sensor_id) {
+    (void)px1;
     num_points_ = ray0.size();
     if (num_points_ < 2) {
         inliers.assign(num_points_, false);
         return 0;
     }
-    mdR_ = dR;
-    ray0_ = &ray0;
-    ray1_ = &ray1;
     px0_ = &px0;
-    px1_ = &px1;
-    ray10_.resize(num_points_);
-    reproj_err_.resize(num_points_);
+    num_padded_points_ =
+        (num_points_ + POINT_BLOCK - 1) / POINT_BLOCK * POINT_BLOCK;
     sample_index_ = 0;
 
-    std::vector<bool> vInliers(num_points_);
+    CamModel::Ptr camModel = SensorConfig::Instance().GetCamModel(sensor_id);
+    focal2_ = camModel->focal() * camModel->focal();
 
-    int nMaxInliers = -1;
+    // buffers keep their capacity across calls
+    for (auto* buffer :
+         {&ray10_x_, &ray10_y_, &ray10_z_, &ray1_x_, &ray1_y_, &ray1_z_}) {
+        buffer->resize(num_padded_points_);
+        std::fill(buffer->begin() + num_points_, buffer->end(), 0.f);
+    }
     for (int i = 0; i < num_points_; ++i) {
-        ray10_[i] = mdR_ * ray0[i];
+        Eigen::Vector3f ray10 = dR * ray0[i];
+        ray10_x_[i] = ray10.x();
+        ray10_y_[i] = ray10.y();
+        ray10_z_[i] = ray10.z();
+        ray1_x_[i] = ray1[i].x();
+        ray1_y_[i] = ray1[i].y();
+        ray1_z_[i] = ray1[i].z();
     }
-    for (int it = 0, n = max_iter_num_; it < n; ++it) {
-        if (!NextSample()) break;
-        ComputeEssentialMatrix();
-        const int nInliers = SelectInliers(vInliers, sensor_id);
-        if (nInliers > nMaxInliers) {
-            inliers = vInliers;
-            nMaxInliers = nInliers;
-            n = UpdateIterNum(nInliers);
+
+    int nMaxInliers = -1;
+    Hypothesis best;
+    bool has_samples = true;
+    for (int it = 0, n = max_iter_num_; it < n && has_samples;) {
+        int num_hypotheses = 0;
+        while (num_hypotheses < HYPOTHESIS_BATCH && it < n) {
+            if (!NextSample()) {
+                has_samples = false;
+                break;
+            }
+            hypotheses_[num_hypotheses++] = ComputeEssentialMatrix();
+            ++it;
         }
+        if (!num_hypotheses) break;
+
+        int best_hypothesis;
+        ScoreHypotheses(num_hypotheses, nMaxInliers, best_hypothesis);
+        // the bound may exclude the later hypotheses of the batch
+        n = AcceptHypotheses(num_hypotheses, it - num_hypotheses, n,
+                             nMaxInliers, best);
     }
 
+    if (nMaxInliers >= 0) SelectInliers(best, inliers);
+
     return nMaxInliers;
 }
 
-int TwoPointRansac::UpdateIterNum(int nInliers) {
+int TwoPointRansac::AcceptHypotheses(int num_hypotheses, int first_iter,
+                                     int max_iter, int& max_inliers,
+                                     Hypothesis& best) const {
+    // preempted hypotheses are at -1, they could not beat the best one
+    for (int h = 0; h < num_hypotheses && first_iter + h < max_iter; ++h) {
+        if (hypothesis_inliers_[h] > max_inliers) {
+            best = hypotheses_[h];
+            max_inliers = hypothesis_inliers_[h];
+            max_iter = UpdateIterNum(max_inliers);
+        }
+    }
+    return max_iter;
+}
+
+int TwoPointRansac::UpdateIterNum(int nInliers) const {
     return log(1 - confidence_) /
            log(1 - (1 - double(num_points_ - nInliers) / num_points_) *
                        (1 - double(num_points_ - nInliers) / num_points_));
 }
 
 bool TwoPointRansac::NextSample() {
-    if (sample_index_ >= num_samples_) return false;
-    sample0_index_ = randLists[sample_index_ * 2] % num_points_;
-    sample1_index_ = randLists[sample_index_ * 2 + 1] % num_points_;
-    sample_index_++;
-    if (!IsGoodSample()) NextSample();
-    return true;
+    while (sample_index_ < num_samples_) {
+        sample0_index_ = randLists[sample_index_ * 2] % num_points_;
+        sample1_index_ = randLists[sample_index_ * 2 + 1] % num_points_;
+        sample_index_++;
+        if (IsGoodSample()) return true;
+    }
+    return false;
 }
 
-bool TwoPointRansac::IsGoodSample() {
+bool TwoPointRansac::IsGoodSample() const {
     const float thresh4Sample = 20.f * 20.f;
     return ((*px0_)[sample0_index_] - (*px0_)[sample1_index_]).squaredNorm() >
            thresh4Sample;
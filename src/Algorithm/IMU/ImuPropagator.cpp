@@ -0,0 +1,76 @@
+#include "Algorithm/IMU/ImuPropagator.h"
+
+#include <sophus/se3.hpp>
+
+#include "precompile.h"
+#include "utils/constantDefine.h"
+
+namespace DeltaVins {
+
+namespace {
+// keep at most ~2s of samples at 1kHz when the filter falls behind
+constexpr size_t MAX_PENDING_IMUS = 2000;
+}  // namespace
+
+bool ImuPropagator::SetState(const State& state, Pose& pose) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    if (Tib_.frame_id.empty()) {
+        Tfs<float>::Instance().GetTransform("imu0", "body", Tib_);
+    }
+    state_ = state;
+    while (!imus_.empty() && imus_.front().timestamp <= state_.timestamp) {
+        last_imu_ = imus_.front();
+        imus_.pop_front();
+    }
+    for (const auto& imuData : imus_) _Integrate(imuData);
+    _GetPose(pose);
+    return true;
+}
+
+bool ImuPropagator::AddImu(const ImuData& imuData, Pose& pose) {
+    std::lock_guard<std::mutex> lck(mtx_);
+    imus_.push_back(imuData);
+    if (imus_.size() > MAX_PENDING_IMUS) imus_.pop_front();
+    if (state_.timestamp < 0) {
+        last_imu_ = imuData;
+        return false;
+    }
+    if (imuData.timestamp <= state_.timestamp) return false;
+    _Integrate(imuData);
+    _GetPose(pose);
+    return true;
+}
+
+void ImuPropagator::_Integrate(const ImuData& imuData) {
+    static const Vector3f gravity(0, 0, GRAVITY);
+    if (imuData.timestamp <= state_.timestamp) {
+        last_imu_ = imuData;
+        return;
+    }
+    float dt = (imuData.timestamp - state_.timestamp) * 1e-9f;
+    Vector3f gyro = imuData.gyro;
+    Vector3f acc = imuData.acc;
+    if (last_imu_.timestamp > 0 && last_imu_.timestamp <= state_.timestamp) {
+        gyro = (gyro + last_imu_.gyro) * 0.5f;
+        acc = (acc + last_imu_.acc) * 0.5f;
+    }
+    gyro -= state_.bg;
+    acc -= state_.ba;
+
+    // same model as SquareRootEKFSolver::PropagateStatic
+    Vector3f acc_w = state_.Rwi * acc + gravity;
+    state_.Pwi += state_.Vwi * dt + acc_w * (0.5f * dt * dt);
+    state_.Vwi += acc_w * dt;
+    state_.Rwi =
+        state_.Rwi * Sophus::SO3Group<float>::exp(gyro * dt).matrix();
+    state_.timestamp = imuData.timestamp;
+    last_imu_ = imuData;
+}
+
+void ImuPropagator::_GetPose(Pose& pose) const {
+    pose.timestamp = state_.timestamp;
+    pose.Pwb = state_.Pwi + state_.Rwi * Tib_.Translation();
+    pose.Rwb = state_.Rwi * Tib_.Rotation();
+}
+
+}  // namespace DeltaVins
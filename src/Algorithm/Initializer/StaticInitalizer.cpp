@@ -9,7 +9,7 @@ bool StaticInitializer::Initialize(const ImageData::Ptr imageData) {
     if (last_points_.empty()) {
         // detect feature using shi-tomasi
         cv::goodFeaturesToTrack(imageData->image, last_points_, 100, 0.01, 10);
-        last_image_ = imageData->image;
+        last_image_ = imageData;
         return false;
     }
 
@@ -19,7 +19,7 @@ bool StaticInitializer::Initialize(const ImageData::Ptr imageData) {
     std::vector<cv::Point2f> tracked_points_valid;
 
     // track feature using optical flow
-    cv::calcOpticalFlowPyrLK(last_image_, imageData->image, last_points_,
+    cv::calcOpticalFlowPyrLK(last_image_->image, imageData->image, last_points_,
                              tracked_points, status, err, cv::Size(21, 21), 3);
     float mean_moved_pixels = 0.0f;
     int valid_points = 0;
@@ -46,7 +46,7 @@ bool StaticInitializer::Initialize(const ImageData::Ptr imageData) {
     }
     // 更新上一帧的特征点和图像
     last_points_ = tracked_points_valid;
-    last_image_ = imageData->image;
+    last_image_ = imageData;
 
     return moved_pixels_last_few_frames_ < 0.5f;
 }
@@ -5,17 +5,20 @@
 #include "Algorithm/DataAssociation/DataAssociation.h"
 #include "Algorithm/vision/FeatureTrackerOpticalFlow_Chen.h"
 #include "Algorithm/vision/camModel/camModel.h"
+#include "IO/dataBuffer/imageBuffer.h"
 #include "IO/dataBuffer/imuBuffer.h"
 #include "precompile.h"
+#include "utils/AllocTracker.h"
+#include "utils/Metrics.h"
+#include "utils/Profiler.h"
 #include "utils/SensorConfig.h"
-#include "utils/TickTock.h"
 #include "utils/constantDefine.h"
 #include "utils/utils.h"
 
 namespace DeltaVins {
 VIOAlgorithm::VIOAlgorithm() {
-    feature_tracker_ = new FeatureTrackerOpticalFlow_Chen(Config::MaxNumToTrack,
-                                                          Config::MaskSize);
+    feature_tracker_ = new FeatureTrackerOpticalFlow_Chen(
+        Config::Instance().MaxNumToTrack, Config::Instance().MaskSize);
     solver_ = new SquareRootEKFSolver();
     DataAssociation::InitDataAssociation(solver_);
     states_.init_state_ = InitState::NeedFirstFrame;
@@ -63,17 +66,20 @@ void VIOAlgorithm::_Initialization(const ImageData::Ptr imageData) {
     states_.init_state_ = InitState::FirstFrame;
 }
 
-void VIOAlgorithm::AddNewFrame(const ImageData::Ptr imageData, Pose::Ptr pose) {
-    TickTock::Start("AddFrame");
+bool VIOAlgorithm::AddNewFrame(const ImageData::Ptr imageData, Pose::Ptr pose) {
+    PROFILE_SCOPE_NAMED(add_frame_scope, "AddFrame");
     // Process input data
     _PreProcess(imageData);
 
+    // frames before the initialization would skew the statistics
     if (states_.init_state_ == InitState::FirstFrame) {
         states_.init_state_ = InitState::Initialized;
-        return;
+        add_frame_scope.Cancel();
+        return false;
     }
     if (states_.init_state_ != InitState::Initialized) {
-        return;
+        add_frame_scope.Cancel();
+        return false;
     }
 
 #if TEST_VISION_MODULE
@@ -81,32 +87,116 @@ void VIOAlgorithm::AddNewFrame(const ImageData::Ptr imageData, Pose::Ptr pose) {
     _TestVisionModule(imageData, pose);
 
 #else
-    TickTock::Start("Propagate");
-    // Propagate states
-    _AddImuInformation();
-
-    TickTock::Stop("Propagate");
-
-    TickTock::Start("TrackFeature");
-
-    _TrackFrame(imageData);
-
-    TickTock::Stop("TrackFeature");
-
-    TickTock::Start("Update");
-
-    _SelectKeyframe();
-
-    // Update vision measurement
-    _AddMeasurement();
-    TickTock::Stop("Update");
-
-    TickTock::Stop("AddFrame");
+    telemetry_ = FrameTelemetry();
+    telemetry_.timestamp = imageData->timestamp;
+    {
+        PROFILE_SCOPE("Propagate");
+        // Propagate states
+        _AddImuInformation();
+    }
+    {
+        PROFILE_SCOPE("TrackFeature");
+        _TrackFrame(imageData);
+    }
+    telemetry_.tracked_features = feature_tracker_->NumTrackedFeatures();
+    telemetry_.new_features = feature_tracker_->NumNewFeatures();
+    {
+        PROFILE_SCOPE("Update");
+        _SelectKeyframe();
+
+        // Update vision measurement
+        _AddMeasurement();
+    }
+    add_frame_scope.Stop();
+    auto& image_buffer = ImageBuffer::Instance();
+    telemetry_.dropped_frames = image_buffer.TakeDropped();
+    telemetry_.queue_depth = image_buffer.Size();
+    _PublishMetrics();
+    if (Config::Instance().Telemetry) _WriteTelemetry();
 
     // Process output data
     _PostProcess(imageData, pose);
 #endif
+    return true;
+}
+bool VIOAlgorithm::GetImuState(ImuPropagator::State& state) const {
+    if (states_.init_state_ != InitState::Initialized || !frame_now_)
+        return false;
+    state.timestamp = frame_now_->timestamp;
+    state.Rwi = frame_now_->state->Rwi;
+    state.Pwi = frame_now_->state->Pwi;
+    state.Vwi = states_.vel;
+    ImuBuffer::Instance().GetBias(state.bg, state.ba);
+    return true;
 }
+
+void VIOAlgorithm::FinishOutput() {
+    if (trajectory_writer_) trajectory_writer_->Stop();
+    if (telemetry_writer_) telemetry_writer_->Stop();
+    // before the adapters it draws into are released
+    if (visualizer_) visualizer_->Stop();
+}
+
+void VIOAlgorithm::_PublishMetrics() {
+    METRIC_ADD("dropped_frames_total",
+               "Images overwritten in the full image buffer",
+               telemetry_.dropped_frames);
+    METRIC_SET("image_queue_depth", "Images waiting behind the last one",
+               telemetry_.queue_depth);
+    METRIC_SET("tracked_features", "Landmarks tracked from the last frame",
+               telemetry_.tracked_features);
+    METRIC_SET("new_features", "Landmarks detected in the last frame",
+               telemetry_.new_features);
+    METRIC_SET("msckf_points", "MSCKF points used in the last update",
+               telemetry_.msckf_points);
+    METRIC_SET("slam_points", "SLAM points in the state",
+               telemetry_.slam_points);
+    METRIC_SET("state_dim", "Dimension of the filter state",
+               telemetry_.state_dim);
+    METRIC_SET("static", "1 while the rig is detected to stand still",
+               states_.static_);
+}
+
+void VIOAlgorithm::_WriteTelemetry() {
+    auto& config = Config::Instance();
+    if (!telemetry_writer_) {
+        const bool binary = config.Telemetry == 2;
+        telemetry_writer_.reset(new TelemetryWriter(
+            config.ResultOutputPath +
+                (binary ? "/telemetry.bin" : "/telemetry.csv"),
+            binary));
+        telemetry_writer_->Start();
+    }
+    // same sections as the PROFILE_SCOPEs of the stages
+    static const int add_frame = Profiler::Register("AddFrame");
+    static const int propagate = Profiler::Register("Propagate");
+    static const int track = Profiler::Register("TrackFeature");
+    static const int margin = Profiler::Register("Margin");
+    static const int data_association = Profiler::Register("DataAssociation");
+    static const int stack = Profiler::Register("Stack");
+    static const int solve = Profiler::Register("Solve");
+    auto& profiler = Profiler::Instance();
+    auto take_ms = [&profiler](int section) {
+        return profiler.TakeThreadTotal(section) / 1e6f;
+    };
+    telemetry_.add_frame_ms = take_ms(add_frame);
+    telemetry_.propagate_ms = take_ms(propagate);
+    telemetry_.track_ms = take_ms(track);
+    telemetry_.margin_ms = take_ms(margin);
+    telemetry_.data_association_ms = take_ms(data_association);
+    telemetry_.stack_ms = take_ms(stack);
+    telemetry_.solve_ms = take_ms(solve);
+    telemetry_.track_counters = profiler.TakeThreadCounters(track);
+    telemetry_.margin_counters = profiler.TakeThreadCounters(margin);
+    telemetry_.data_association_counters =
+        profiler.TakeThreadCounters(data_association);
+    telemetry_.solve_counters = profiler.TakeThreadCounters(solve);
+    telemetry_.allocations = AllocTracker::TakeThreadAllocations();
+    telemetry_.live_bytes = AllocTracker::LiveBytes();
+    telemetry_.peak_rss_kb = AllocTracker::PeakRssKb();
+    telemetry_writer_->Write(telemetry_);
+}
+
 void VIOAlgorithm::SetWorldPointAdapter(WorldPointAdapter* adapter) {
     world_point_adapter_ = adapter;
 }
@@ -124,7 +214,7 @@ void VIOAlgorithm::_PreProcess(const ImageData::Ptr imageData) {
 #if ENABLE_VISUALIZER && !defined(PLATFORM_ARM)
     frame_now_->image = imageData->image.clone();  // Only used for debugging
 #endif
-    static auto& imuBuffer = ImuBuffer::Instance();
+    auto& imuBuffer = ImuBuffer::Instance();
     if (states_.init_state_ == InitState::NeedFirstFrame) {
         preintergration_.t0 = timestamp;
         states_.init_state_ = InitState::NotInitialized;
@@ -160,12 +250,11 @@ void VIOAlgorithm::_PostProcess(ImageData::Ptr data, Pose::Ptr pose) {
     Vwi = states_.vel;
     pose->timestamp = frame_now_->timestamp;
 
-    static Transform<float> Tib;
-    if (Tib.frame_id.empty()) {
-        Tfs<float>::Instance().GetTransform("imu0", "body", Tib);
+    if (Tib_.frame_id.empty()) {
+        Tfs<float>::Instance().GetTransform("imu0", "body", Tib_);
     }
-    pose->Pwb = Pwi + Rwi * Tib.Translation();
-    pose->Rwb = Rwi * Tib.Rotation();
+    pose->Pwb = Pwi + Rwi * Tib_.Translation();
+    pose->Rwb = Rwi * Tib_.Rotation();
 
     ImuBuffer::Instance().GetBias(bg, ba);
 
@@ -182,91 +271,74 @@ void VIOAlgorithm::_PostProcess(ImageData::Ptr data, Pose::Ptr pose) {
     // Pwi = Twi_isometry.translation();
     // _q = Quaternionf(Rwi);
 
-    std::string outputName = Config::outputFileName;
-    static FILE* file = fopen(outputName.c_str(), "w");
-    // static FILE* stdvar = fopen("stdvar.csv", "w");
-
     // Vector3f ea = Rwi.transpose().eulerAngles(0, 1, 2);
 #ifndef PLATORM_ARM
-    if (Config::OutputFormat == ResultOutputFormat::EUROC) {
-        fprintf(
-            file,
-            "%lld,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%9.6f,%9.6f,%9.6f,%9.6f,%9.6f,%"
-            "9.6f\n",
-            pose->timestamp, pose->Pwb[0], pose->Pwb[1], pose->Pwb[2], _q.w(),
-            _q.x(), _q.y(), _q.z(), Vwi[0], Vwi[1], Vwi[2], bg[0], bg[1], bg[2],
-            ba[0], ba[1], ba[2]);
-        fflush(file);
-    } else if (Config::OutputFormat == ResultOutputFormat::KITTI) {
-        // TODO: Implement KITTI format
-        throw std::runtime_error("KITTI format is not implemented");
-    } else if (Config::OutputFormat == ResultOutputFormat::TUM) {
-        fprintf(file, "%lf %f %f %f %f %f %f %f\n", pose->timestamp / 1e9,
-                pose->Pwb[0], pose->Pwb[1], pose->Pwb[2], _q.x(), _q.y(),
-                _q.z(), _q.w());
-        fflush(file);
+    if (!trajectory_writer_) {
+        trajectory_writer_.reset(
+            new TrajectoryWriter(Config::Instance().outputFileName,
+                                 Config::Instance().OutputFormat));
+        trajectory_writer_->Start();
+    }
+    TrajectoryWriter::Record record;
+    record.timestamp = pose->timestamp;
+    const float q[4] = {_q.w(), _q.x(), _q.y(), _q.z()};
+    for (int i = 0; i < 3; i++) {
+        record.position[i] = pose->Pwb[i];
+        record.velocity[i] = Vwi[i];
+        record.gyro_bias[i] = bg[i];
+        record.acc_bias[i] = ba[i];
     }
+    for (int i = 0; i < 4; i++) record.rotation[i] = q[i];
+    trajectory_writer_->Write(record);
 #endif
-    if (!Config::NoDebugOutput) {
+    if (!Config::Instance().NoDebugOutput) {
         LOGI(
-            "\nTimestamp:%lld\n Position:%f,%f,%f\n "
-            "Q:%f,%f,%f,%f\nVelocity:%f,%f,%f",
+            "Timestamp:%lld Position:%f,%f,%f Q:%f,%f,%f,%f Velocity:%f,%f,%f "
+            "Gyro Bias:%9.6f,%9.6f,%9.6f Acc Bias:%9.6f,%9.6f,%9.6f",
             pose->timestamp, Pwi[0], Pwi[1], Pwi[2], _q.w(), _q.x(), _q.y(),
-            _q.z(), Vwi[0], Vwi[1], Vwi[2]);
-        LOGI("\nGyro Bias:%9.6f,%9.6f,%9.6f\nAcc Bias:%9.6f,%9.6f,%9.6f", bg[0],
-             bg[1], bg[2], ba[0], ba[1], ba[2]);
+            _q.z(), Vwi[0], Vwi[1], Vwi[2], bg[0], bg[1], bg[2], ba[0], ba[1],
+            ba[2]);
     }
-    // fflush(file);
-
-#if ENABLE_VISUALIZER || ENABLE_VISUALIZER_TCP || USE_ROS2
-    if (!Config::NoGUI) {
-        cv::Mat trackImage_left;
-        cv::Mat trackImage_right;
-        _DrawTrackImage(data, trackImage_left, 0);
-        bool is_stereo = SensorConfig::Instance().GetCamModel(0)->IsStereo();
-        if (is_stereo) {
-            _DrawTrackImage(data, trackImage_right, 1);
-        }
-        if (frame_adapter_) {
-            frame_adapter_->PushImageTexture(
-                trackImage_left.data, trackImage_left.cols,
-                trackImage_left.rows, trackImage_left.channels(),
-                "track_image_left");
-            if (is_stereo) {
-                frame_adapter_->PushImageTexture(
-                    trackImage_right.data, trackImage_right.cols,
-                    trackImage_right.rows, trackImage_right.channels(),
-                    "track_image_right");
-            }
-            frame_adapter_->FinishFrame();
-        } else {
-            LOGW("frame_adapter_ is nullptr");
-        }
 
-        // cv::imshow("track", trackImage);
-        // imshow("FeatureTrack",trackImage);
-        // waitKey(1);
+#if ENABLE_VISUALIZER || ENABLE_VISUALIZER_TCP || ENABLE_VISUALIZER_SHM || \
+    USE_ROS2
+    if (!Config::Instance().NoGUI && _AcquireVisualSnapshot()) {
+        _TakeTracksSnapshot(data);
+        visualizer_->Publish(std::move(visual_snapshot_));
     }
 #endif
-    TickTock::outputResultConsole();
+}
+
+bool VIOAlgorithm::_AcquireVisualSnapshot() {
+    if (visual_snapshot_) return true;
+    if (!frame_adapter_) {
+        LOGW("frame_adapter_ is nullptr");
+        return false;
+    }
+    if (!visualizer_) {
+        visualizer_.reset(new VisualizerPublisher(
+            frame_adapter_, world_point_adapter_,
+            Config::Instance().VisualizerFPS));
+        visualizer_->Start();
+    }
+    visual_snapshot_ = visualizer_->Acquire(frame_now_->timestamp);
+    return visual_snapshot_ != nullptr;
 }
 
 void VIOAlgorithm::_UpdatePointsAndCamsToVisualizer() {
-#if ENABLE_VISUALIZER || ENABLE_VISUALIZER_TCP || USE_ROS2
+#if ENABLE_VISUALIZER || ENABLE_VISUALIZER_TCP || ENABLE_VISUALIZER_SHM || \
+    USE_ROS2
+    if (!_AcquireVisualSnapshot()) return;
 
-    static std::vector<WorldPointGL> vPointsGL;
-    static std::vector<FrameGL> vFramesGL;
+    auto& vPointsGL = visual_snapshot_->points;
+    auto& vFramesGL = visual_snapshot_->frames;
     vPointsGL.clear();
     vFramesGL.clear();
-    vPointsGL.reserve(300);
-    vFramesGL.reserve(100);
-
-    static int visCounter = 0;
 
     for (auto lTrack : states_.tfs_) {
         if (lTrack->point_state_ && lTrack->point_state_->flag_slam_point) {
             if (lTrack->point_state_->m_idVis < 0)
-                lTrack->point_state_->m_idVis = visCounter++;
+                lTrack->point_state_->m_idVis = vis_counter_++;
             vPointsGL.emplace_back(lTrack->point_state_->Pw * 1e3,
                                    lTrack->point_state_->m_idVis);
         }
@@ -276,14 +348,53 @@ void VIOAlgorithm::_UpdatePointsAndCamsToVisualizer() {
         vFramesGL.emplace_back(frame->state->Rwi.matrix(),
                                frame->state->Pwi * 1e3, frame->state->m_id);
     }
-    if (!Config::NoGUI) {
-        assert(frame_adapter_ && world_point_adapter_);
-        frame_adapter_->PushViewMatrix(vFramesGL);
-        world_point_adapter_->PushWorldPoint(vPointsGL);
-    }
+    visual_snapshot_->has_map = true;
 #endif
 }
 
+void VIOAlgorithm::_TakeTracksSnapshot(ImageData::Ptr dataPtr) {
+    auto& snapshot = *visual_snapshot_;
+    const bool is_stereo = SensorConfig::Instance().GetCamModel(0)->IsStereo();
+    snapshot.num_cams = is_stereo ? 2 : 1;
+    snapshot.image_data = dataPtr;
+    snapshot.images[0] = dataPtr->image;
+    snapshot.images[1] = is_stereo ? dataPtr->right_image : cv::Mat();
+    for (auto& image : snapshot.images) {
+        // pixels of the caller, not owned by any cv::Mat
+        if (!image.empty() && !image.u) image = image.clone();
+    }
+
+    // as _DrawTrackImage, without drawing
+    snapshot.tracks.clear();
+    for (int cam_id = 0; cam_id < snapshot.num_cams; ++cam_id) {
+        snapshot.num_tracked[cam_id] = 0;
+        for (auto& lTrack : states_.tfs_) {
+            if (lTrack->flag_dead[cam_id]) continue;
+            snapshot.num_tracked[cam_id]++;
+
+            VisualSnapshot::Track track;
+            track.cam_id = cam_id;
+            if (!lTrack->flag_dead[0] && !lTrack->flag_dead[1] &&
+                lTrack->valid_obs_num > 5)
+                track.color = _PURPLE_SCALAR;
+            else if (lTrack->point_state_ &&
+                     lTrack->point_state_->flag_slam_point)
+                track.color = _GREEN_SCALAR;
+            else if (lTrack->num_obs_tracked > 5)
+                track.color = _BLUE_SCALAR;
+            else
+                track.color = _RED_SCALAR;
+            track.num_px = 0;
+            auto& obs = lTrack->visual_obs[cam_id];
+            for (auto it = obs.rbegin();
+                 it != obs.rend() && track.num_px < track.MAX_PX; ++it)
+                track.px[track.num_px++] = (*it)->px;
+            track.last_px = lTrack->last_obs_[cam_id]->px;
+            snapshot.tracks.push_back(track);
+        }
+    }
+}
+
 void VIOAlgorithm::_DrawTrackImage(ImageData::Ptr dataPtr, cv::Mat& trackImage,
                                    int cam_id) {
     if (cam_id == 0)
@@ -396,34 +507,41 @@ void VIOAlgorithm::_RemoveDeadFeatures() {
 void VIOAlgorithm::_AddMeasurement() {
     _DetectStill();
 
-    TickTock::Start("Margin");
-    _MarginFrames();
-    TickTock::Stop("Margin");
+    {
+        PROFILE_SCOPE("Margin");
+        _MarginFrames();
+    }
 
     if (states_.tfs_.empty()) return;
 
-    TickTock::Start("DataAssociation");
-    DataAssociation::DoDataAssociation(states_.tfs_, states_.static_);
-
-    TickTock::Stop("DataAssociation");
+    {
+        PROFILE_SCOPE("DataAssociation");
+        DataAssociation::DoDataAssociation(states_.tfs_, states_.static_);
+    }
 #if ENABLE_VISUALIZER && !defined(PLATFORM_ARM)
     DataAssociation::DrawPointsBeforeUpdates(solver_->slam_point_);
 #endif
 
-    TickTock::Start("Stack");
-    _StackInformationFactorMatrix();
-
-    TickTock::Stop("Stack");
-
-    TickTock::Start("Solve");
-    solver_->SolveAndUpdateStates();
-    TickTock::Stop("Solve");
+    {
+        PROFILE_SCOPE("Stack");
+        _StackInformationFactorMatrix();
+    }
+    // the solver clears the msckf points when solving
+    telemetry_.msckf_points = solver_->msckf_points_.size();
+    telemetry_.slam_points = solver_->slam_point_.size();
+    telemetry_.stacked_rows = solver_->stacked_rows_;
+    telemetry_.state_dim = solver_->CURRENT_DIM;
+    {
+        PROFILE_SCOPE("Solve");
+        solver_->SolveAndUpdateStates();
+    }
 #if ENABLE_VISUALIZER && !defined(PLATFORM_ARM)
     DataAssociation::DrawPointsAfterUpdates(solver_->slam_point_);
-    if (!Config::NoGUI) cv::waitKey(5);
+    if (!Config::Instance().NoGUI) cv::waitKey(5);
 #endif
-#if ENABLE_VISUALIZER_TCP || ENABLE_VISUALIZER || USE_ROS2
-    if (!Config::NoGUI) _UpdatePointsAndCamsToVisualizer();
+#if ENABLE_VISUALIZER_TCP || ENABLE_VISUALIZER || ENABLE_VISUALIZER_SHM || \
+    USE_ROS2
+    if (!Config::Instance().NoGUI) _UpdatePointsAndCamsToVisualizer();
 #endif
     _RemoveDeadFeatures();
 }
@@ -444,7 +562,7 @@ void VIOAlgorithm::_SelectFrames2Margin() {
         }
     }
     if (!cnt && nCams >= MAX_WINDOW_SIZE) {
-        static int camIdxToMargin = 0;
+        int& camIdxToMargin = cam_idx_to_margin_;
         camIdxToMargin += CAM_DELETE_STEP;
         if (camIdxToMargin >= nCams - 1) camIdxToMargin = 1;
         if (nKF > 4) {
@@ -509,6 +627,8 @@ void VIOAlgorithm::_MarginFrames() {
 
     for (auto frame : states_.frames_)
         if (!frame->state->flag_to_marginalize) vCamStatesNew.push_back(frame);
+    telemetry_.marginalized_frames =
+        states_.frames_.size() - vCamStatesNew.size();
     states_.frames_ = vCamStatesNew;
     states_.frames_.push_back(frame_now_);
 }
@@ -523,7 +643,7 @@ bool VIOAlgorithm::_VisionStatic() {
 }
 
 void VIOAlgorithm::_DetectStill() {
-    static auto& buffer = ImuBuffer::Instance();
+    auto& buffer = ImuBuffer::Instance();
     bool bStatic = buffer.DetectStatic(frame_now_->timestamp);
 
     if (bStatic) {
@@ -559,7 +679,7 @@ void VIOAlgorithm::_TestVisionModule(const ImageData::Ptr data,
     cv::imshow("Predict", PredictImage);
     cv::waitKey(0);
 #elif USE_ROS2
-    if (!Config::NoGUI) {
+    if (!Config::Instance().NoGUI) {
         cv::Mat trackImage_left;
         cv::Mat trackImage_right;
         _DrawTrackImage(data, trackImage_left, 0);
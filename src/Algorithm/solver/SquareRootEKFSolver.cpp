@@ -8,7 +8,7 @@
 #include "IO/dataBuffer/OdometerBuffer.h"
 #include "precompile.h"
 #include "utils/SensorConfig.h"
-#include "utils/TickTock.h"
+#include "utils/Profiler.h"
 #include "utils/constantDefine.h"
 #include "utils/utils.h"
 #include "utils/tf.h"
@@ -19,7 +19,7 @@ SquareRootEKFSolver::SquareRootEKFSolver() {}
 void SquareRootEKFSolver::Init(CamState* state, Vector3f* vel, bool* _static) {
     VectorXf p(NEW_STATE_DIM);
 
-    switch (Config::DataSourceType) {
+    switch (Config::Instance().DataSourceType) {
         case DataSrcEuroc:
             p << 1e-4, 1e-4, 1e-4, 1e-2, 1e-2, 1e-2, 1e-3, 1e-3, 1e-3, 1e-4,
                 1e-4, 1e-4, 1e-2, 1e-2, 1e-2;
@@ -61,7 +61,7 @@ void SquareRootEKFSolver::PropagateStatic(const ImuPreintergration* imu_term) {
     new_state_->Rwi = R0 * imu_term->dR;
 
     // Make state transition matrix F
-    static Eigen::Matrix<float, NEW_STATE_DIM, NEW_STATE_DIM>
+    thread_local Eigen::Matrix<float, NEW_STATE_DIM, NEW_STATE_DIM>
         state_transition_matrix;  // q, p, bg, v, ba
     state_transition_matrix.setIdentity();
     state_transition_matrix.block<3, 3>(0, 0) = imu_term->dR.transpose();
@@ -75,14 +75,14 @@ void SquareRootEKFSolver::PropagateStatic(const ImuPreintergration* imu_term) {
     state_transition_matrix.block<3, 3>(9, 12) = R0 * imu_term->dVda;
 
     // make noise transition matrix
-    static Eigen::Matrix<float, NEW_STATE_DIM, 9> noise_transition_matrix;
+    thread_local Eigen::Matrix<float, NEW_STATE_DIM, 9> noise_transition_matrix;
     noise_transition_matrix.setZero();
     noise_transition_matrix.block<3, 3>(0, 0).setIdentity();
     noise_transition_matrix.block<3, 3>(3, 6) = R0;
     noise_transition_matrix.block<3, 3>(9, 3) = R0;
 
     // Make Noise Covariance Matrix Q
-    static Eigen::Matrix<float, NEW_STATE_DIM, NEW_STATE_DIM> noise_cov;
+    thread_local Eigen::Matrix<float, NEW_STATE_DIM, NEW_STATE_DIM> noise_cov;
     const float gyro_bias_noise =
         SensorConfig::Instance().GetIMUParams(imu_term->sensor_id).gyro_noise;
     const float acc_bias_noise =
@@ -100,7 +100,7 @@ void SquareRootEKFSolver::PropagateStatic(const ImuPreintergration* imu_term) {
     noise_cov.block<3, 3>(12, 12) =
         Matrix3f::Identity() * (acc_bias_noise2 * dt * dt);
 
-    static Eigen::Matrix<float, NEW_STATE_DIM, NEW_STATE_DIM> NoiseFactor;
+    thread_local Eigen::Matrix<float, NEW_STATE_DIM, NEW_STATE_DIM> NoiseFactor;
     NoiseFactor.setIdentity();
     Eigen::LLT<MatrixXf> chol(noise_cov);
     chol.matrixU().solveInPlace(NoiseFactor);
@@ -386,40 +386,60 @@ void SquareRootEKFSolver::PropagateStatic(const ImuPreintergration* imu_term) {
 
 #endif
 
+void SquareRootEKFSolver::_UpdateInfoFactorInverse() {
+    if (!info_factor_inverse_dirty_) return;
+    PROFILE_SCOPE("FactorInverse");
+    auto inverse =
+        info_factor_inverse_matrix_.topLeftCorner(CURRENT_DIM, CURRENT_DIM);
+    inverse.setIdentity();
+    info_factor_matrix_after_mariginal_.topLeftCorner(CURRENT_DIM, CURRENT_DIM)
+        .triangularView<Eigen::Upper>()
+        .solveInPlace(inverse);
+    info_factor_inverse_dirty_ = false;
+}
+
 bool SquareRootEKFSolver::MahalanobisTest(PointState* state) {
-    VectorXf z = state->H.rightCols<1>();
+    const auto z = state->H.rightCols<1>();
     // int nExceptPoint = state->H.cols() - 1;
     int num_obs = z.rows();
 #if USE_NAIVE_ML_DATAASSOCIATION
     float phi;
-    static const float ImageNoise2 =
+    const float ImageNoise2 =
         SensorConfig::Instance().GetCameraParams(0).image_noise *
         SensorConfig::Instance().GetCameraParams(0).image_noise;
     if (state->flag_slam_point) {
-        MatrixXf S;
-        MatrixXf R = MatrixXf::Identity(num_obs, num_obs) * ImageNoise2 * 2;
-        MatrixXf E;
-        MatrixXf H;
-        H.resize(num_obs, 9);
-        S.resize(num_obs, num_obs);
-        E.resize(CURRENT_DIM, 9);
+        // S = H * R^-1 * R^-T * H^T + R, only the rows of R^-1 belonging to
+        // the point and its host camera are touched
+        using MatrixBf = Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic,
+                                       Eigen::RowMajor, 4, MAX_MATRIX_SIZE>;
+        using MatrixSf =
+            Eigen::Matrix<float, Eigen::Dynamic, Eigen::Dynamic, 0, 4, 4>;
+        assert(num_obs <= 4);
+        _UpdateInfoFactorInverse();
+
         int iLeft = IMU_STATE_DIM;
         int cam_idx =
             state->host->flag_dead[0]
                 ? state->host->last_obs_[1]->link_frame->state->index_in_window
                 : state->host->last_obs_[0]->link_frame->state->index_in_window;
-        E.leftCols<3>() = info_factor_matrix_after_mariginal_.block(
-            0, state->index_in_window * 3 + iLeft, CURRENT_DIM, 3);
-        E.rightCols<6>() = info_factor_matrix_after_mariginal_.block(
-            0, cam_idx * CAM_STATE_DIM + iLeft + 3 * slam_point_.size(),
-            CURRENT_DIM, 6);
-        Matrix9f F = E.transpose() * E;
-        H.leftCols<3>() = state->H.leftCols<3>();
-        H.rightCols<6>() = state->H.middleCols<6>(3 + cam_idx * CAM_STATE_DIM);
-        S = H * F.inverse() * H.transpose();
-        S.noalias() += R;
-
-        phi = z.transpose() * S.inverse() * z;
+        const int point_col = state->index_in_window * 3 + iLeft;
+        const int cam_col =
+            cam_idx * CAM_STATE_DIM + iLeft + 3 * slam_point_.size();
+        // R^-1 is upper triangular, nothing left of point_col is needed
+        const int num_cols = CURRENT_DIM - point_col;
+
+        MatrixBf B(num_obs, num_cols);
+        B.noalias() = state->H.leftCols<3>() *
+                      info_factor_inverse_matrix_.block(point_col, point_col,
+                                                        3, num_cols);
+        B.noalias() += state->H.middleCols<6>(3 + cam_idx * CAM_STATE_DIM) *
+                       info_factor_inverse_matrix_.block(cam_col, point_col,
+                                                         6, num_cols);
+        MatrixSf S(num_obs, num_obs);
+        S.noalias() = B * B.transpose();
+        S.diagonal().array() += ImageNoise2 * 2;
+
+        phi = z.dot(S.llt().solve(z));
     } else {
         phi = z.dot(z) / (2 * ImageNoise2);
     }
@@ -641,41 +661,19 @@ int SquareRootEKFSolver::_AddSlamPointConstraint() {
     }
 
     // Step 2: stack slam point matrix and batch update
-    int nTotalObs = 0;
-
-    float invSigma =
-        1.0 / SensorConfig::Instance().GetCameraParams(0).image_noise;
-    // Step 1: process old slam point states
-    int nCamStartIdx = IMU_STATE_DIM + slam_point_.size() * 3;
-    int nCamStates = cam_states_.size() * CAM_STATE_DIM;
-    int nSlamPointStartIdx = IMU_STATE_DIM;
+    stack_points_.clear();
     for (auto point : slam_point_) {
         if (point->flag_to_marginalize) continue;
-        int obs = point->H.rows();
-        // if stack is full, batch update
-        if (obs + stacked_rows_ > MAX_OBS_SIZE) {
-            _UpdateByGivensRotations(stacked_rows_, CURRENT_DIM);
-            _ClearStackedMatrix();
-        }
-        point->H *= invSigma;
-        int slam_idx = point->index_in_window;
-
-        stacked_matrix_.block(stacked_rows_, nCamStartIdx, obs, nCamStates) =
-            point->H.middleCols(3, nCamStates);
-        stacked_matrix_.block(stacked_rows_, nSlamPointStartIdx + slam_idx * 3,
-                              obs, 3) = point->H.leftCols<3>();
-        obs_residual_.segment(stacked_rows_, obs) = point->H.rightCols<1>();
-        stacked_rows_ += obs;
-        nTotalObs += obs;
+        stack_points_.push_back(point);
     }
 
-    return nTotalObs;
+    return _StackPointConstraints(true);
 }
 
 void SquareRootEKFSolver::AddMsckfPoint(PointState* state) {
     // constexpr int MAX_DIM =
     // 3 + (CAM_STATE_DIM * MAX_WINDOW_SIZE + IMU_STATE_DIM + 1);
-    static MatrixHfR H;
+    thread_local MatrixHfR H;
     // do null space trick to get pose constraint
     int col = state->H.cols();
     int row = state->H.rows();
@@ -739,28 +737,103 @@ void SquareRootEKFSolver::AddVelocityConstraint() {
 }
 
 int SquareRootEKFSolver::_AddMsckfPointConstraint() {
-    int nTotalObs = 0;
+    stack_points_ = msckf_points_;
+    return _StackPointConstraints(false);
+}
+
+namespace {
+
+/**
+ * @brief Triangularize the rows of one point constraint in place by a local
+ * QR on the columns it touches. The last column is the residual. Rows beyond
+ * the number of touched columns only carry residual and are dropped.
+ */
+void CompressPointRows(MatrixXfR& H) {
+    const int num_rows = H.rows();
+    const int num_cols = H.cols() - 1;
+    int begin = 0, end = num_cols;
+    while (begin < end && H.col(begin).isZero(0)) ++begin;
+    while (end > begin && H.col(end - 1).isZero(0)) --end;
+    const int span = end - begin;
+    if (num_rows < 2 || span == 0) return;
+
+    Eigen::HouseholderQR<MatrixXf> qr(H.middleCols(begin, span));
+    VectorXf r = qr.householderQ().adjoint() * H.rightCols<1>();
+    const int keep = std::min(num_rows, span);
+    H.middleCols(begin, span) =
+        qr.matrixQR().triangularView<Eigen::Upper>();
+    H.rightCols<1>() = r;
+    if (keep < num_rows) H.conservativeResize(keep, Eigen::NoChange);
+}
+
+}  // namespace
+
+int SquareRootEKFSolver::_StackPointConstraints(bool slam_point) {
+    const int num_points = stack_points_.size();
     float invSigma =
         1.0 / SensorConfig::Instance().GetCameraParams(0).image_noise;
     int nCamStartIdx = IMU_STATE_DIM + slam_point_.size() * 3;
     int nCamStates = cam_states_.size() * CAM_STATE_DIM;
-    for (auto& track : msckf_points_) {
-        int num_obs = track->H.rows();
-        track->H *= invSigma;
+    int nSlamPointStartIdx = IMU_STATE_DIM;
 
+    int nTotalRows = 0;
+    for (auto point : stack_points_) nTotalRows += point->H.rows();
+    // the stack would overflow, shrink every block before the serial merge
+    const bool compress = stacked_rows_ + nTotalRows > MAX_OBS_SIZE;
+
+    cv::parallel_for_(cv::Range(0, num_points), [&](const cv::Range& range) {
+        for (int i = range.start; i < range.end; ++i) {
+            auto& H = stack_points_[i]->H;
+            H *= invSigma;
+            if (compress) CompressPointRows(H);
+        }
+    });
+
+    int nTotalObs = 0;
+    for (int begin = 0; begin < num_points;) {
+        // assign rows to the points which still fit into the stack
+        stack_row_offsets_.clear();
+        int end = begin;
+        int rows = stacked_rows_;
+        for (; end < num_points; ++end) {
+            int obs = stack_points_[end]->H.rows();
+            if (rows + obs > MAX_OBS_SIZE) break;
+            stack_row_offsets_.push_back(rows);
+            rows += obs;
+        }
         // if stack is full, batch update
-        if (stacked_rows_ + num_obs > MAX_OBS_SIZE) {
+        if (end == begin) {
             _UpdateByGivensRotations(stacked_rows_, CURRENT_DIM);
             _ClearStackedMatrix();
+            continue;
         }
 
-        stacked_matrix_.block(stacked_rows_, nCamStartIdx, num_obs,
-                              nCamStates) = track->H.leftCols(nCamStates);
-        //.triangularView<Eigen::Upper>();
+        cv::parallel_for_(cv::Range(begin, end), [&](const cv::Range& range) {
+            for (int i = range.start; i < range.end; ++i) {
+                const auto point = stack_points_[i];
+                const auto& H = point->H;
+                const int row = stack_row_offsets_[i - begin];
+                const int obs = H.rows();
+                if (slam_point) {
+                    int slam_idx = point->index_in_window;
+                    stacked_matrix_.block(row, nCamStartIdx, obs,
+                                          nCamStates) =
+                        H.middleCols(3, nCamStates);
+                    stacked_matrix_.block(
+                        row, nSlamPointStartIdx + slam_idx * 3, obs, 3) =
+                        H.leftCols<3>();
+                } else {
+                    stacked_matrix_.block(row, nCamStartIdx, obs,
+                                          nCamStates) =
+                        H.leftCols(nCamStates);
+                }
+                obs_residual_.segment(row, obs) = H.rightCols<1>();
+            }
+        });
 
-        obs_residual_.segment(stacked_rows_, num_obs) = track->H.rightCols<1>();
-        stacked_rows_ += num_obs;
-        nTotalObs += num_obs;
+        nTotalObs += rows - stacked_rows_;
+        stacked_rows_ = rows;
+        begin = end;
     }
 
     return nTotalObs;
@@ -822,7 +895,7 @@ int SquareRootEKFSolver::StackInformationFactorMatrix() {
     nVisualObs += _AddSlamPointConstraint();
     nVisualObs += _AddMsckfPointConstraint();
 
-    if (Config::UseOdometer) {
+    if (Config::Instance().UseOdometer) {
         AddOdomVelocityConstraint();
     }
 
@@ -838,17 +911,17 @@ int SquareRootEKFSolver::StackInformationFactorMatrix() {
 void SquareRootEKFSolver::SolveAndUpdateStates() {
     int haveNewInformation = stacked_rows_;
     if (haveNewInformation) {
-        TickTock::Start("Givens");
-        _UpdateByGivensRotations(haveNewInformation, CURRENT_DIM + 1);
-        TickTock::Stop("Givens");
-
-        TickTock::Start("Inverse");
+        {
+            PROFILE_SCOPE("Givens");
+            _UpdateByGivensRotations(haveNewInformation, CURRENT_DIM + 1);
+        }
 
+        PROFILE_SCOPE_NAMED(inverse_scope, "Inverse");
         VectorXf dx =
             info_factor_matrix_.topLeftCorner(CURRENT_DIM, CURRENT_DIM)
                 .triangularView<Eigen::Upper>()
                 .solve(residual_.segment(0, CURRENT_DIM));
-        TickTock::Stop("Inverse");
+        inverse_scope.Stop();
 
         int iDim = 0;
 
@@ -870,6 +943,8 @@ void SquareRootEKFSolver::SolveAndUpdateStates() {
             camState->Pwi += dx.segment<3>(iDim);
             iDim += 3;
         }
+
+        info_factor_inverse_dirty_ = true;
     }
 
     msckf_points_.clear();
@@ -880,7 +955,73 @@ void SquareRootEKFSolver::_updateByGivensRotationsNeon() {}
 
 #endif
 
+int SquareRootEKFSolver::_CompressStackedRowsByTreeQR(int row) {
+    const int nDim = CURRENT_DIM;
+    // only worth it when there are clearly more rows than states
+    if (row < 2 * nDim) return row;
+
+    // the partition only depends on the problem size, never on the number of
+    // threads, so the reduction is bit-identical however it is scheduled
+    const int group_rows = nDim;
+    const int num_groups = (row + group_rows - 1) / group_rows;
+
+    // each block is [R | r], upper triangular with at most nDim rows
+    auto qrCompress = [nDim](MatrixXf& block) {
+        Eigen::HouseholderQR<MatrixXf> qr(block);
+        const int keep = std::min<int>(block.rows(), nDim);
+        block = qr.matrixQR().topRows(keep).triangularView<Eigen::Upper>();
+    };
+
+    // Step 1: compress disjoint groups of stacked rows, the scratch matrices
+    // are kept across updates and only grow
+    if ((int)tree_qr_blocks_.size() < num_groups) {
+        tree_qr_blocks_.resize(num_groups);
+        tree_qr_merged_.resize(num_groups);
+    }
+    auto& blocks = tree_qr_blocks_;
+    cv::parallel_for_(cv::Range(0, num_groups), [&](const cv::Range& range) {
+        for (int g = range.start; g < range.end; ++g) {
+            const int begin = g * group_rows;
+            const int rows = std::min(group_rows, row - begin);
+            auto& block = blocks[g];
+            block.resize(rows, nDim + 1);
+            block.leftCols(nDim) =
+                stacked_matrix_.block(begin, 0, rows, nDim);
+            block.col(nDim) = obs_residual_.segment(begin, rows);
+            qrCompress(block);
+        }
+    });
+
+    // Step 2: merge the blocks pairwise in a tree
+    for (int stride = 1; stride < num_groups; stride *= 2) {
+        const int num_pairs = (num_groups + 2 * stride - 1) / (2 * stride);
+        cv::parallel_for_(cv::Range(0, num_pairs), [&](const cv::Range& range) {
+            for (int p = range.start; p < range.end; ++p) {
+                const int i = p * 2 * stride;
+                const int j = i + stride;
+                if (j >= num_groups) continue;
+                auto& merged = tree_qr_merged_[i];
+                merged.resize(blocks[i].rows() + blocks[j].rows(), nDim + 1);
+                merged << blocks[i], blocks[j];
+                qrCompress(merged);
+                blocks[i].swap(merged);
+            }
+        });
+    }
+
+    // Step 3: write the final block back for the Givens merge
+    const auto& block = blocks[0];
+    const int new_rows = block.rows();
+    stacked_matrix_.topLeftCorner(new_rows, nDim) = block.leftCols(nDim);
+    obs_residual_.head(new_rows) = block.col(nDim);
+    stacked_matrix_.block(new_rows, 0, row - new_rows, nDim).setZero();
+    obs_residual_.segment(new_rows, row - new_rows).setZero();
+    return new_rows;
+}
+
 void SquareRootEKFSolver::_UpdateByGivensRotations(int row, int col) {
+    // fold a small pre-reduced block instead of every stacked row
+    row = _CompressStackedRowsByTreeQR(row);
     for (int j = 0; j < col - 1; ++j) {
         for (int i = row - 1; i >= 0; --i) {
             if (i == 0) {
@@ -1078,6 +1219,7 @@ void SquareRootEKFSolver::MarginalizeGivens() {
         info_factor_matrix_to_marginal_.block(OLD_DIM - CURRENT_DIM,
                                               OLD_DIM - CURRENT_DIM,
                                               CURRENT_DIM, CURRENT_DIM);
+    info_factor_inverse_dirty_ = true;
 }
 
 void SquareRootEKFSolver::MarginalizeStatic() {
@@ -1,6 +1,6 @@
 #include "Algorithm/vision/FeatureTrackerOpticalFlow_Chen.h"
 
-#include <utils/TickTock.h>
+#include <utils/Profiler.h>
 
 #include "Algorithm/DataAssociation/DataAssociation.h"
 #include "Algorithm/vision/camModel/camModel.h"
@@ -12,7 +12,7 @@ FeatureTrackerOpticalFlow_Chen::FeatureTrackerOpticalFlow_Chen(int nMax2Track,
                                                                int nMaskSize)
     : max_num_to_track_(nMax2Track), mask_size_(nMaskSize) {
     assert(nMaskSize % 2);
-    use_back_tracking_ = Config::UseBackTracking;
+    use_back_tracking_ = Config::Instance().UseBackTracking;
 }
 
 inline void FeatureTrackerOpticalFlow_Chen::_SetMask(int x, int y, int cam_id) {
@@ -184,6 +184,7 @@ void FeatureTrackerOpticalFlow_Chen::_ExtractMorePoints(
                 vTrackedFeatures.push_back(tf);
                 ++num_features_;
                 ++num_features_tracked_;
+                ++num_new_features_;
             }
         }
     }
@@ -249,6 +250,7 @@ void FeatureTrackerOpticalFlow_Chen::_ExtractMorePoints(
                     vTrackedFeatures.push_back(tf);
                     ++num_features_;
                     ++num_features_tracked_;
+                    ++num_new_features_;
                 }
             }
         }
@@ -443,6 +445,7 @@ void FeatureTrackerOpticalFlow_Chen::_PreProcess(const ImageData::Ptr image,
 
     // Set cnt for tracked points to zero
     num_features_tracked_ = 0;
+    num_new_features_ = 0;
     last_frame_moved_pixels_sqr_.clear();
 
     // Init mask buffer
@@ -483,15 +486,15 @@ void FeatureTrackerOpticalFlow_Chen::MatchNewFrame(
     // ReSet Mask Pattern
     // _ResetMask();
 
-    TickTock::Start("KLT");
-    _TrackPoints(vTrackedFeatures);
-    TickTock::Stop("KLT");
+    {
+        PROFILE_SCOPE("KLT");
+        _TrackPoints(vTrackedFeatures);
+    }
 
     // Extract more points if there are more points can be tracked.
     if (num_features_tracked_ < max_num_to_track_) {
-        TickTock::Start("Fast");
+        PROFILE_SCOPE("Fast");
         _ExtractMorePoints(vTrackedFeatures);
-        TickTock::Stop("Fast");
     }
     // _ShowMask();
     _PostProcess(vTrackedFeatures);
@@ -522,9 +525,9 @@ void FeatureTrackerOpticalFlow_Chen::_ExtractFast(
     fast::fast_corner_detect_10_mask(
         image_data, mask_data, image_->image.cols - mask_size_ + 1,
         image_->image.rows - mask_size_ + 1, image_->image.step1(),
-        Config::FastScoreThreshold, vXys);
+        Config::Instance().FastScoreThreshold, vXys);
     fast::fast_corner_score_10(image_data, image_->image.step1(), vXys,
-                               Config::FastScoreThreshold, vScores);
+                               Config::Instance().FastScoreThreshold, vScores);
     fast::fast_nonmax_3x3(vXys, vScores, vNms);
 
     vTemp.reserve(vXys.size());
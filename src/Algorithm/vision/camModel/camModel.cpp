@@ -36,7 +36,7 @@ CamModel::Ptr CamModel::CreateFromConfig(const cv::FileStorage& config) {
 
     bool is_stereo;
     config["IsStereo"] >> is_stereo;
-    if (!Config::UseStereo) {
+    if (!Config::Instance().UseStereo) {
         is_stereo = false;
     }
 
@@ -178,7 +178,7 @@ float EquiDistantModel::testModelPrecision(bool is_right) {
     }
     std::string mask_name = is_right ? "/reprojection_err_mask_right.png"
                                      : "/reprojection_err_mask.png";
-    cv::imwrite(Config::ResultOutputPath + mask_name, mask);
+    cv::imwrite(Config::Instance().ResultOutputPath + mask_name, mask);
 
     return mean_err;
 }
@@ -29,11 +29,11 @@ ImuBuffer::ImuBuffer() : CircularBuffer<ImuData, 10>() {
     acc_bias_.setZero();
 
     IMUParams imuParams = SensorConfig::Instance().GetIMUParams(0);
-    static const float gyro_noise = imuParams.gyro_noise;
-    static const float acc_noise = imuParams.acc_noise;
-    static const int imu_fps = imuParams.fps;
-    static const float gyro_noise2 = gyro_noise * (gyro_noise * imu_fps);
-    static const float acc_noise2 = acc_noise * (acc_noise * imu_fps);
+    const float gyro_noise = imuParams.gyro_noise;
+    const float acc_noise = imuParams.acc_noise;
+    const int imu_fps = imuParams.fps;
+    const float gyro_noise2 = gyro_noise * (gyro_noise * imu_fps);
+    const float acc_noise2 = acc_noise * (acc_noise * imu_fps);
 
     noise_cov_.setIdentity(6, 6);
     noise_cov_.topLeftCorner(3, 3) *= gyro_noise2;
@@ -108,17 +108,20 @@ bool ImuBuffer::ImuPreIntegration(ImuPreintergration& ImuTerm) const {
     int Index1 = binarySearch<long long>(ImuTerm.t1, Left);
 
     int try_times = 0;
+    PROFILE_SCOPE_NAMED(imu_wait_scope, "ImuWait");
+    if (Index1 >= 0) imu_wait_scope.Cancel();
     while (Index1 < 0) {
-        LOGI("t1:%lld,imu1:%lld", (long long)ImuTerm.t1,
-             (long long)buf_[getDeltaIndex(head_, -1)].timestamp);
+        LOGI_EVERY_MS(1000, "t1:%lld,imu1:%lld", (long long)ImuTerm.t1,
+                      (long long)buf_[getDeltaIndex(head_, -1)].timestamp);
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
         Index1 = binarySearch<long long>(ImuTerm.t1, Left);
         try_times++;
-        if (try_times > 20 || Config::SerialRun) {
+        if (try_times > 20 || Config::Instance().SerialRun) {
             throw std::runtime_error(
                 "IMU is slower than Image, waiting for IMU data...");
         }
     }
+    imu_wait_scope.Stop();
     // if(Index1 < 0){
     //     Index1 = getDeltaIndex(head_, -1);
     // }
@@ -235,8 +238,8 @@ bool ImuBuffer::ImuPreIntegration(ImuPreintergration& ImuTerm) const {
     static const int64_t max_dt =
         1e9 / SensorConfig::Instance().GetCameraParams(0).fps * 1.5;
     if (ImuTerm.dT > max_dt) {
-        LOGW("Detected a Frame Drop, dT:%lld max_dt:%lld",
-             (long long)ImuTerm.dT, (long long)max_dt);
+        LOGW_EVERY_MS(1000, "Detected a Frame Drop, dT:%lld max_dt:%lld",
+                      (long long)ImuTerm.dT, (long long)max_dt);
     }
 
     return true;
@@ -246,14 +249,18 @@ void ImuBuffer::OnImuReceived(const ImuData& imuData) {
     buf_[head_] = imuData;
 
     // do low pass filter to get gravity
-    static Eigen::Vector3f gravity = imuData.acc;
-    gravity = 0.95f * gravity + 0.05f * imuData.acc;
+    if (!gravity_filter_init_) {
+        gravity_filter_ = imuData.acc;
+        gravity_filter_init_ = true;
+    }
+    gravity_filter_ = 0.95f * gravity_filter_ + 0.05f * imuData.acc;
     {
         std::lock_guard<std::mutex> lck(gravity_mutex_);
-        gravity_ = gravity;
+        gravity_ = gravity_filter_;
     }
 
     PushIndex();
+    latest_timestamp_.store(imuData.timestamp, std::memory_order_relaxed);
 }
 
 Vector3f ImuBuffer::GetGravity(long long timestamp) {
@@ -32,18 +32,21 @@ bool OdometerBuffer::OdomPreIntegration(int64_t start_t, int64_t end_t,
         return false;
     }
     int index1 = binarySearch<long long>(end_t, Left);
+    PROFILE_SCOPE_NAMED(odometer_wait_scope, "OdometerWait");
+    if (index1 >= 0) odometer_wait_scope.Cancel();
     for (int i = 0; i < 5 && index1 < 0; ++i) {
         std::this_thread::sleep_for(std::chrono::milliseconds(10));
         index1 = binarySearch<long long>(end_t, Left);
-        LOGI("waiting for odom, %d", i);
+        LOGI_EVERY_MS(1000, "waiting for odom, %d", i);
     }
+    odometer_wait_scope.Stop();
     if (index1 < 0) {
         LOGE("end time querying odometer buffer failed, end time:%lld",
              (long long)end_t);
         return false;
     }
     if (index0 == index1) {
-        LOGW("no enough odometer data for preintegration.");
+        LOGW_EVERY_MS(1000, "no enough odometer data for preintegration.");
         return false;
     }
 
@@ -14,7 +14,7 @@
 namespace DeltaVins {
 
 DataRecorder::DataRecorder() {
-    dat_dir_ = Config::DataSourcePath;
+    dat_dir_ = Config::Instance().DataSourcePath;
     if (dat_dir_.empty()) dat_dir_ = "./data";
     LOGI("Data Recorder Path:%s", dat_dir_.c_str());
     existOrMkdir(dat_dir_);
@@ -24,6 +24,8 @@ DataRecorder::DataRecorder() {
     imu_file_ = fopen((dat_dir_ + "/imu0/data.csv").c_str(), "w");
     cam_file_ = fopen((dat_dir_ + "/cam0/data.csv").c_str(), "w");
     flag_have_image_ = false;
+    imu_per_image_ = SensorConfig::Instance().GetIMUParams(0).fps /
+                     SensorConfig::Instance().GetCameraParams(0).fps;
 }
 
 DataRecorder::~DataRecorder() {
@@ -35,43 +37,38 @@ DataRecorder::~DataRecorder() {
 
 void DataRecorder::OnImageReceived(ImageData::Ptr imageData) {
     //        std::lock_guard<std::mutex> lck(image_mutex_);
-    if (Config::RunVIO) {
+    if (Config::Instance().RunVIO) {
         this->image_data_ = imageData;
         flag_have_image_ = true;
     } else {
-        static ImageBuffer &buffer = ImageBuffer::Instance();
-        buffer.PushImage(imageData);
+        ImageBuffer::Instance().PushImage(imageData);
     }
     WakeUpMovers();
 }
 
 void DataRecorder::DoWhatYouNeedToDo() {
-    static ImuBuffer &imuBuffer = ImuBuffer::Instance();
+    ImuBuffer &imuBuffer = ImuBuffer::Instance();
     // static ImageBuffer &imageBuffer = ImageBuffer::Instance();
 
     char fileName[100];
-    static int imu_fps = SensorConfig::Instance().GetIMUParams(0).fps;
-    static int image_fps = SensorConfig::Instance().GetCameraParams(0).fps;
-    static int nImuPerImage = imu_fps / image_fps;
-    static int imuTail = -1;
-    if (Config::RecordIMU) {
-        if (imuTail == -1) imuTail = imuBuffer.tail_;
-        for (int i = 0; i < nImuPerImage + 10; ++i) {
-            if (imuTail == imuBuffer.head_) {
+    if (Config::Instance().RecordIMU) {
+        if (imu_tail_ == -1) imu_tail_ = imuBuffer.tail_;
+        for (int i = 0; i < imu_per_image_ + 10; ++i) {
+            if (imu_tail_ == imuBuffer.head_) {
                 break;
             }
-            ImuData &data = imuBuffer.buf_[imuTail];
+            ImuData &data = imuBuffer.buf_[imu_tail_];
             fprintf(imu_file_, "%ld,%f,%f,%f,%f,%f,%f\n", data.timestamp,
                     data.gyro(0), data.gyro(1), data.gyro(2), data.acc(0),
                     data.acc(1), data.acc(2));
-            imuTail = imuBuffer.getDeltaIndex(imuTail, 1);
+            imu_tail_ = imuBuffer.getDeltaIndex(imu_tail_, 1);
         }
         fflush(imu_file_);
     }
 
-    static ImageBuffer &buffer = ImageBuffer::Instance();
-    if (!Config::RunVIO) image_data_ = buffer.PopTailImage();
-    if (Config::RecordImage) {
+    ImageBuffer &buffer = ImageBuffer::Instance();
+    if (!Config::Instance().RunVIO) image_data_ = buffer.PopTailImage();
+    if (Config::Instance().RecordImage) {
         {
             std::lock_guard<std::mutex> lck(image_mutex_);
             sprintf(fileName, "cam0/%ld.png", image_data_->timestamp);
@@ -79,7 +76,7 @@ void DataRecorder::DoWhatYouNeedToDo() {
             cv::imwrite(dat_dir_ + "/" + fileName, image_data_->image);
         }
     }
-    if (!Config::NoGUI && frame_adapter_) {
+    if (!Config::Instance().NoGUI && frame_adapter_) {
         if (image_data_->image.channels() == 1)
             cv::cvtColor(image_data_->image, image_data_->image,
                          cv::COLOR_GRAY2BGR);
@@ -93,8 +90,8 @@ void DataRecorder::DoWhatYouNeedToDo() {
 }
 
 bool DataRecorder::HaveThingsTodo() {
-    static ImageBuffer &buffer = ImageBuffer::Instance();
-    if (Config::RunVIO)
+    ImageBuffer &buffer = ImageBuffer::Instance();
+    if (Config::Instance().RunVIO)
         return flag_have_image_;
     else
         return !buffer.empty();
@@ -0,0 +1,186 @@
+#include "IO/dataOuput/MetricsExporter.h"
+
+#include <cerrno>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+namespace {
+constexpr const char* PREFIX = "deltavins_";
+constexpr double QUANTILES[] = {0.5, 0.9, 0.99};
+
+void _Append(std::string& out, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+void _Append(std::string& out, const char* format, ...) {
+    char line[512];
+    va_list args;
+    va_start(args, format);
+    const int n = vsnprintf(line, sizeof(line), format, args);
+    va_end(args);
+    if (n > 0) out.append(line, std::min<size_t>(n, sizeof(line) - 1));
+}
+
+void _AppendHeader(std::string& out, const char* name, const char* type,
+                   const char* help) {
+    _Append(out, "# HELP %s%s %s\n# TYPE %s%s %s\n", PREFIX, name, help,
+            PREFIX, name, type);
+}
+}  // namespace
+
+std::string MetricsExporter::FormatText(const MetricsSnapshot& snapshot) {
+    std::string out;
+    _AppendHeader(out, "snapshot_timestamp_seconds", "gauge",
+                  "Unix time of this snapshot");
+    _Append(out, "%ssnapshot_timestamp_seconds %.3f\n", PREFIX,
+            snapshot.timestamp);
+
+    for (auto& m : snapshot.metrics) {
+        const bool counter = m.type == Metrics::Type::Counter;
+        _AppendHeader(out, m.name.c_str(), counter ? "counter" : "gauge",
+                      m.help.c_str());
+        _Append(out, "%s%s %.9g\n", PREFIX, m.name.c_str(), m.value);
+    }
+
+    if (snapshot.stages.empty()) return out;
+    _AppendHeader(out, "stage_latency_ms", "summary",
+                  "Latency of the profiled stages since start");
+    for (auto& s : snapshot.stages) {
+        const double values[] = {s.p50_ms, s.p90_ms, s.p99_ms};
+        for (int i = 0; i < 3; ++i) {
+            _Append(out,
+                    "%sstage_latency_ms{stage=\"%s\",quantile=\"%g\"} %.6f\n",
+                    PREFIX, s.name.c_str(), QUANTILES[i], values[i]);
+        }
+        _Append(out, "%sstage_latency_ms_sum{stage=\"%s\"} %.6f\n", PREFIX,
+                s.name.c_str(), s.mean_ms * s.count);
+        _Append(out, "%sstage_latency_ms_count{stage=\"%s\"} %llu\n", PREFIX,
+                s.name.c_str(), static_cast<unsigned long long>(s.count));
+    }
+    _AppendHeader(out, "stage_latency_max_ms", "gauge",
+                  "Longest call of the profiled stages since start");
+    for (auto& s : snapshot.stages) {
+        _Append(out, "%sstage_latency_max_ms{stage=\"%s\"} %.6f\n", PREFIX,
+                s.name.c_str(), s.max_ms);
+    }
+    return out;
+}
+
+MetricsFileExporter::MetricsFileExporter(const std::string& path)
+    : path_(path) {}
+
+void MetricsFileExporter::Export(const MetricsSnapshot& snapshot) {
+    const std::string text = FormatText(snapshot);
+    const std::string temporary = path_ + ".tmp";
+    FILE* fout = fopen(temporary.c_str(), "w");
+    if (!fout) {
+        LOGE("Cannot open file %s", temporary.c_str());
+        return;
+    }
+    const bool written = fwrite(text.data(), 1, text.size(), fout) ==
+                         text.size();
+    if (fclose(fout) != 0 || !written) {
+        LOGE("Cannot write file %s", temporary.c_str());
+        return;
+    }
+    if (std::rename(temporary.c_str(), path_.c_str()) != 0)
+        LOGE("Cannot replace %s: %s", path_.c_str(), strerror(errno));
+}
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+MetricsSocketExporter::MetricsSocketExporter(const std::string& path)
+    : path_(path) {
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (path_.size() >= sizeof(addr.sun_path)) {
+        LOGE("Metrics socket path %s is too long", path_.c_str());
+        return;
+    }
+    memcpy(addr.sun_path, path_.c_str(), path_.size());
+
+    fd_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd_ < 0) {
+        LOGE("Cannot create metrics socket: %s", strerror(errno));
+        return;
+    }
+    // a socket left behind by a killed run would fail the bind
+    unlink(path_.c_str());
+    if (bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 ||
+        listen(fd_, 4) < 0) {
+        LOGE("Cannot serve metrics on %s: %s", path_.c_str(),
+             strerror(errno));
+        close(fd_);
+        fd_ = -1;
+        return;
+    }
+    running_ = true;
+    thread_ = std::thread(&MetricsSocketExporter::_Serve, this);
+}
+
+MetricsSocketExporter::~MetricsSocketExporter() {
+    running_ = false;
+    if (thread_.joinable()) thread_.join();
+    if (fd_ >= 0) {
+        close(fd_);
+        unlink(path_.c_str());
+    }
+}
+
+void MetricsSocketExporter::Export(const MetricsSnapshot& snapshot) {
+    std::string text = FormatText(snapshot);
+    std::lock_guard<std::mutex> lck(mtx_text_);
+    text_.swap(text);
+}
+
+void MetricsSocketExporter::_Serve() {
+#ifdef MSG_NOSIGNAL
+    const int flags = MSG_NOSIGNAL;
+#else
+    const int flags = 0;
+#endif
+    while (running_) {
+        // wakes up now and then to see whether to stop
+        pollfd pfd = {fd_, POLLIN, 0};
+        if (poll(&pfd, 1, 200) <= 0) continue;
+        const int client = accept(fd_, nullptr, nullptr);
+        if (client < 0) continue;
+
+        std::string text;
+        {
+            std::lock_guard<std::mutex> lck(mtx_text_);
+            text = text_;
+        }
+        // a client which does not read loses its scrape, not the thread
+        timeval timeout = {1, 0};
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+                   sizeof(timeout));
+#ifdef SO_NOSIGPIPE
+        const int one = 1;
+        setsockopt(client, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#endif
+        size_t sent = 0;
+        while (sent < text.size()) {
+            const ssize_t n =
+                send(client, text.data() + sent, text.size() - sent, flags);
+            if (n <= 0) break;
+            sent += n;
+        }
+        close(client);
+    }
+}
+#endif
+
+}  // namespace DeltaVins
@@ -0,0 +1,63 @@
+#include "IO/dataOuput/MetricsReporter.h"
+
+#include <algorithm>
+
+#include "precompile.h"
+#include "utils/AllocTracker.h"
+
+namespace DeltaVins {
+
+MetricsReporter::MetricsReporter(int interval_ms)
+    : interval_(std::max(interval_ms, 1)) {}
+
+void MetricsReporter::AddExporter(MetricsExporter::Ptr exporter) {
+    exporters_.push_back(std::move(exporter));
+}
+
+MetricsSnapshot MetricsReporter::TakeSnapshot() {
+    MetricsSnapshot snapshot;
+    const auto since_epoch = std::chrono::system_clock::now().time_since_epoch();
+    snapshot.timestamp = std::chrono::duration<double>(since_epoch).count();
+    snapshot.stages = Profiler::Instance().Collect();
+    snapshot.metrics = Metrics::Instance().Collect();
+
+    // counted by VIOModule
+    double frames = 0;
+    for (auto& m : snapshot.metrics) {
+        if (m.name == "frames_total") frames = m.value;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const double elapsed =
+        std::chrono::duration<double>(now - last_time_).count();
+    snapshot.metrics.push_back(
+        {"fps", "Frames processed per second since the previous snapshot",
+         Metrics::Type::Gauge,
+         elapsed > 0 ? (frames - last_frames_) / elapsed : 0.0});
+    snapshot.metrics.push_back({"peak_rss_bytes",
+                                "Peak resident set size of the process",
+                                Metrics::Type::Gauge,
+                                AllocTracker::PeakRssKb() * 1024.0});
+    last_frames_ = frames;
+    last_time_ = now;
+    return snapshot;
+}
+
+void MetricsReporter::RunThread() {
+    last_time_ = std::chrono::steady_clock::now();
+    // once more after Stop(), with the final values
+    do {
+        {
+            std::unique_lock<std::mutex> ul(wake_up_mutex_);
+            wake_up_condition_variable_.wait_for(
+                ul, interval_, [this]() { return !keep_running_; });
+        }
+        RunOnce();
+    } while (keep_running_);
+}
+
+void MetricsReporter::DoWhatYouNeedToDo() {
+    const MetricsSnapshot snapshot = TakeSnapshot();
+    for (auto& exporter : exporters_) exporter->Export(snapshot);
+}
+
+}  // namespace DeltaVins
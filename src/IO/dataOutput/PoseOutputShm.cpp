@@ -0,0 +1,101 @@
+#include "IO/dataOuput/PoseOutputShm.h"
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+PoseOutputShm::PoseOutputShm(const std::string& name,
+                             const shm::Layout& layout) {
+    if (writer_.Create(name, layout)) {
+        LOGI("Publish to shared memory %s", name.c_str());
+    } else {
+        LOGE("Cannot create shared memory %s: %s", name.c_str(),
+             strerror(errno));
+    }
+}
+
+void PoseOutputShm::PushViewMatrix(std::vector<FrameGL>& v_Rcw) {
+    if (!writer_.IsOpen()) return;
+    const uint32_t max_frames =
+        writer_.Capacity(shm::POSES) / sizeof(shm::ShmFrame);
+    if (v_Rcw.size() > max_frames && !warned_) {
+        LOGW("%zu frames do not fit the shared memory, %u are published",
+             v_Rcw.size(), max_frames);
+        warned_ = true;
+    }
+    const uint32_t count = std::min<size_t>(v_Rcw.size(), max_frames);
+
+    shm::MessageInfo info;
+    info.frame = frame_;
+    info.count = count;
+    info.size = count * sizeof(shm::ShmFrame);
+    auto* frames =
+        reinterpret_cast<shm::ShmFrame*>(writer_.Begin(shm::POSES, info.size));
+    for (uint32_t i = 0; i < count; ++i) {
+        frames[i].id = v_Rcw[i].m_id;
+        frames[i].type = v_Rcw[i].type;
+        memcpy(frames[i].Twc, v_Rcw[i].Twc.data(), sizeof(frames[i].Twc));
+    }
+    writer_.Publish(shm::POSES, info);
+}
+
+void PoseOutputShm::PushWorldPoint(const std::vector<WorldPointGL>& v_Point3f) {
+    if (!writer_.IsOpen()) return;
+    const uint32_t max_points =
+        writer_.Capacity(shm::POINTS) / sizeof(shm::ShmPoint);
+    if (v_Point3f.size() > max_points && !warned_) {
+        LOGW("%zu points do not fit the shared memory, %u are published",
+             v_Point3f.size(), max_points);
+        warned_ = true;
+    }
+    const uint32_t count = std::min<size_t>(v_Point3f.size(), max_points);
+
+    shm::MessageInfo info;
+    info.frame = frame_;
+    info.count = count;
+    info.size = count * sizeof(shm::ShmPoint);
+    auto* points = reinterpret_cast<shm::ShmPoint*>(
+        writer_.Begin(shm::POINTS, info.size));
+    for (uint32_t i = 0; i < count; ++i) {
+        points[i].id = v_Point3f[i].m_id;
+        memcpy(points[i].P, v_Point3f[i].P.data(), sizeof(points[i].P));
+    }
+    writer_.Publish(shm::POINTS, info);
+}
+
+void PoseOutputShm::PushImageTexture(unsigned char* imageTexture,
+                                     const int width, const int height,
+                                     const int channels,
+                                     const std::string& name) {
+    if (!writer_.IsOpen() || image_index_ > 1) return;
+    const auto channel =
+        static_cast<shm::Channel>(shm::IMAGE0 + image_index_++);
+
+    shm::MessageInfo info;
+    info.frame = frame_;
+    info.size = width * height * channels;
+    info.width = width;
+    info.height = height;
+    info.channels = channels;
+    strncpy(info.name, name.c_str(), sizeof(info.name) - 1);
+    if (!writer_.Write(channel, imageTexture, info) && !warned_) {
+        LOGW("Image %s of %dx%dx%d does not fit the shared memory",
+             name.c_str(), width, height, channels);
+        warned_ = true;
+    }
+}
+
+void PoseOutputShm::FinishFrame() {
+    ++frame_;
+    image_index_ = 0;
+}
+
+}  // namespace DeltaVins
+
+#endif
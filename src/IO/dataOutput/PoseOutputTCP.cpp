@@ -46,7 +46,7 @@ void PoseOutputTcp::PushImageTexture(unsigned char *imageTexture,
                                      const int channels,
                                      const std::string &name) {
     (void)name;
-    if (!Config::UploadImage) return;
+    if (!Config::Instance().UploadImage) return;
 
     static int counter = 0;
     counter++;
@@ -94,7 +94,7 @@ void PoseOutputTcp::PushWorldPoint(const std::vector<WorldPointGL> &v_Point3f) {
 }
 
 PoseOutputTcp::PoseOutputTcp() {
-    std::string ip = Config::VisualizerServerIP;
+    std::string ip = Config::Instance().VisualizerServerIP;
     tcp_client_world_point_.InitTcpClient(ip.c_str(), 8848);
     tcp_client_view_matrix_.InitTcpClient(ip.c_str(), 8849);
     tcp_client_image_texture_.InitTcpClient(ip.c_str(), 8850);
@@ -0,0 +1,228 @@
+#include "IO/dataOuput/ShmTransport.h"
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+
+namespace DeltaVins {
+namespace shm {
+
+namespace {
+uint64_t _Align(uint64_t n) { return (n + 63) & ~uint64_t(63); }
+
+// shm_open wants a single leading slash
+std::string _SegmentName(const std::string& name) {
+    return !name.empty() && name[0] == '/' ? name : "/" + name;
+}
+}  // namespace
+
+ShmWriter::~ShmWriter() {
+    if (!header_) return;
+    header_->closed.store(1, std::memory_order_release);
+    munmap(base_, header_->size);
+    close(fd_);
+    shm_unlink(name_.c_str());
+}
+
+bool ShmWriter::Create(const std::string& name, const Layout& layout) {
+    if (header_ || layout.slots == 0) return false;
+    name_ = _SegmentName(name);
+
+    const uint64_t capacities[NUM_CHANNELS] = {
+        layout.max_frames * uint64_t(sizeof(ShmFrame)),
+        layout.max_points * uint64_t(sizeof(ShmPoint)),
+        layout.max_image_bytes, layout.max_image_bytes};
+    uint64_t size = _Align(sizeof(SegmentHeader));
+    uint64_t offsets[NUM_CHANNELS];
+    for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+        offsets[c] = size;
+        size += _Align(sizeof(SlotHeader) + capacities[c]) * layout.slots;
+    }
+
+    shm_unlink(name_.c_str());
+    fd_ = shm_open(name_.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd_ < 0) return false;
+    void* base = MAP_FAILED;
+    if (ftruncate(fd_, size) == 0)
+        base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd_, 0);
+    if (base == MAP_FAILED) {
+        const int error = errno;
+        close(fd_);
+        fd_ = -1;
+        shm_unlink(name_.c_str());
+        errno = error;
+        return false;
+    }
+    base_ = static_cast<uint8_t*>(base);
+
+    // the pages are zero, which is what every counter starts from
+    auto* header = new (base_) SegmentHeader;
+    header->version = VERSION;
+    header->size = size;
+    header->closed.store(0, std::memory_order_relaxed);
+    for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+        auto& channel = header->channels[c];
+        channel.published.store(0, std::memory_order_relaxed);
+        channel.offset = offsets[c];
+        channel.slot_size = _Align(sizeof(SlotHeader) + capacities[c]);
+        channel.num_slots = layout.slots;
+        channel.capacity = static_cast<uint32_t>(capacities[c]);
+        for (uint32_t i = 0; i < layout.slots; ++i) {
+            auto* slot = new (base_ + channel.offset + i * channel.slot_size)
+                SlotHeader;
+            slot->sequence.store(0, std::memory_order_relaxed);
+        }
+    }
+    // a reader opening the segment sees the magic only once it is complete
+    header->magic.store(MAGIC, std::memory_order_release);
+    header_ = header;
+    return true;
+}
+
+uint32_t ShmWriter::Capacity(Channel channel) const {
+    return header_ ? header_->channels[channel].capacity : 0;
+}
+
+SlotHeader* ShmWriter::_Slot(Channel channel, uint64_t index) const {
+    const auto& c = header_->channels[channel];
+    return reinterpret_cast<SlotHeader*>(
+        base_ + c.offset + (index % c.num_slots) * c.slot_size);
+}
+
+uint8_t* ShmWriter::Begin(Channel channel, uint32_t size) {
+    if (!header_ || channel >= NUM_CHANNELS) return nullptr;
+    const auto& c = header_->channels[channel];
+    if (size > c.capacity) return nullptr;
+
+    // only this thread writes the channel
+    SlotHeader* slot =
+        _Slot(channel, c.published.load(std::memory_order_relaxed));
+    const uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    slot->sequence.store(sequence | 1, std::memory_order_relaxed);
+    // readers seeing any of the payload see the odd sequence too
+    std::atomic_thread_fence(std::memory_order_release);
+    return reinterpret_cast<uint8_t*>(slot + 1);
+}
+
+void ShmWriter::Publish(Channel channel, const MessageInfo& info) {
+    if (!header_ || channel >= NUM_CHANNELS) return;
+    auto& c = header_->channels[channel];
+    const uint64_t published = c.published.load(std::memory_order_relaxed);
+    SlotHeader* slot = _Slot(channel, published);
+    const uint64_t sequence = slot->sequence.load(std::memory_order_relaxed);
+    if (!(sequence & 1)) return;  // no Begin()
+
+    slot->info = info;
+    slot->info.size = std::min(info.size, c.capacity);
+    slot->info.name[sizeof(info.name) - 1] = '\0';
+    slot->sequence.store(sequence + 1, std::memory_order_release);
+    c.published.store(published + 1, std::memory_order_release);
+}
+
+bool ShmWriter::Write(Channel channel, const void* data,
+                      const MessageInfo& info) {
+    uint8_t* payload = Begin(channel, info.size);
+    if (!payload) return false;
+    memcpy(payload, data, info.size);
+    Publish(channel, info);
+    return true;
+}
+
+ShmReader::~ShmReader() { Close(); }
+
+bool ShmReader::Open(const std::string& name) {
+    Close();
+    fd_ = shm_open(_SegmentName(name).c_str(), O_RDONLY, 0);
+    if (fd_ < 0) return false;
+
+    struct stat st;
+    if (fstat(fd_, &st) == 0 && st.st_size >= (off_t)sizeof(SegmentHeader)) {
+        size_ = st.st_size;
+        void* base = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd_, 0);
+        if (base != MAP_FAILED) base_ = static_cast<const uint8_t*>(base);
+    }
+    if (!base_) {
+        Close();
+        return false;
+    }
+
+    const auto* header = reinterpret_cast<const SegmentHeader*>(base_);
+    bool valid = header->magic.load(std::memory_order_acquire) == MAGIC &&
+                 header->version == VERSION && header->size <= size_;
+    for (uint32_t c = 0; valid && c < NUM_CHANNELS; ++c) {
+        const auto& channel = header->channels[c];
+        valid = channel.num_slots > 0 &&
+                channel.slot_size >= sizeof(SlotHeader) + channel.capacity &&
+                channel.offset + channel.slot_size * channel.num_slots <=
+                    header->size;
+    }
+    if (!valid) {
+        Close();
+        return false;
+    }
+    header_ = header;
+    std::fill(std::begin(last_read_), std::end(last_read_), 0);
+    return true;
+}
+
+void ShmReader::Close() {
+    if (base_) munmap(const_cast<uint8_t*>(base_), size_);
+    if (fd_ >= 0) close(fd_);
+    base_ = nullptr;
+    header_ = nullptr;
+    size_ = 0;
+    fd_ = -1;
+}
+
+bool ShmReader::WriterClosed() const {
+    return header_ && header_->closed.load(std::memory_order_acquire);
+}
+
+uint64_t ShmReader::Published(Channel channel) const {
+    if (!header_ || channel >= NUM_CHANNELS) return 0;
+    return header_->channels[channel].published.load(
+        std::memory_order_acquire);
+}
+
+bool ShmReader::ReadLatest(Channel channel, Message& message) {
+    if (!header_ || channel >= NUM_CHANNELS) return false;
+    const auto& c = header_->channels[channel];
+
+    // a writer faster than the copy overwrites the slot, take the next
+    for (int attempt = 0; attempt < 4; ++attempt) {
+        const uint64_t published = c.published.load(std::memory_order_acquire);
+        if (published == last_read_[channel]) return false;
+        const uint64_t index = (published - 1) % c.num_slots;
+        const auto* slot = reinterpret_cast<const SlotHeader*>(
+            base_ + c.offset + index * c.slot_size);
+
+        const uint64_t before = slot->sequence.load(std::memory_order_acquire);
+        if ((before & 1) || before == 0) continue;
+        message.info = slot->info;
+        const uint32_t size = std::min(message.info.size, c.capacity);
+        message.payload.resize(size);
+        memcpy(message.payload.data(), slot + 1, size);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot->sequence.load(std::memory_order_relaxed) != before) continue;
+
+        message.info.size = size;
+        message.info.name[sizeof(message.info.name) - 1] = '\0';
+        // the slot may hold a message newer than published said
+        last_read_[channel] = (before / 2 - 1) * c.num_slots + index + 1;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace shm
+}  // namespace DeltaVins
+
+#endif
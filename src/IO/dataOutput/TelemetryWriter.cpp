@@ -0,0 +1,61 @@
+#include "IO/dataOuput/TelemetryWriter.h"
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+namespace {
+const char* CSV_HEADER =
+    "timestamp,add_frame_ms,propagate_ms,track_ms,margin_ms,"
+    "data_association_ms,stack_ms,solve_ms,tracked_features,new_features,"
+    "msckf_points,slam_points,stacked_rows,state_dim,marginalized_frames,"
+    "dropped_frames,queue_depth,"
+    "track_cycles,track_instructions,track_cache_misses,track_branch_misses,"
+    "margin_cycles,margin_instructions,margin_cache_misses,"
+    "margin_branch_misses,data_association_cycles,"
+    "data_association_instructions,data_association_cache_misses,"
+    "data_association_branch_misses,solve_cycles,solve_instructions,"
+    "solve_cache_misses,solve_branch_misses,allocations,live_bytes,"
+    "peak_rss_kb\n";
+
+void _AppendCounters(const PerfCounters::Values& c, std::string& out) {
+    char line[96];
+    int n = snprintf(line, sizeof(line), ",%llu,%llu,%llu,%llu",
+                     static_cast<unsigned long long>(c.cycles),
+                     static_cast<unsigned long long>(c.instructions),
+                     static_cast<unsigned long long>(c.cache_misses),
+                     static_cast<unsigned long long>(c.branch_misses));
+    if (n > 0) out.append(line, std::min<size_t>(n, sizeof(line) - 1));
+}
+
+void _AppendRaw(const FrameTelemetry& record, std::string& out) {
+    out.append(reinterpret_cast<const char*>(&record), sizeof(record));
+}
+}  // namespace
+
+TelemetryWriter::TelemetryWriter(const std::string& path, bool binary)
+    : RecordWriter(path, binary, binary ? &_AppendRaw : &_FormatCsv,
+                   binary ? "" : CSV_HEADER) {}
+
+void TelemetryWriter::_FormatCsv(const FrameTelemetry& r, std::string& out) {
+    char line[512];
+    int n = snprintf(line, sizeof(line),
+                     "%lld,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%d,%d,%d,%d,%d,"
+                     "%d,%d,%d,%d",
+                     r.timestamp, r.add_frame_ms, r.propagate_ms, r.track_ms,
+                     r.margin_ms, r.data_association_ms, r.stack_ms,
+                     r.solve_ms, r.tracked_features, r.new_features,
+                     r.msckf_points, r.slam_points, r.stacked_rows,
+                     r.state_dim, r.marginalized_frames, r.dropped_frames,
+                     r.queue_depth);
+    if (n > 0) out.append(line, std::min<size_t>(n, sizeof(line) - 1));
+    _AppendCounters(r.track_counters, out);
+    _AppendCounters(r.margin_counters, out);
+    _AppendCounters(r.data_association_counters, out);
+    _AppendCounters(r.solve_counters, out);
+    n = snprintf(line, sizeof(line), ",%lld,%lld,%lld\n", r.allocations,
+                 r.live_bytes, r.peak_rss_kb);
+    if (n > 0) out.append(line, std::min<size_t>(n, sizeof(line) - 1));
+}
+
+}  // namespace DeltaVins
@@ -0,0 +1,51 @@
+#include "IO/dataOuput/TrajectoryWriter.h"
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+TrajectoryWriter::TrajectoryWriter(const std::string& path,
+                                   ResultOutputFormat format)
+    : RecordWriter(path, format == ResultOutputFormat::BINARY,
+                   [format](const Record& record, std::string& out) {
+                       _Format(format, record, out);
+                   }) {}
+
+void TrajectoryWriter::_Format(ResultOutputFormat format, const Record& r,
+                               std::string& out) {
+    char line[512];
+    int n = 0;
+    const float* p = r.position;
+    const float* q = r.rotation;
+    switch (format) {
+        case ResultOutputFormat::EUROC:
+            n = snprintf(line, sizeof(line),
+                         "%lld,%f,%f,%f,%f,%f,%f,%f,%f,%f,%f,%9.6f,%9.6f,"
+                         "%9.6f,%9.6f,%9.6f,%9.6f\n",
+                         r.timestamp, p[0], p[1], p[2], q[0], q[1], q[2], q[3],
+                         r.velocity[0], r.velocity[1], r.velocity[2],
+                         r.gyro_bias[0], r.gyro_bias[1], r.gyro_bias[2],
+                         r.acc_bias[0], r.acc_bias[1], r.acc_bias[2]);
+            break;
+        case ResultOutputFormat::TUM:
+            n = snprintf(line, sizeof(line), "%lf %f %f %f %f %f %f %f\n",
+                         r.timestamp / 1e9, p[0], p[1], p[2], q[1], q[2], q[3],
+                         q[0]);
+            break;
+        case ResultOutputFormat::KITTI: {
+            // row-major 3x4 [R|t], the line number is the frame index
+            Matrix3f R = Quaternionf(q[0], q[1], q[2], q[3]).toRotationMatrix();
+            n = snprintf(line, sizeof(line),
+                         "%e %e %e %e %e %e %e %e %e %e %e %e\n", R(0, 0),
+                         R(0, 1), R(0, 2), p[0], R(1, 0), R(1, 1), R(1, 2),
+                         p[1], R(2, 0), R(2, 1), R(2, 2), p[2]);
+            break;
+        }
+        case ResultOutputFormat::BINARY:
+            out.append(reinterpret_cast<const char*>(&r), sizeof(r));
+            return;
+    }
+    if (n > 0) out.append(line, std::min<size_t>(n, sizeof(line) - 1));
+}
+
+}  // namespace DeltaVins
@@ -0,0 +1,128 @@
+#include "IO/dataOuput/VisualizerPublisher.h"
+
+#include <algorithm>
+
+#include "precompile.h"
+#include "utils/Metrics.h"
+
+namespace DeltaVins {
+
+VisualizerPublisher::VisualizerPublisher(FrameAdapter* frame_adapter,
+                                         WorldPointAdapter* world_point_adapter,
+                                         int fps)
+    : frame_adapter_(frame_adapter),
+      world_point_adapter_(world_point_adapter),
+      period_ns_(fps > 0 ? 1000000000LL / fps : 0),
+      interval_(fps > 0 ? 1000 / fps : 0) {}
+
+VisualSnapshot::Ptr VisualizerPublisher::Acquire(long long timestamp) {
+    if (timestamp < next_timestamp_) return nullptr;
+    // keeps the rate, unless the frames are further apart than the period
+    next_timestamp_ = std::max(next_timestamp_ + period_ns_,
+                               timestamp + period_ns_ / 2);
+
+    VisualSnapshot::Ptr snapshot;
+    {
+        std::lock_guard<std::mutex> lck(mtx_snapshot_);
+        if (!spare_.empty()) {
+            snapshot = std::move(spare_.back());
+            spare_.pop_back();
+        }
+    }
+    if (!snapshot) snapshot.reset(new VisualSnapshot);
+    snapshot->timestamp = timestamp;
+    snapshot->has_map = false;
+    return snapshot;
+}
+
+void VisualizerPublisher::Publish(VisualSnapshot::Ptr snapshot) {
+    bool replaced;
+    {
+        std::lock_guard<std::mutex> lck(mtx_snapshot_);
+        replaced = latest_ != nullptr;
+        if (replaced) spare_.push_back(std::move(latest_));
+        latest_ = std::move(snapshot);
+    }
+    if (replaced) {
+        METRIC_ADD("visualizer_dropped_total",
+                   "Snapshots replaced before the visualizer drew them", 1);
+    } else {
+        // the thread was woken up for the replaced one already
+        WakeUpMovers();
+    }
+}
+
+bool VisualizerPublisher::HaveThingsTodo() {
+    std::lock_guard<std::mutex> lck(mtx_snapshot_);
+    return latest_ != nullptr;
+}
+
+void VisualizerPublisher::RunThread() {
+    while (keep_running_) {
+        {
+            std::unique_lock<std::mutex> ul(wake_up_mutex_);
+            wake_up_condition_variable_.wait(ul, [this]() {
+                return HaveThingsTodo() || !keep_running_;
+            });
+        }
+        if (!keep_running_) break;
+        const auto start = std::chrono::steady_clock::now();
+        RunOnce();
+        // at the rate of the visualizer, whatever the rate of the VIO
+        std::unique_lock<std::mutex> ul(wake_up_mutex_);
+        wake_up_condition_variable_.wait_until(
+            ul, start + interval_, [this]() { return !keep_running_; });
+    }
+}
+
+void VisualizerPublisher::DoWhatYouNeedToDo() {
+    VisualSnapshot::Ptr snapshot;
+    {
+        std::lock_guard<std::mutex> lck(mtx_snapshot_);
+        snapshot = std::move(latest_);
+    }
+    if (!snapshot) return;
+
+    if (snapshot->has_map) {
+        frame_adapter_->PushViewMatrix(snapshot->frames);
+        if (world_point_adapter_)
+            world_point_adapter_->PushWorldPoint(snapshot->points);
+    }
+    static const char* NAMES[] = {"track_image_left", "track_image_right"};
+    for (int i = 0; i < snapshot->num_cams; ++i) {
+        cv::Mat& image = track_images_[i];
+        DrawTrackImage(*snapshot, i, image);
+        frame_adapter_->PushImageTexture(image.data, image.cols, image.rows,
+                                         image.channels(), NAMES[i]);
+    }
+    frame_adapter_->FinishFrame();
+
+    // the images are shared with the frame, not kept longer than needed
+    for (auto& image : snapshot->images) image.release();
+    snapshot->image_data = nullptr;
+    std::lock_guard<std::mutex> lck(mtx_snapshot_);
+    spare_.push_back(std::move(snapshot));
+}
+
+void VisualizerPublisher::DrawTrackImage(const VisualSnapshot& snapshot,
+                                         int cam_id, cv::Mat& image) {
+    cv::cvtColor(snapshot.images[cam_id], image, cv::COLOR_GRAY2BGR);
+    for (auto& track : snapshot.tracks) {
+        if (track.cam_id != cam_id) continue;
+        for (int i = 1; i < track.num_px; ++i) {
+            const cv::Point front(track.px[i - 1].x(), track.px[i - 1].y());
+            const cv::Point curr(track.px[i].x(), track.px[i].y());
+            cv::line(image, front, curr, _GREEN_SCALAR, 1);
+            cv::circle(image, curr, 2, track.color);
+        }
+        cv::circle(image, cv::Point(track.last_px.x(), track.last_px.y()), 8,
+                   track.color);
+    }
+    cv::putText(image,
+                "Num Features Tracked: " +
+                    std::to_string(snapshot.num_tracked[cam_id]),
+                cv::Point(10, 30), cv::FONT_HERSHEY_SIMPLEX, 0.8, _GREEN_SCALAR,
+                2);
+}
+
+}  // namespace DeltaVins
@@ -0,0 +1,198 @@
+#include "IO/dataSource/binaryDataset.h"
+
+#include <cstring>
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+namespace {
+// count records of T at offset end within size, without overflowing
+template <typename T>
+bool _SectionInRange(uint64_t offset, uint64_t count, uint64_t size) {
+    return offset <= size && offset % alignof(T) == 0 &&
+           count <= (size - offset) / sizeof(T);
+}
+}  // namespace
+
+bool ValidateBinaryDataset(const uchar* data, size_t size,
+                           std::string& error) {
+    if (size < sizeof(BinaryDatasetHeader)) {
+        error = "truncated header";
+        return false;
+    }
+    const auto& header = *reinterpret_cast<const BinaryDatasetHeader*>(data);
+    if (memcmp(header.magic, BINARY_DATASET_MAGIC, sizeof(header.magic)) ||
+        header.version != BINARY_DATASET_VERSION ||
+        header.imu_record_size != sizeof(BinaryImuRecord) ||
+        header.odometer_record_size != sizeof(OdometerData) ||
+        header.gnss_record_size != sizeof(NavSatFixData)) {
+        error = "incompatible version or record sizes";
+        return false;
+    }
+    if (!_SectionInRange<BinaryImageRecord>(header.image_index_offset,
+                                            header.num_images, size) ||
+        !_SectionInRange<BinaryImuRecord>(header.imu_offset, header.num_imus,
+                                          size) ||
+        !_SectionInRange<OdometerData>(header.odometer_offset,
+                                       header.num_odometers, size) ||
+        !_SectionInRange<NavSatFixData>(header.gnss_offset, header.num_gnss,
+                                        size)) {
+        error = "section out of the file";
+        return false;
+    }
+
+    const auto* images = reinterpret_cast<const BinaryImageRecord*>(
+        data + header.image_index_offset);
+    for (uint32_t i = 0; i < header.num_images; ++i) {
+        const auto& image = images[i];
+        bool valid = image.offset <= size &&
+                     image.size <= size - image.offset && image.size > 0 &&
+                     image.rows > 0 && image.cols > 0;
+        if (valid && image.encoding == BinaryImageEncoding::Raw8U) {
+            // both below 2^31, the product fits
+            valid = uint64_t(image.rows) * uint64_t(image.cols) <= image.size;
+        } else if (valid) {
+            valid = image.encoding == BinaryImageEncoding::PNG;
+        }
+        if (!valid) {
+            error = "image " + std::to_string(i) + " out of the file";
+            return false;
+        }
+    }
+    return true;
+}
+
+BinaryDatasetWriter::BinaryDatasetWriter(const std::string& path) {
+    file_ = fopen(path.c_str(), "wb");
+    if (!file_) {
+        throw std::runtime_error("Failed to open file:" + path);
+    }
+    // the header is rewritten with the final offsets on Close()
+    BinaryDatasetHeader header{};
+    _Write(&header, sizeof(header));
+    _Align();
+}
+
+BinaryDatasetWriter::~BinaryDatasetWriter() {
+    try {
+        Close();
+    } catch (const std::exception& e) {
+        LOGE("%s", e.what());
+    }
+}
+
+void BinaryDatasetWriter::AddImage(int64_t timestamp, const cv::Mat& image,
+                                   int sensor_id) {
+    if (image.type() != CV_8UC1) {
+        throw std::runtime_error("Only 8 bit gray images are supported");
+    }
+    BinaryImageRecord record;
+    record.timestamp = timestamp;
+    record.offset = offset_;
+    record.size = image.rows * image.cols;
+    record.rows = image.rows;
+    record.cols = image.cols;
+    record.sensor_id = sensor_id;
+    record.encoding = BinaryImageEncoding::Raw8U;
+    for (int r = 0; r < image.rows; ++r) {
+        _Write(image.ptr<uchar>(r), image.cols);
+    }
+    _Align();
+    images_.push_back(record);
+}
+
+void BinaryDatasetWriter::AddEncodedImage(int64_t timestamp,
+                                          const std::vector<uchar>& bytes,
+                                          int rows, int cols,
+                                          BinaryImageEncoding encoding,
+                                          int sensor_id) {
+    BinaryImageRecord record;
+    record.timestamp = timestamp;
+    record.offset = offset_;
+    record.size = bytes.size();
+    record.rows = rows;
+    record.cols = cols;
+    record.sensor_id = sensor_id;
+    record.encoding = encoding;
+    _Write(bytes.data(), bytes.size());
+    _Align();
+    images_.push_back(record);
+}
+
+void BinaryDatasetWriter::AddImu(const ImuData& imu) {
+    BinaryImuRecord record{};
+    record.timestamp = imu.timestamp;
+    record.sensor_id = imu.sensor_id;
+    for (int i = 0; i < 3; ++i) {
+        record.gyro[i] = imu.gyro[i];
+        record.acc[i] = imu.acc[i];
+    }
+    imus_.push_back(record);
+}
+
+void BinaryDatasetWriter::AddOdometer(const OdometerData& odometer) {
+    odometers_.push_back(odometer);
+}
+
+void BinaryDatasetWriter::AddNavSatFix(const NavSatFixData& nav_sat_fix) {
+    gnss_.push_back(nav_sat_fix);
+}
+
+void BinaryDatasetWriter::Close() {
+    if (!file_) return;
+
+    auto byTimestamp = [](const auto& a, const auto& b) {
+        return a.timestamp < b.timestamp;
+    };
+    std::stable_sort(images_.begin(), images_.end(), byTimestamp);
+    std::stable_sort(imus_.begin(), imus_.end(), byTimestamp);
+    std::stable_sort(odometers_.begin(), odometers_.end(), byTimestamp);
+    std::stable_sort(gnss_.begin(), gnss_.end(), byTimestamp);
+
+    BinaryDatasetHeader header{};
+    memcpy(header.magic, BINARY_DATASET_MAGIC, sizeof(header.magic));
+    header.version = BINARY_DATASET_VERSION;
+    header.num_images = images_.size();
+    header.num_imus = imus_.size();
+    header.num_odometers = odometers_.size();
+    header.num_gnss = gnss_.size();
+    header.imu_record_size = sizeof(BinaryImuRecord);
+    header.odometer_record_size = sizeof(OdometerData);
+    header.gnss_record_size = sizeof(NavSatFixData);
+
+    header.image_index_offset = offset_;
+    _Write(images_.data(), images_.size() * sizeof(BinaryImageRecord));
+    _Align();
+    header.imu_offset = offset_;
+    _Write(imus_.data(), imus_.size() * sizeof(BinaryImuRecord));
+    _Align();
+    header.odometer_offset = offset_;
+    _Write(odometers_.data(), odometers_.size() * sizeof(OdometerData));
+    _Align();
+    header.gnss_offset = offset_;
+    _Write(gnss_.data(), gnss_.size() * sizeof(NavSatFixData));
+
+    fseek(file_, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, file_);
+    fclose(file_);
+    file_ = nullptr;
+}
+
+void BinaryDatasetWriter::_Write(const void* data, size_t size) {
+    if (!size) return;
+    if (fwrite(data, 1, size, file_) != size) {
+        throw std::runtime_error("Failed to write binary dataset");
+    }
+    offset_ += size;
+}
+
+void BinaryDatasetWriter::_Align() {
+    static const char zeros[BINARY_DATASET_ALIGNMENT] = {0};
+    uint64_t padding = (BINARY_DATASET_ALIGNMENT -
+                        offset_ % BINARY_DATASET_ALIGNMENT) %
+                       BINARY_DATASET_ALIGNMENT;
+    _Write(zeros, padding);
+}
+
+}  // namespace DeltaVins
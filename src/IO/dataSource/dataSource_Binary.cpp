@@ -0,0 +1,143 @@
+#include "IO/dataSource/dataSource_Binary.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+DataSource_Binary::DataSource_Binary() : DataSource() {
+    _Map(Config::Instance().DataSourcePath);
+    image_idx_ = Config::Instance().ImageStartIdx;
+}
+
+DataSource_Binary::~DataSource_Binary() {
+    if (data_) munmap(const_cast<uchar*>(data_), size_);
+}
+
+void DataSource_Binary::_Map(const std::string& path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file:" + path);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 ||
+        st.st_size < static_cast<off_t>(sizeof(BinaryDatasetHeader))) {
+        close(fd);
+        throw std::runtime_error("Invalid binary dataset:" + path);
+    }
+    size_ = st.st_size;
+    // private mapping: pages are shared with the page cache, a consumer
+    // writing into an image only gets its own copy of that page
+    void* data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_PRIVATE,
+                      fd, 0);
+    close(fd);
+    if (data == MAP_FAILED) {
+        throw std::runtime_error("Failed to map file:" + path);
+    }
+    madvise(data, size_, MADV_SEQUENTIAL);
+    data_ = static_cast<const uchar*>(data);
+
+    std::string error;
+    if (!ValidateBinaryDataset(data_, size_, error)) {
+        munmap(data, size_);
+        data_ = nullptr;
+        throw std::runtime_error("Invalid binary dataset:" + path + ", " +
+                                 error);
+    }
+
+    header_ = reinterpret_cast<const BinaryDatasetHeader*>(data_);
+    images_ = reinterpret_cast<const BinaryImageRecord*>(
+        data_ + header_->image_index_offset);
+    imus_ = reinterpret_cast<const BinaryImuRecord*>(data_ +
+                                                     header_->imu_offset);
+    odometers_ =
+        reinterpret_cast<const OdometerData*>(data_ + header_->odometer_offset);
+    gnss_ = reinterpret_cast<const NavSatFixData*>(data_ + header_->gnss_offset);
+
+    LOGI("Map binary dataset %s: %u images, %u imus, %u odometers, %u gnss",
+         path.c_str(), header_->num_images, header_->num_imus,
+         header_->num_odometers, header_->num_gnss);
+}
+
+bool DataSource_Binary::HaveThingsTodo() {
+    if (image_idx_ < header_->num_images) {
+        return true;
+    } else {
+        keep_running_.store(false);
+        return false;
+    }
+}
+
+void DataSource_Binary::DoWhatYouNeedToDo() {
+    const auto& imageInput = images_[image_idx_];
+    const long long image_ts = imageInput.timestamp;
+
+    while (imu_index_ < header_->num_imus &&
+           _DueBeforeImage(imu_index_ ? imus_[imu_index_ - 1].timestamp
+                                      : LLONG_MIN,
+                           imus_[imu_index_].timestamp, image_ts)) {
+        const auto& record = imus_[imu_index_++];
+        ImuData imuData;
+        imuData.timestamp = record.timestamp;
+        imuData.sensor_id = record.sensor_id;
+        imuData.gyro = Eigen::Map<const Vector3f>(record.gyro);
+        imuData.acc = Eigen::Map<const Vector3f>(record.acc);
+        std::lock_guard<std::mutex> lck(mtx_imu_observer_);
+        for (auto& imu_listener : imu_observers_) {
+            imu_listener->OnImuReceived(imuData);
+        }
+    }
+
+    while (odometer_index_ < header_->num_odometers &&
+           _DueBeforeImage(
+               odometer_index_ ? odometers_[odometer_index_ - 1].timestamp
+                               : LLONG_MIN,
+               odometers_[odometer_index_].timestamp, image_ts)) {
+        const auto& odometerData = odometers_[odometer_index_++];
+        std::lock_guard<std::mutex> lck(mtx_odometer_observer_);
+        for (auto& odometer_listener : odometer_observers_) {
+            odometer_listener->OnOdometerReceived(odometerData);
+        }
+    }
+
+    while (gnss_index_ < header_->num_gnss &&
+           _DueBeforeImage(gnss_index_ ? gnss_[gnss_index_ - 1].timestamp
+                                       : LLONG_MIN,
+                           gnss_[gnss_index_].timestamp, image_ts)) {
+        const auto& navSatFixData = gnss_[gnss_index_++];
+        std::lock_guard<std::mutex> lck(mtx_nav_sat_fix_observer_);
+        for (auto& nav_sat_fix_listener : nav_sat_fix_observers_) {
+            nav_sat_fix_listener->OnNavSatFixReceived(navSatFixData);
+        }
+    }
+
+    ImageData::Ptr imageData = std::make_shared<ImageData>();
+    imageData->timestamp = imageInput.timestamp;
+    imageData->sensor_id = imageInput.sensor_id;
+    uchar* pixels = const_cast<uchar*>(data_ + imageInput.offset);
+    if (imageInput.encoding == BinaryImageEncoding::Raw8U) {
+        imageData->image =
+            cv::Mat(imageInput.rows, imageInput.cols, CV_8UC1, pixels);
+    } else {
+        imageData->image = cv::imdecode(
+            cv::Mat(1, imageInput.size, CV_8UC1, pixels), cv::IMREAD_GRAYSCALE);
+        if (imageData->image.empty()) {
+            throw std::runtime_error("Failed to load images");
+        }
+    }
+
+    _WaitForPlaybackTime(imageData->timestamp);
+    {
+        std::lock_guard<std::mutex> lck(mtx_image_observer_);
+        for (auto& image_listener : image_observers_) {
+            image_listener->OnImageReceived(imageData);
+        }
+    }
+    image_idx_++;
+}
+
+}  // namespace DeltaVins
@@ -0,0 +1,37 @@
+#include "IO/dataSource/dataSource_External.h"
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+void DataSource_External::PushImu(const ImuData& imuData) {
+    std::lock_guard<std::mutex> lck(mtx_imu_observer_);
+    // the buffers expect increasing timestamps
+    if (imuData.timestamp <= last_imu_timestamp_) {
+        LOGW_EVERY_MS(1000, "Drop out of order imu %lld",
+                      (long long)imuData.timestamp);
+        return;
+    }
+    last_imu_timestamp_ = imuData.timestamp;
+    for (auto* observer : imu_observers_) observer->OnImuReceived(imuData);
+}
+
+void DataSource_External::PushImage(const ImageData::Ptr imageData) {
+    std::lock_guard<std::mutex> lck(mtx_image_observer_);
+    if (imageData->timestamp <= last_image_timestamp_) {
+        LOGW_EVERY_MS(1000, "Drop out of order image %lld",
+                      (long long)imageData->timestamp);
+        return;
+    }
+    last_image_timestamp_ = imageData->timestamp;
+    for (auto* observer : image_observers_)
+        observer->OnImageReceived(imageData);
+}
+
+void DataSource_External::PushOdometer(const OdometerData& odometerData) {
+    std::lock_guard<std::mutex> lck(mtx_odometer_observer_);
+    for (auto* observer : odometer_observers_)
+        observer->OnOdometerReceived(odometerData);
+}
+
+}  // namespace DeltaVins
@@ -20,12 +20,12 @@ DataSource_ROS2::DataSource_ROS2(bool is_bag)
         RCLCPP_INFO(this->get_logger(), "bag_file_from_ros_param: %s",
                     bag_file_from_ros_param.c_str());
         std::string bag_file_final = bag_file_from_ros_param.empty()
-                                         ? Config::DataSourcePath
+                                         ? Config::Instance().DataSourcePath
                                          : bag_file_from_ros_param;
         reader_ = std::make_shared<rosbag2_cpp::Reader>();
         reader_->open(bag_file_final);
 
-        for (auto& sensor : Config::ROS2SensorTopics) {
+        for (auto& sensor : Config::Instance().ROS2SensorTopics) {
             if (sensor.type == ROS2SensorType::StereoCamera) {
                 topic_map_bag_[sensor.topics[0]] =
                     std::make_pair(sensor.type, sensor.sensor_id);
@@ -40,7 +40,7 @@ DataSource_ROS2::DataSource_ROS2(bool is_bag)
         }
     } else {
         // Create subscribers
-        for (auto& topic : Config::ROS2SensorTopics) {
+        for (auto& topic : Config::Instance().ROS2SensorTopics) {
             if (topic.type == ROS2SensorType::MonoCamera) {
                 std::string topic_name = topic.topics[0];
                 // Create camera subscriber
@@ -267,11 +267,10 @@ void DataSource_ROS2::AccGyroCallback(
     int sensor_id) {
     static const uint gyro_buff_size = 5;
     static const uint acc_buff_size = 5;
-    static std::deque<std::pair<int64_t, Eigen::Vector3f>> acc_buff;
-    static std::deque<std::pair<int64_t, Eigen::Vector3f>> gyro_buff;
-    static std::mutex mtx_buff;
+    auto& acc_buff = acc_buff_;
+    auto& gyro_buff = gyro_buff_;
 
-    std::unique_lock<std::mutex> buff_lck(mtx_buff);
+    std::unique_lock<std::mutex> buff_lck(mtx_buff_);
     int64_t timestamp = msg->header.stamp.sec * 1e9 + msg->header.stamp.nanosec;
     Eigen::Vector3f acc(msg->linear_acceleration.x, msg->linear_acceleration.y,
                         msg->linear_acceleration.z);
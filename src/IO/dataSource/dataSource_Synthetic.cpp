@@ -2,17 +2,18 @@
 
 #include "Algorithm/vision/camModel/camModel.h"
 #include "precompile.h"
+#include "utils/CsvReader.h"
 #include "utils/utils.h"
 #include "utils/SensorConfig.h"
 using namespace std;
 
 namespace DeltaVins {
 DataSource_Synthetic::DataSource_Synthetic() : DataSource() {
-    dataset_dir_ = Config::DataSourcePath;
+    dataset_dir_ = Config::Instance().DataSourcePath;
     cam_dir_ = dataset_dir_ + "/cam0";
     imu_dir_ = dataset_dir_ + "/imu0";
 
-    image_idx_ = Config::ImageStartIdx;
+    image_idx_ = Config::Instance().ImageStartIdx;
     imu_index_ = 0;
     _LoadImage();
     _LoadIMU();
@@ -21,21 +22,18 @@ DataSource_Synthetic::DataSource_Synthetic() : DataSource() {
 DataSource_Synthetic::~DataSource_Synthetic() {}
 
 void DataSource_Synthetic::_LoadIMU() {
-    ifstream imuCsv;
-    imuCsv.open(imu_dir_ + "/data.csv");
+    CsvReader imuCsv(imu_dir_ + "/data.csv");
     CamModel::Ptr camModel = SensorConfig::Instance().GetCamModel(0);
-    static Matrix3f Rci = camModel->getRci();
+    Matrix3f Rci = camModel->getRci();
     ImuData imuData;
-    std::string s;
-    while (!imuCsv.eof()) {
-        getline(imuCsv, s);
-        if (s.empty()) continue;
-        auto nums = split(s, ',');
-        imuData.timestamp = strtoll(nums[0].c_str(), nullptr, 10);
+    while (imuCsv.NextRow()) {
+        if (imuCsv.NumFields() < 7 ||
+            !imuCsv.GetInt64(0, imuData.timestamp))
+            continue;
 
         for (int i = 0; i < 3; i++) {
-            imuData.gyro(i) = strtof(nums[i + 1].c_str(), nullptr);
-            imuData.acc(i) = strtof(nums[i + 4].c_str(), nullptr);
+            imuData.gyro(i) = imuCsv.GetFloat(i + 1);
+            imuData.acc(i) = imuCsv.GetFloat(i + 4);
         }
 
         imuData.acc = Rci * imuData.acc;
@@ -43,32 +41,27 @@ void DataSource_Synthetic::_LoadIMU() {
 
         imus_.push_back(imuData);
     }
-    imuCsv.close();
 }
 
 void DataSource_Synthetic::_LoadImage() {
     const string path = cam_dir_ + "/data.csv";
-    ifstream camCsv;
-    camCsv.open(path);
-    if (!camCsv.is_open()) {
+    CsvReader camCsv(path);
+    if (!camCsv.IsOpen()) {
         throw std::runtime_error("Failed to open file:" + path);
     }
 
     _ImageData image_data;
-    string s;
-    getline(camCsv, s);
-    while (!camCsv.eof()) {
-        getline(camCsv, s);
-        if (s.empty()) break;
-
-        std::vector<std::string> nums = split(s, ',');
-        image_data.timestamp = strtoll(nums[0].c_str(), nullptr, 10);
-        image_data.imagePath = cam_dir_ + "/data/" + nums[0] + ".png";
+    int64_t timestamp;
+    while (camCsv.NextRow()) {
+        // a header without '#' is not a frame
+        if (!camCsv.GetInt64(0, timestamp)) continue;
+        auto name = camCsv.Field(0);
+        image_data.timestamp = timestamp;
+        image_data.imagePath = cam_dir_ + "/data/";
+        image_data.imagePath.append(name.data(), name.size()).append(".png");
 
         images_.push_back(image_data);
     }
-
-    camCsv.close();
 }
 
 bool DataSource_Synthetic::HaveThingsTodo() {
@@ -84,12 +77,14 @@ void DataSource_Synthetic::DoWhatYouNeedToDo() {
     ImageData::Ptr imageData;
 
     if (images_.empty()) {
-        static long long lastTimestamp = imus_[0].timestamp + 150000000;
+        if (last_timestamp_ < 0) {
+            last_timestamp_ = imus_[0].timestamp + 150000000;
+        }
 
         imageData = std::make_shared<ImageData>();
-        imageData->timestamp = lastTimestamp + 50000000;
+        imageData->timestamp = last_timestamp_ + 50000000;
         imageData->image = cv::Mat(480, 640, CV_8UC1);
-        lastTimestamp = imageData->timestamp;
+        last_timestamp_ = imageData->timestamp;
     } else {
         auto& imageInput = images_[image_idx_];
         imageData = std::make_shared<ImageData>();
@@ -102,9 +97,11 @@ void DataSource_Synthetic::DoWhatYouNeedToDo() {
         }
         image_idx_++;
     }
-    long long ddt = 50000000;
     while (imu_index_ < imus_.size() &&
-           imus_[imu_index_].timestamp < imageData->timestamp + ddt) {
+           _DueBeforeImage(imu_index_ ? imus_[imu_index_ - 1].timestamp
+                                      : LLONG_MIN,
+                           imus_[imu_index_].timestamp,
+                           imageData->timestamp)) {
         auto& imuInput = imus_[imu_index_++];
         std::lock_guard<std::mutex> lck(mtx_imu_observer_);
 
@@ -120,6 +117,8 @@ void DataSource_Synthetic::DoWhatYouNeedToDo() {
         }
     }
 
-    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    if (!Config::Instance().DeterministicReplay) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
 }
 }  // namespace DeltaVins
\ No newline at end of file
@@ -0,0 +1,133 @@
+#include "IO/dataSource/imagePrefetcher.h"
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+ImagePrefetcher::ImagePrefetcher(
+    const std::vector<DataSource::_ImageData>& images, size_t start_idx,
+    int read_ahead, int num_threads, int max_width)
+    : images_(images),
+      max_width_(max_width),
+      slots_(std::max(read_ahead, 1)),
+      next_to_load_(start_idx),
+      next_to_pop_(start_idx),
+      buffer_pool_(std::make_shared<BufferPool>()) {
+    for (int i = 0; i < std::max(num_threads, 1); ++i) {
+        workers_.emplace_back([this]() { _WorkerLoop(); });
+    }
+}
+
+ImagePrefetcher::~ImagePrefetcher() {
+    {
+        std::lock_guard<std::mutex> lck(mtx_);
+        stop_ = true;
+    }
+    cv_free_.notify_all();
+    for (auto& worker : workers_) worker.join();
+}
+
+ImageData::Ptr ImagePrefetcher::Pop() {
+    ImageData::Ptr data;
+    {
+        std::unique_lock<std::mutex> lck(mtx_);
+        Slot& slot = slots_[next_to_pop_ % slots_.size()];
+        const size_t index = next_to_pop_;
+        PROFILE_SCOPE("ImageLoadWait");
+        cv_loaded_.wait(
+            lck, [&]() { return slot.ready && slot.index == index; });
+        data = std::move(slot.data);
+        slot.ready = false;
+        next_to_pop_++;
+    }
+    cv_free_.notify_all();
+
+    if (!data) {
+        throw std::runtime_error("Failed to load images");
+    }
+    return data;
+}
+
+void ImagePrefetcher::_WorkerLoop() {
+    while (true) {
+        size_t index;
+        Slot* slot;
+        {
+            std::unique_lock<std::mutex> lck(mtx_);
+            // a slot is free once the image loaded read_ahead before is
+            // popped
+            cv_free_.wait(lck, [this]() {
+                return stop_ || next_to_load_ >= images_.size() ||
+                       next_to_load_ < next_to_pop_ + slots_.size();
+            });
+            if (stop_ || next_to_load_ >= images_.size()) return;
+            index = next_to_load_++;
+            slot = &slots_[index % slots_.size()];
+        }
+
+        _Load(index, *slot);
+
+        {
+            std::lock_guard<std::mutex> lck(mtx_);
+            slot->index = index;
+            slot->ready = true;
+        }
+        cv_loaded_.notify_all();
+    }
+}
+
+void ImagePrefetcher::_Load(size_t index, Slot& slot) {
+    const auto& input = images_[index];
+    slot.data = nullptr;
+
+    std::ifstream file(input.imagePath, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        LOGE("Failed to open image: %s", input.imagePath.c_str());
+        return;
+    }
+    slot.file_buffer.resize(file.tellg());
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(slot.file_buffer.data()),
+              slot.file_buffer.size());
+
+    cv::imdecode(slot.file_buffer, cv::IMREAD_GRAYSCALE, &slot.decoded);
+    if (slot.decoded.empty()) {
+        LOGE("Failed to decode image: %s", input.imagePath.c_str());
+        return;
+    }
+
+    int width_crop = 0;
+    int width = slot.decoded.cols;
+    if (width > max_width_) {
+        width_crop = (width - max_width_) / 2;
+        width = max_width_;
+    }
+    cv::Mat image = _AcquireBuffer(slot.decoded.rows, width);
+    slot.decoded.colRange(width_crop, width_crop + width).copyTo(image);
+
+    // the buffer is free again once nobody holds the image data
+    auto pool = buffer_pool_;
+    slot.data.reset(new ImageData, [pool, image](ImageData* data) {
+        delete data;
+        std::lock_guard<std::mutex> lck(pool->mtx);
+        pool->free.push_back(image);
+    });
+    slot.data->timestamp = input.timestamp;
+    slot.data->image = image;
+}
+
+cv::Mat ImagePrefetcher::_AcquireBuffer(int rows, int cols) {
+    std::lock_guard<std::mutex> lck(buffer_pool_->mtx);
+    auto& free = buffer_pool_->free;
+    for (size_t i = 0; i < free.size(); ++i) {
+        if (free[i].rows == rows && free[i].cols == cols) {
+            cv::Mat buffer = free[i];
+            free[i] = free.back();
+            free.pop_back();
+            return buffer;
+        }
+    }
+    return cv::Mat(rows, cols, CV_8UC1);
+}
+
+}  // namespace DeltaVins
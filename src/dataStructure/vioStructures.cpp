@@ -5,6 +5,7 @@
 
 #include "Algorithm/Initializer/Triangulation.h"
 #include "Algorithm/vision/camModel/camModel.h"
+#include "framework/VioContext.h"
 #include "precompile.h"
 #include "utils/SensorConfig.h"
 #include "utils/tf.h"
@@ -12,6 +13,58 @@
 
 namespace DeltaVins {
 
+namespace {
+
+// frame and landmark ids are unique within one VioContext
+struct IdCounters {
+    std::unordered_map<int, int> frame_ids;
+    int landmark_id = 0;
+};
+
+/**
+ * @brief Inverse depth parameterized triangulation problem,
+ * z = [x/z, y/z, 1/z] of the point in the anchor camera.
+ */
+struct InverseDepthProblem {
+    struct Observation {
+        Matrix3d dR;  // rotation from anchor camera to observing camera
+        Vector3d dt;  // translation from anchor camera to observing camera
+        Vector2f px;
+        int cam_id;
+    };
+
+    template <typename Func>
+    void ForEachResidual(const Vector3d& z, Func&& f) const {
+        Vector3d position(z[0] / z[2], z[1] / z[2], 1.0 / z[2]);
+        Matrix3d J33;
+        J33 << position[2], 0, -position[0] * position[2], 0, position[2],
+            -position[1] * position[2], 0, 0, -position[2] * position[2];
+        for (const auto& ob : obs) {
+            Vector3f p_cam_f = (ob.dR * position + ob.dt).cast<float>();
+
+            Matrix23f J23f;
+            Vector2f px_reprj = cam_model->camToImage(p_cam_f, J23f, ob.cam_id);
+            Vector2d r = (ob.px - px_reprj).cast<double>();
+            Matrix23d J = J23f.cast<double>() * ob.dR * J33;
+            f(r, J);
+        }
+    }
+
+    bool DecentFail(const Vector3d& z_new) const { return z_new[2] < 0; }
+
+    void ConvergeCriteria(LM_Result& result) const {
+        if (result.cost < 10) result.bConverged = true;
+        if (result.cost > 40) result.bConverged = false;
+    }
+
+    std::vector<Observation> obs;
+    CamModel* cam_model = nullptr;
+};
+
+using TriangulationLM = NonLinear_LM<InverseDepthProblem, 3, double>;
+
+}  // namespace
+
 VisualObservation::VisualObservation(const Vector2f& px, Frame* frame,
                                      int cam_id)
     : px(px), link_frame(frame), cam_id(cam_id) {
@@ -25,8 +78,8 @@ Frame::Frame(int sensor_id) {
     valid_landmark_num = 0;
     this->sensor_id = sensor_id;
     flag_keyframe = false;
-    static std::unordered_map<int, int> frame_id_counter;
-    frame_id = frame_id_counter[sensor_id]++;
+    auto& ids = VioContext::Current().GetState<IdCounters>();
+    frame_id = ids.frame_ids[sensor_id]++;
 }
 
 VisualObservation::Ptr Frame::AddVisualObservation(const Vector2f& px,
@@ -92,7 +145,7 @@ void Landmark::SetDeadFlag(bool dead, int cam_id) {
     }
 }
 
-Landmark::Landmark() : NonLinear_LM(1e-2, 0.005, 1e-3, 15, false) {
+Landmark::Landmark() {
     flag_dead[0] = true;
     flag_dead[1] = true;
     flag_dead_all = true;
@@ -107,9 +160,9 @@ Landmark::Landmark() : NonLinear_LM(1e-2, 0.005, 1e-3, 15, false) {
 
     flag_dead_frame_id[0] = -1;
     flag_dead_frame_id[1] = -1;
-    static int counter = 0;
-    landmark_id_ = counter++;
+    landmark_id_ = VioContext::Current().GetState<IdCounters>().landmark_id++;
     stereo_parallax = 0;
+    m_Result.clear();
 }
 
 bool Landmark::TriangulationAnchorDepth(float& anchor_depth) {
@@ -120,10 +173,10 @@ bool Landmark::TriangulationAnchorDepth(float& anchor_depth) {
     // Todo: support multi-camera
     CamModel::Ptr camModel = SensorConfig::Instance().GetCamModel(0);
     // static Vector3d Tci = camModel->getTci().cast<double>();
-    static Matrix3d Rci[2] = {camModel->getRci(0).cast<double>(),
-                              camModel->getRci(1).cast<double>()};
-    static Vector3d Pc_in_i[2] = {camModel->getPic(0).cast<double>(),
-                                  camModel->getPic(1).cast<double>()};
+    const Matrix3d Rci[2] = {camModel->getRci(0).cast<double>(),
+                             camModel->getRci(1).cast<double>()};
+    const Vector3d Pc_in_i[2] = {camModel->getPic(0).cast<double>(),
+                                 camModel->getPic(1).cast<double>()};
     int anchor_cam_id = visual_obs[0].size() > 0 ? 0 : 1;
     for (int cam_id = 0; cam_id < 2; cam_id++) {
         for (auto& visualOb : visual_obs[cam_id]) {
@@ -155,13 +208,9 @@ bool Landmark::Triangulate() {
 }
 
 bool Landmark::TriangulateLM(float depth_prior) {
-    if (verbose_) LOGI("###PointID:%d", landmark_id_);
-    // if (point_state_) return m_Result.bConverged;
+    constexpr bool verbose = false;
+    if (verbose) LOGI("###PointID:%d", landmark_id_);
     // TODO: multi-camera triangulation
-    // CamModel::Ptr camModel = SensorConfig::Instance().GetCamModel(0);
-    // static Vector3d Tci = camModel->getTci().cast<double>();
-
-    clear();
 
     // select the anchor observation
     // the anchor observation is selected from the right camera only when the
@@ -174,12 +223,6 @@ bool Landmark::TriangulateLM(float depth_prior) {
     }
     int anchor_cam_id = anchor_ob->cam_id;
 
-    // Vector3f pInImu = Rci.transpose() * (leftVisualOb.m_Ray_cam*2) + Pic;
-    z = anchor_ob->ray_in_cam.cast<double>();
-    z /= z[2];
-    z[2] = 1 / depth_prior;
-    /*z.z() = 1/pInImu.z();*/
-
     Matrix3f anchor_R = anchor_ob->link_frame->state->Rwi;
     Vector3f anchor_P = anchor_ob->link_frame->state->Pwi;
     Eigen::Isometry3f T_w_i_anchor = Eigen::Isometry3f::Identity();
@@ -196,43 +239,45 @@ bool Landmark::TriangulateLM(float depth_prior) {
     Transform<float> T_i_c_anchor_tf;
     T_i_c_anchor_tf = anchor_cam_id == 0 ? T_i_c0_tf : T_i_c1_tf;
     auto T_w_c_anchor_tf = T_w_i_anchor_tf * T_i_c_anchor_tf;
-    // To compute the relative pose between the anchor frame and the current
-    // frame
-
-    // get the relative pose between left and right
-    Transform<float> T_c0_c1_tf;
-    if (!visual_obs[0].empty() && !visual_obs[1].empty()) {
-        Tfs<float>::Instance().GetTransform("camera0_right", "camera0",
-                                            T_c0_c1_tf);
-    }
 
+    // To compute the relative pose between the anchor frame and the current
+    // frame, packed into a flat array so that LM iterations do not walk the
+    // observation sets again.
+    static thread_local InverseDepthProblem problem;
+    problem.cam_model = SensorConfig::Instance().GetCamModel(0).get();
+    problem.obs.clear();
     for (int cam_id = 0; cam_id < 2; cam_id++) {
-        const int nSize = visual_obs[cam_id].size();
-        dRs[cam_id].resize(nSize);
-        dts[cam_id].resize(nSize);
         Transform<float> T_i_c_n_tf = cam_id == 0 ? T_i_c0_tf : T_i_c1_tf;
-        {
-            int i = 0;
-            for (auto& visualOb : visual_obs[cam_id]) {
-                Eigen::Isometry3f T_w_i_n;
-
-                T_w_i_n.linear() = visualOb->link_frame->state->Rwi;
-                T_w_i_n.translation() = visualOb->link_frame->state->Pwi;
-                Transform<float> T_w_i_n_tf =
-                    Transform<float>(0, "world", "imu0", T_w_i_n);
-
-                Transform<float> T_i_n_i_a_tf =
-                    T_w_i_n_tf.Inverse() * T_w_i_anchor_tf;
-                Transform<float> T_cn_ca_tf =
-                    T_i_c_n_tf.Inverse() * T_i_n_i_a_tf * T_i_c_anchor_tf;
-                dRs[cam_id][i] = T_cn_ca_tf.Rotation().cast<double>();
-                dts[cam_id][i] = T_cn_ca_tf.Translation().cast<double>();
-                i++;
-            }
+        for (auto& visualOb : visual_obs[cam_id]) {
+            Eigen::Isometry3f T_w_i_n;
+
+            T_w_i_n.linear() = visualOb->link_frame->state->Rwi;
+            T_w_i_n.translation() = visualOb->link_frame->state->Pwi;
+            Transform<float> T_w_i_n_tf =
+                Transform<float>(0, "world", "imu0", T_w_i_n);
+
+            Transform<float> T_i_n_i_a_tf =
+                T_w_i_n_tf.Inverse() * T_w_i_anchor_tf;
+            Transform<float> T_cn_ca_tf =
+                T_i_c_n_tf.Inverse() * T_i_n_i_a_tf * T_i_c_anchor_tf;
+
+            InverseDepthProblem::Observation ob;
+            ob.dR = T_cn_ca_tf.Rotation().cast<double>();
+            ob.dt = T_cn_ca_tf.Translation().cast<double>();
+            ob.px = visualOb->px;
+            ob.cam_id = cam_id;
+            problem.obs.push_back(ob);
         }
     }
 
-    solve();
+    TriangulationLM lm(problem, 1e-2, 0.005, 1e-3, 15, verbose);
+    Vector3d& z = lm.State();
+    z = anchor_ob->ray_in_cam.cast<double>();
+    z /= z[2];
+    z[2] = 1 / depth_prior;
+
+    lm.solve();
+    m_Result = lm.m_Result;
 
     if (point_state_ == nullptr) {
         point_state_ = new PointState();
@@ -243,17 +288,13 @@ bool Landmark::TriangulateLM(float depth_prior) {
     point_state_->Pw = T_w_c_anchor_tf.TransformPoint(cpt.cast<float>());
     point_state_->Pw_FEJ = point_state_->Pw;
     float depthRatio = 0.01;
+    const Matrix3d& H = lm.Hessian();
     if (m_Result.bConverged && !flag_dead_all && m_Result.cost < 2 &&
         H(2, 2) > depthRatio * H(0, 0) && H(2, 2) > depthRatio * H(1, 1))
         flag_slam_point_candidate = true;
 
     // if (z[2] < 0.1) flag_slam_point_candidate = false;
 
-    for (int cam_id = 0; cam_id < 2; cam_id++) {
-        dRs[cam_id].clear();
-        dts[cam_id].clear();
-    }
-
     m_Result.cost = Reproject(false);
     if (m_Result.cost > 5) {
         delete point_state_;
@@ -264,68 +305,6 @@ bool Landmark::TriangulateLM(float depth_prior) {
     return m_Result.bConverged;
 }
 
-double Landmark::EvaluateF(bool bNewZ, double huberThresh) {
-    double cost = 0.0;
-    // const int nSize = visual_obs.size();
-    Matrix23d J23;
-    Matrix3d J33;
-    Vector3d position;
-
-    // float huberCutTh = 10.f;
-
-    if (bNewZ) {
-        position = zNew / zNew[2];
-        position[2] = 1.0 / zNew[2];
-    } else {
-        position = z / z[2];
-        position[2] = 1.0 / z[2];
-    }
-    HTemp.setZero();
-    bTemp.setZero();
-    J33 << position[2], 0, -position[0] * position[2], 0, position[2],
-        -position[1] * position[2], 0, 0, -position[2] * position[2];
-    // Todo: Multi Camera Support
-    CamModel::Ptr camModel = SensorConfig::Instance().GetCamModel(0);
-    for (int cam_id = 0; cam_id < 2; cam_id++) {
-        int i = 0;
-        for (auto& visualOb : visual_obs[cam_id]) {
-            Vector3f p_cam_f =
-                (dRs[cam_id][i] * position + dts[cam_id][i]).cast<float>();
-
-            Matrix23f J23f;
-            visualOb->px_reprj = camModel->camToImage(p_cam_f, J23f, cam_id);
-            Matrix23d J23d = J23f.cast<double>();
-
-            Vector2d r = (visualOb->px - visualOb->px_reprj).cast<double>();
-#if HUBER || 1
-            double reprojErr = r.norm();
-            double hw = reprojErr > huberThresh ? huberThresh / reprojErr : 1;
-            // cost += reprojErr>huberThresh ?
-            // huberThresh*(2*reprojErr-huberThresh):reprojErr*reprojErr;
-            if (reprojErr > huberThresh) {
-                cost += huberThresh * (2 * reprojErr - huberThresh);
-            } else
-                cost += reprojErr * reprojErr;
-#else
-            float hw = 1.0f;
-            cost += r.squaredNorm();
-#endif
-
-            Matrix23d J = J23d * dRs[cam_id][i] * J33;
-
-            HTemp.noalias() += J.transpose() * J * hw;
-            bTemp.noalias() += J.transpose() * r * hw;
-
-            i++;
-        }
-    }
-    // if(!bNewZ)
-    //	H += Matrix3f::Identity()*FLT_EPSILON;
-    return cost;
-}
-
-bool Landmark::UserDefinedDecentFail() { return zNew[2] < 0; }
-
 void Landmark::AddVisualObservation(VisualObservation::Ptr obs, int cam_id) {
     flag_dead[cam_id] = false;
     flag_dead_all = false;
@@ -419,7 +398,7 @@ float Landmark::Reproject(bool verbose, int cam_id) {
 
 void Landmark::DrawObservationsAndReprojection(int time, int cam_id) {
 #if ENABLE_VISUALIZER && !defined(PLATFORM_ARM)
-    if (Config::NoGUI) return;
+    if (Config::Instance().NoGUI) return;
     cv::Mat display;
     bool first = 1;
     for (auto& ob : visual_obs[cam_id]) {
@@ -472,12 +451,6 @@ void Landmark::RemoveUselessObservationForSlamPoint() {
         }
     }
 }
-bool Landmark::UserDefinedConvergeCriteria() {
-    if (m_Result.cost < 10) m_Result.bConverged = true;
-    if (m_Result.cost > 40) m_Result.bConverged = false;
-    return true;
-}
-
 void Landmark::PrintPositions() {}
 
 void Landmark::PopObservation(int cam_id) {
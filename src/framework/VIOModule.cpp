@@ -1,28 +1,40 @@
 #include "framework/VIOModule.h"
 
 #include "IO/dataBuffer/imageBuffer.h"
+#include "IO/dataBuffer/imuBuffer.h"
 #include "precompile.h"
+#include "utils/Metrics.h"
 
 namespace DeltaVins {
-VIOModule::VIOModule() {}
+VIOModule::VIOModule() : image_buffer_(ImageBuffer::Instance()) {}
 
 VIOModule::~VIOModule() {}
 
 void VIOModule::OnImageReceived(const ImageData::Ptr imageData) {
-    static int counter = 0;
-    counter++;
-    if (counter < Config::ImageStartIdx) return;
+    image_counter_++;
+    if (image_counter_ < Config::Instance().ImageStartIdx) return;
 
-    static auto& imageBuffer = ImageBuffer::Instance();
-    imageBuffer.PushImage(imageData);
+    image_buffer_.PushImage(imageData);
 
-    if (Config::SerialRun) {
+    if (Config::Instance().SerialRun) {
         WakeUpAndWait();
     } else {
         WakeUpMovers();
     }
 }
 
+void VIOModule::OnImuReceived(const ImuData& imuData) {
+    Pose pose;
+    if (!imu_propagator_.AddImu(imuData, pose)) return;
+    for (auto* observer : pose_observers_)
+        observer->OnPropagatedPoseAvailable(pose);
+}
+
+void VIOModule::Stop() {
+    AbstractModule::Stop();
+    vio_algorithm_.FinishOutput();
+}
+
 void VIOModule::SetFrameAdapter(FrameAdapter* adapter) {
     vio_algorithm_.SetFrameAdapter(adapter);
 }
@@ -31,32 +43,54 @@ void VIOModule::SetPointAdapter(WorldPointAdapter* adapter) {
     vio_algorithm_.SetWorldPointAdapter(adapter);
 }
 
+void VIOModule::AddPoseObserver(PoseObserver* observer) {
+    pose_observers_.push_back(observer);
+}
+
 bool VIOModule::HaveThingsTodo() {
-    static auto& imageBuffer = ImageBuffer::Instance();
-    return !imageBuffer.empty();
+    return !image_buffer_.empty();
 }
 
 void VIOModule::DoWhatYouNeedToDo() {
-    TickTock::get("FullFrame").start();
-    static auto& imageBuffer = ImageBuffer::Instance();
-
-    auto image = imageBuffer.PopTailImage();
+    const auto start = std::chrono::steady_clock::now();
+    PROFILE_SCOPE_NAMED(full_frame_scope, "FullFrame");
+    auto image = image_buffer_.PopTailImage();
+    // positive while the imu is behind, the frame then waits for it
+    METRIC_SET("imu_lag_ms",
+               "Image timestamp minus the newest imu timestamp at the start "
+               "of the frame",
+               (image->timestamp - ImuBuffer::Instance().LatestTimestamp()) /
+                   1e6);
 
     auto pose = std::make_shared<Pose>();
-    vio_algorithm_.AddNewFrame(image, pose);
-    if (Config::SerialRun) TellOthersThingsToBeDone();
-    TickTock::get("FullFrame").stop();
-    auto time_cost = TickTock::get("FullFrame").getTimeMilli();
-    if (Config::MaxRunFPS > 0 && Config::SerialRun) {
-        auto sleep_time = 1000.0 / Config::MaxRunFPS - time_cost;
+    const bool tracking = vio_algorithm_.AddNewFrame(image, pose);
+    METRIC_ADD("frames_total", "Frames processed", 1);
+    METRIC_SET("tracking", "1 once the filter is initialized", tracking);
+    if (tracking) {
+        for (auto* observer : pose_observers_) observer->OnPoseAvailable(*pose);
+        // restart the propagation from the updated state
+        ImuPropagator::State state;
+        Pose propagated;
+        if (Config::Instance().ImuRatePose &&
+            vio_algorithm_.GetImuState(state) &&
+            imu_propagator_.SetState(state, propagated) &&
+            propagated.timestamp > pose->timestamp) {
+            for (auto* observer : pose_observers_)
+                observer->OnPropagatedPoseAvailable(propagated);
+        }
+    }
+    if (Config::Instance().SerialRun) TellOthersThingsToBeDone();
+    full_frame_scope.Stop();
+    const double time_cost = std::chrono::duration<double, std::milli>(
+                                 std::chrono::steady_clock::now() - start)
+                                 .count();
+    if (Config::Instance().MaxRunFPS > 0 && Config::Instance().SerialRun) {
+        auto sleep_time = 1000.0 / Config::Instance().MaxRunFPS - time_cost;
         if (sleep_time > 0) {
             LOGI("VIOModule::SleepFor %lf ms", sleep_time);
             std::this_thread::sleep_for(
                 std::chrono::milliseconds(static_cast<int>(sleep_time)));
         }
     }
-    // LOGI("VIOModule::DoWhatYouNeedToDo time cost: %lf ms and fps: %lf",
-    // time_cost, TickTock::get("FullFrame").getFPS());
-    TickTock::get("FullFrame").reset();
 }
 }  // namespace DeltaVins
@@ -0,0 +1,96 @@
+#include "framework/VioContext.h"
+
+#include "IO/dataBuffer/GnssBuffer.h"
+#include "IO/dataBuffer/OdometerBuffer.h"
+#include "IO/dataBuffer/imageBuffer.h"
+#include "IO/dataBuffer/imuBuffer.h"
+#include "precompile.h"
+#include "utils/Metrics.h"
+#include "utils/Profiler.h"
+#include "utils/SensorConfig.h"
+#include "utils/tf.h"
+
+namespace DeltaVins {
+
+namespace {
+thread_local VioContext* t_current_context = nullptr;
+}
+
+VioContext::VioContext()
+    : config_(new Config()),
+      sensor_config_(new SensorConfig()),
+      tfs_(new Tfs<float>()),
+      profiler_(new Profiler()),
+      metrics_(new Metrics()) {}
+
+VioContext::~VioContext() = default;
+
+VioContext& VioContext::Current() {
+    return t_current_context ? *t_current_context : Default();
+}
+
+VioContext& VioContext::Default() {
+    static VioContext context;
+    return context;
+}
+
+const VioContext* VioContext::Bound() { return t_current_context; }
+
+VioContext::Scope::Scope(VioContext* context) : previous_(t_current_context) {
+    t_current_context = context;
+}
+
+VioContext::Scope::~Scope() { t_current_context = previous_; }
+
+ImuBuffer& VioContext::GetImuBuffer() {
+    std::call_once(imu_buffer_once_,
+                   [this]() { imu_buffer_.reset(new ImuBuffer()); });
+    return *imu_buffer_;
+}
+
+ImageBuffer& VioContext::GetImageBuffer() {
+    std::call_once(image_buffer_once_,
+                   [this]() { image_buffer_.reset(new ImageBuffer()); });
+    return *image_buffer_;
+}
+
+OdometerBuffer& VioContext::GetOdometerBuffer() {
+    std::call_once(odometer_buffer_once_,
+                   [this]() { odometer_buffer_.reset(new OdometerBuffer()); });
+    return *odometer_buffer_;
+}
+
+GnssBuffer& VioContext::GetGnssBuffer() {
+    std::call_once(gnss_buffer_once_,
+                   [this]() { gnss_buffer_.reset(new GnssBuffer()); });
+    return *gnss_buffer_;
+}
+
+Config& Config::Instance() { return VioContext::Current().GetConfig(); }
+
+SensorConfig& SensorConfig::Instance() {
+    return VioContext::Current().GetSensorConfig();
+}
+
+template <>
+Tfs<float>& Tfs<float>::Instance() {
+    return VioContext::Current().GetTfs();
+}
+
+ImuBuffer& ImuBuffer::Instance() {
+    return VioContext::Current().GetImuBuffer();
+}
+
+ImageBuffer& ImageBuffer::Instance() {
+    return VioContext::Current().GetImageBuffer();
+}
+
+OdometerBuffer& OdometerBuffer::Instance() {
+    return VioContext::Current().GetOdometerBuffer();
+}
+
+GnssBuffer& GnssBuffer::Instance() {
+    return VioContext::Current().GetGnssBuffer();
+}
+
+}  // namespace DeltaVins
@@ -3,20 +3,27 @@
 #include "Algorithm/vision/camModel/camModel.h"
 #include "IO/dataBuffer/imuBuffer.h"
 #include "IO/dataSource/dataSource.h"
+#include "IO/dataSource/dataSource_Binary.h"
 #include "IO/dataSource/dataSource_Euroc.h"
+#include "IO/dataSource/dataSource_External.h"
 #include "framework/VIOModule.h"
+#include "framework/VioContext.h"
 #include "precompile.h"
 #include "utils/Config.h"
 #if ENABLE_VISUALIZER
 #include "../../SlamVisualizer/SlamVisualizer.h"
 #elif ENABLE_VISUALIZER_TCP
 #include "IO/dataOuput/PoseOutputTCP.h"
+#elif ENABLE_VISUALIZER_SHM
+#include "IO/dataOuput/PoseOutputShm.h"
 #endif
 
 #include "IO/dataOuput/DataOutputROS.h"
 #include "IO/dataOuput/DataRecorder.h"
+#include "IO/dataOuput/MetricsReporter.h"
 #include "IO/dataSource/dataSource_Synthetic.h"
-#include "utils/TickTock.h"
+#include "utils/AllocTracker.h"
+#include "utils/Profiler.h"
 
 #if USE_ROS2
 #include "IO/dataSource/dataSource_ROS2.h"
@@ -28,49 +35,128 @@
 
 using namespace DeltaVins;
 
-DataSource::Ptr dataSourcePtr = nullptr;
-VIOModule::Ptr vioModulePtr = nullptr;
-DataRecorder::Ptr dataRecorderPtr = nullptr;
+// keeps the latest pose for GetLatestPose and forwards it to the callback
+struct PoseListener : public VIOModule::PoseObserver {
+    void OnPoseAvailable(const Pose& pose) override { _Publish(pose); }
+    void OnPropagatedPoseAvailable(const Pose& pose) override {
+        _Publish(pose);
+    }
+
+    void _Publish(const Pose& pose) {
+        VioPose out;
+        out.timestamp = pose.timestamp;
+        Quaternionf q(pose.Rwb);
+        for (int i = 0; i < 3; i++) out.position[i] = pose.Pwb[i];
+        out.rotation[0] = q.w();
+        out.rotation[1] = q.x();
+        out.rotation[2] = q.y();
+        out.rotation[3] = q.z();
+
+        VioPoseCallback cb;
+        void* cb_data;
+        {
+            std::lock_guard<std::mutex> lck(mtx);
+            // a frame pose lags behind the propagated ones
+            if (!valid || out.timestamp >= latest.timestamp) latest = out;
+            valid = true;
+            cb = callback;
+            cb_data = user_data;
+        }
+        if (cb) cb(&out, cb_data);
+    }
+
+    std::mutex mtx;
+    bool valid = false;
+    VioPose latest;
+    VioPoseCallback callback = nullptr;
+    void* user_data = nullptr;
+};
+
+// one estimator with everything it owns
+struct VioSystem {
+    std::unique_ptr<VioContext> owned_context;
+    VioContext* context = nullptr;
+    FILE* log_file = nullptr;  // of VioSystemOptions
+    PoseListener pose_listener;
+
+    DataSource::Ptr dataSourcePtr = nullptr;
+    // same object as dataSourcePtr for DataSrcExternal
+    std::shared_ptr<DataSource_External> externalSourcePtr = nullptr;
+    VIOModule::Ptr vioModulePtr = nullptr;
+    DataRecorder::Ptr dataRecorderPtr = nullptr;
+    MetricsReporter::Ptr metricsReporterPtr = nullptr;
 #if ENABLE_VISUALIZER
-SlamVisualizer::Ptr slamVisualizerPtr = nullptr;
+    SlamVisualizer::Ptr slamVisualizerPtr = nullptr;
 #elif ENABLE_VISUALIZER_TCP
-PoseOutputTcp::Ptr tcpPtr = nullptr;
+    PoseOutputTcp::Ptr tcpPtr = nullptr;
+#elif ENABLE_VISUALIZER_SHM
+    PoseOutputShm::Ptr shmPtr = nullptr;
 #endif
 
 #if USE_ROS2
-DataOutputROS::Ptr rosPtr = nullptr;
+    DataOutputROS::Ptr rosPtr = nullptr;
 #endif
+};
 
-bool InitSlamSystem(const char* configFile) {
-    // Init Log
-    logInit();
+// system of the InitSlamSystem API, runs in the default context
+static VioSystem& _DefaultSystem() {
+    // constructed first, so the default context outlives the modules
+    static VioContext& context = VioContext::Default();
+    static VioSystem system;
+    system.context = &context;
+    return system;
+}
 
+static bool _InitSystem(VioSystem& system, const char* configFile) {
+    auto& config = Config::Instance();
     // load config file
-    if (!Config::loadConfigFile(configFile)) {
+    if (!config.loadConfigFile(configFile)) {
         return false;
     }
-    if (!SensorConfig::Instance().LoadConfig(Config::CalibrationPath)) {
+    // the logger is shared, the last loaded config decides
+#if !USE_ROS2
+    Logger::SetLevel(static_cast<LogLevel>(config.LogLevel));
+#else
+    static const rclcpp::Logger::Level ROS_LEVELS[] = {
+        rclcpp::Logger::Level::Debug, rclcpp::Logger::Level::Info,
+        rclcpp::Logger::Level::Warn, rclcpp::Logger::Level::Error,
+        rclcpp::Logger::Level::Fatal};
+    rclcpp::get_logger("rclcpp").set_level(
+        ROS_LEVELS[std::min(std::max(config.LogLevel, 0), 4)]);
+#endif
+    if (config.ExportTrace) Profiler::Instance().EnableTrace();
+    if (config.PerfCounters && !Profiler::Instance().EnablePerfCounters()) {
+        LOGW("No hardware counters, see perf_event_paranoid");
+    }
+    if (!SensorConfig::Instance().LoadConfig(config.CalibrationPath)) {
         return false;
     }
     // CamModel::loadCalibrations();
-    if (Config::CameraCalibration) {
+    if (config.CameraCalibration) {
         return true;
     }
 
     // Init DataSource
+    if (config.DataSourceType == DataSrcExternal) {
+        system.externalSourcePtr = std::make_shared<DataSource_External>();
+        system.dataSourcePtr = system.externalSourcePtr;
+    }
 #ifndef USE_ROS2
-    if (Config::DataSourceType == DataSrcEuroc)
-        dataSourcePtr = std::static_pointer_cast<DataSource>(
+    else if (config.DataSourceType == DataSrcEuroc)
+        system.dataSourcePtr = std::static_pointer_cast<DataSource>(
             std::make_shared<DataSource_Euroc>());
-    else if (Config::DataSourceType == DataSrcSynthetic)
-        dataSourcePtr = std::static_pointer_cast<DataSource>(
+    else if (config.DataSourceType == DataSrcSynthetic)
+        system.dataSourcePtr = std::static_pointer_cast<DataSource>(
             std::make_shared<DataSource_Synthetic>());
+    else if (config.DataSourceType == DataSrcBinary)
+        system.dataSourcePtr = std::static_pointer_cast<DataSource>(
+            std::make_shared<DataSource_Binary>());
 #else
-    if (Config::DataSourceType == DataSrcROS2)
-        dataSourcePtr = std::static_pointer_cast<DataSource>(
+    else if (config.DataSourceType == DataSrcROS2)
+        system.dataSourcePtr = std::static_pointer_cast<DataSource>(
             std::make_shared<DataSource_ROS2>(false));
-    else if (Config::DataSourceType == DataSrcROS2_bag)
-        dataSourcePtr = std::static_pointer_cast<DataSource>(
+    else if (config.DataSourceType == DataSrcROS2_bag)
+        system.dataSourcePtr = std::static_pointer_cast<DataSource>(
             std::make_shared<DataSource_ROS2>(true));
 #endif
     else
@@ -78,99 +164,398 @@ bool InitSlamSystem(const char* configFile) {
 
     // Init VIO Module
 
-    if (Config::RunVIO) vioModulePtr = std::make_shared<VIOModule>();
+    if (config.RunVIO) {
+        system.vioModulePtr = std::make_shared<VIOModule>();
+        system.vioModulePtr->AddPoseObserver(&system.pose_listener);
+    }
 
-    if (Config::RecordData) {
-        dataRecorderPtr = std::make_shared<DataRecorder>();
-        dataSourcePtr->AddImageObserver(dataRecorderPtr.get());
+    if (config.RecordData) {
+        system.dataRecorderPtr = std::make_shared<DataRecorder>();
+        system.dataSourcePtr->AddImageObserver(system.dataRecorderPtr.get());
     }
 
 #if ENABLE_VISUALIZER
-    if (!Config::NoGUI) {
-        slamVisualizerPtr = std::make_shared<SlamVisualizer>(640, 480);
-        if (Config::RunVIO) {
-            vioModulePtr->SetFrameAdapter(slamVisualizerPtr.get());
-            vioModulePtr->SetPointAdapter(slamVisualizerPtr.get());
-        } else if (Config::RecordData) {
-            dataRecorderPtr->AddFrameAdapter(slamVisualizerPtr.get());
-            dataRecorderPtr->AddWorldPointAdapter(slamVisualizerPtr.get());
+    if (!config.NoGUI) {
+        system.slamVisualizerPtr = std::make_shared<SlamVisualizer>(640, 480);
+        if (config.RunVIO) {
+            system.vioModulePtr->SetFrameAdapter(
+                system.slamVisualizerPtr.get());
+            system.vioModulePtr->SetPointAdapter(
+                system.slamVisualizerPtr.get());
+        } else if (config.RecordData) {
+            system.dataRecorderPtr->AddFrameAdapter(
+                system.slamVisualizerPtr.get());
+            system.dataRecorderPtr->AddWorldPointAdapter(
+                system.slamVisualizerPtr.get());
         }
     }
 #elif ENABLE_VISUALIZER_TCP
-    if (!Config::NoGUI) {
-        tcpPtr = std::make_shared<PoseOutputTcp>();
-        if (Config::RunVIO) {
-            vioModulePtr->SetFrameAdapter(tcpPtr.get());
-            vioModulePtr->SetPointAdapter(tcpPtr.get());
-        } else if (Config::RecordData) {
-            dataRecorderPtr->AddFrameAdapter(tcpPtr.get());
-            dataRecorderPtr->AddWorldPointAdapter(tcpPtr.get());
+    if (!config.NoGUI) {
+        system.tcpPtr = std::make_shared<PoseOutputTcp>();
+        if (config.RunVIO) {
+            system.vioModulePtr->SetFrameAdapter(system.tcpPtr.get());
+            system.vioModulePtr->SetPointAdapter(system.tcpPtr.get());
+        } else if (config.RecordData) {
+            system.dataRecorderPtr->AddFrameAdapter(system.tcpPtr.get());
+            system.dataRecorderPtr->AddWorldPointAdapter(system.tcpPtr.get());
+        }
+    }
+#elif ENABLE_VISUALIZER_SHM
+    if (!config.NoGUI) {
+        // an image slot holds a BGR track image of the calibrated size
+        shm::Layout layout;
+        auto cam = SensorConfig::Instance().GetCamModel(0);
+        layout.max_image_bytes = 0;
+        for (int i = 0; i < (cam->IsStereo() ? 2 : 1); ++i) {
+            layout.max_image_bytes = std::max<uint32_t>(
+                layout.max_image_bytes, cam->width(i) * cam->height(i) * 3);
+        }
+        system.shmPtr =
+            std::make_shared<PoseOutputShm>(config.ShmTransportName, layout);
+        if (config.RunVIO) {
+            system.vioModulePtr->SetFrameAdapter(system.shmPtr.get());
+            system.vioModulePtr->SetPointAdapter(system.shmPtr.get());
+        } else if (config.RecordData) {
+            system.dataRecorderPtr->AddFrameAdapter(system.shmPtr.get());
+            system.dataRecorderPtr->AddWorldPointAdapter(system.shmPtr.get());
         }
     }
 #elif USE_ROS2
-    if (!Config::NoGUI) {
-        rosPtr = std::make_shared<DataOutputROS>();
-        if (Config::RunVIO) {
-            vioModulePtr->SetFrameAdapter(rosPtr.get());
-            vioModulePtr->SetPointAdapter(rosPtr.get());
+    if (!config.NoGUI) {
+        system.rosPtr = std::make_shared<DataOutputROS>();
+        if (config.RunVIO) {
+            system.vioModulePtr->SetFrameAdapter(system.rosPtr.get());
+            system.vioModulePtr->SetPointAdapter(system.rosPtr.get());
         }
     }
 #endif
 
     // add links between modules
-    if (Config::RunVIO) dataSourcePtr->AddImageObserver(vioModulePtr.get());
-    dataSourcePtr->AddImuObserver(&ImuBuffer::Instance());
-    if (Config::UseGnss) {
-        dataSourcePtr->AddNavSatFixObserver(&GnssBuffer::Instance());
+    if (config.RunVIO)
+        system.dataSourcePtr->AddImageObserver(system.vioModulePtr.get());
+    system.dataSourcePtr->AddImuObserver(&ImuBuffer::Instance());
+    if (config.RunVIO && config.ImuRatePose) {
+        system.dataSourcePtr->AddImuObserver(system.vioModulePtr.get());
+    }
+    if (config.UseGnss) {
+        system.dataSourcePtr->AddNavSatFixObserver(&GnssBuffer::Instance());
     }
-    if (Config::UseOdometer) {
-        dataSourcePtr->AddOdometerObserver(&OdometerBuffer::Instance());
+    if (config.UseOdometer) {
+        system.dataSourcePtr->AddOdometerObserver(&OdometerBuffer::Instance());
+    }
+
+    if (config.MetricsInterval > 0) {
+        auto& reporter = system.metricsReporterPtr;
+        reporter = std::make_shared<MetricsReporter>(config.MetricsInterval);
+        if (!config.MetricsFile.empty()) {
+            reporter->AddExporter(
+                std::make_shared<MetricsFileExporter>(config.MetricsFile));
+        }
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+        if (!config.MetricsSocket.empty()) {
+            reporter->AddExporter(
+                std::make_shared<MetricsSocketExporter>(config.MetricsSocket));
+        }
+#endif
     }
 
     return true;
 }
 
-void StartAndJoin() {
-    if (Config::CameraCalibration) return;
+static void _Start(VioSystem& system) {
+    auto& config = Config::Instance();
 
     // Start all modules
-    if (Config::RunVIO) {
+    if (config.RunVIO) {
         LOGI("Start VIO");
-        vioModulePtr->Start();
+        system.vioModulePtr->Start();
     }
-    if (Config::RecordData) {
+    if (config.RecordData) {
         LOGI("Start Record Data\"");
-        dataRecorderPtr->Start();
+        system.dataRecorderPtr->Start();
     }
 #if ENABLE_VISUALIZER
-    if (!Config::NoGUI && slamVisualizerPtr) slamVisualizerPtr->Start();
+    if (!config.NoGUI && system.slamVisualizerPtr)
+        system.slamVisualizerPtr->Start();
 #endif
+    if (system.metricsReporterPtr) system.metricsReporterPtr->Start();
+    system.dataSourcePtr->Start();
+}
+
+static void _StartAndJoin(VioSystem& system) {
+    auto& config = Config::Instance();
+    if (config.CameraCalibration) return;
+    if (system.externalSourcePtr) {
+        LOGE("External data source is fed through the push API");
+        return;
+    }
+
+    _Start(system);
     // Join
-    dataSourcePtr->Start();
 #if USE_ROS2
-    if (Config::DataSourceType == DataSrcROS2) {
+    if (config.DataSourceType == DataSrcROS2) {
         rclcpp::spin(std::static_pointer_cast<rclcpp::Node>(
-            std::static_pointer_cast<DataSource_ROS2>(dataSourcePtr)));
-    } else if (Config::DataSourceType == DataSrcROS2_bag) {
+            std::static_pointer_cast<DataSource_ROS2>(system.dataSourcePtr)));
+    } else if (config.DataSourceType == DataSrcROS2_bag) {
         // rclcpp::spin(std::static_pointer_cast<rclcpp::Node>(
         //     std::static_pointer_cast<DataSource_ROS2_bag>(dataSourcePtr)));
     }
 #endif
 
-    dataSourcePtr->Join();
+    system.dataSourcePtr->Join();
+
+#if ENABLE_VISUALIZER
+    if (system.slamVisualizerPtr) system.slamVisualizerPtr->Join();
+#endif
+}
+
+static void _StopSystem(VioSystem& system) {
+    auto& config = Config::Instance();
+    if (config.CameraCalibration) return;
+    Profiler::Instance().OutputResult(config.ResultOutputPath + "/Time.txt");
+    Profiler::Instance().OutputResultConsole();
+    if (system.dataSourcePtr) system.dataSourcePtr->Stop();
+    if (config.RunVIO && system.vioModulePtr) system.vioModulePtr->Stop();
+    // exports the final values
+    if (system.metricsReporterPtr) system.metricsReporterPtr->Stop();
+    // after the modules stopped writing into their rings
+    if (config.ExportTrace)
+        Profiler::Instance().OutputTrace(config.ResultOutputPath +
+                                         "/trace.json");
+    // of the whole process, not only of this context
+    if (AllocTracker::Enabled())
+        AllocTracker::OutputResult(config.ResultOutputPath + "/Memory.txt");
+    LOGI("Peak RSS %ld MB", AllocTracker::PeakRssKb() / 1024);
+}
 
+// modules may use their context while shutting down, call it bound
+static void _ReleaseModules(VioSystem& system) {
+    system.dataSourcePtr.reset();
+    system.externalSourcePtr.reset();
+    system.vioModulePtr.reset();
+    system.dataRecorderPtr.reset();
+    system.metricsReporterPtr.reset();
 #if ENABLE_VISUALIZER
-    if (slamVisualizerPtr) slamVisualizerPtr->Join();
+    system.slamVisualizerPtr.reset();
+#elif ENABLE_VISUALIZER_TCP
+    system.tcpPtr.reset();
+#elif ENABLE_VISUALIZER_SHM
+    system.shmPtr.reset();
+#endif
+#if USE_ROS2
+    system.rosPtr.reset();
 #endif
 }
 
+bool InitSlamSystem(const char* configFile) {
+    // Init Log
+    logInit();
+
+    auto& system = _DefaultSystem();
+    VioContext::Scope scope(system.context);
+    return _InitSystem(system, configFile);
+}
+
+void StartAndJoin() {
+    auto& system = _DefaultSystem();
+    VioContext::Scope scope(system.context);
+    _StartAndJoin(system);
+}
+
 void StopSystem() {
 #if USE_ROS2
     rclcpp::shutdown();
 #endif
-    if (Config::CameraCalibration) return;
-    TickTock::outputResult(Config::ResultOutputPath + "/Time.txt");
-    dataSourcePtr->Stop();
-    if (Config::RunVIO) vioModulePtr->Stop();
+    auto& system = _DefaultSystem();
+    VioContext::Scope scope(system.context);
+    _StopSystem(system);
     finishLogging();
-}
\ No newline at end of file
+}
+
+// the log file of the system, once nothing logs into it anymore
+static void _DeleteSystem(VioSystem* system) {
+#if !USE_ROS2
+    if (system->log_file) {
+        Logger::SetContextFile(system->context, nullptr);
+        fclose(system->log_file);
+    }
+#endif
+    delete system;
+}
+
+VioHandle CreateSlamSystem(const char* configFile) {
+    return CreateSlamSystemEx(configFile, nullptr);
+}
+
+VioHandle CreateSlamSystemEx(const char* configFile,
+                             const VioSystemOptions* options) {
+    static std::once_flag log_once;
+    std::call_once(log_once, logInit);
+
+    auto* system = new VioSystem();
+    system->owned_context.reset(new VioContext());
+    system->context = system->owned_context.get();
+    if (options && options->log_file) {
+#if !USE_ROS2
+        system->log_file = fopen(options->log_file, "w");
+        if (!system->log_file) {
+            LOGE("Failed to open log file %s", options->log_file);
+            delete system;
+            return nullptr;
+        }
+        Logger::SetContextFile(system->context, system->log_file);
+#else
+        // rclcpp logs of all systems go to the same sinks
+        LOGW("log_file %s ignored with ROS2 logging", options->log_file);
+#endif
+    }
+    {
+        VioContext::Scope scope(system->context);
+        auto& config = Config::Instance();
+        if (options && options->data_source_path)
+            config.DataSourcePathOverride = options->data_source_path;
+        if (options && options->result_output_path)
+            config.ResultOutputPathOverride = options->result_output_path;
+        if (options && options->no_gui) config.NoGUIOverride = 1;
+        if (options && options->metrics_file)
+            config.MetricsFileOverride = options->metrics_file;
+        if (options && options->metrics_socket)
+            config.MetricsSocketOverride = options->metrics_socket;
+        if (options && options->shm_transport_name)
+            config.ShmTransportNameOverride = options->shm_transport_name;
+        try {
+            if (_InitSystem(*system, configFile)) return system;
+        } catch (const std::exception& e) {
+            LOGE("%s", e.what());
+        }
+        _ReleaseModules(*system);
+    }
+    _DeleteSystem(system);
+    return nullptr;
+}
+
+void StartAndJoinSlamSystem(VioHandle handle) {
+    if (!handle) return;
+    VioContext::Scope scope(handle->context);
+    _StartAndJoin(*handle);
+}
+
+void DestroySlamSystem(VioHandle handle) {
+    if (!handle) return;
+    {
+        VioContext::Scope scope(handle->context);
+        _StopSystem(*handle);
+        _ReleaseModules(*handle);
+    }
+    _DeleteSystem(handle);
+}
+
+bool StartSlamSystem(VioHandle handle) {
+    if (!handle || !handle->dataSourcePtr) return false;
+    VioContext::Scope scope(handle->context);
+    _Start(*handle);
+    return true;
+}
+
+void PushImu(VioHandle handle, long long timestamp, const float gyro[3],
+             const float acc[3]) {
+    if (!handle || !handle->externalSourcePtr) return;
+    VioContext::Scope scope(handle->context);
+    ImuData imuData;
+    imuData.timestamp = timestamp;
+    imuData.gyro = Vector3f(gyro[0], gyro[1], gyro[2]);
+    imuData.acc = Vector3f(acc[0], acc[1], acc[2]);
+    handle->externalSourcePtr->PushImu(imuData);
+}
+
+static bool _PushImage(VioHandle handle, long long timestamp,
+                       const unsigned char* left, const unsigned char* right,
+                       int width, int height, int stride,
+                       VioReleaseCallback release, void* user_data) {
+    if (!handle || !handle->externalSourcePtr) {
+        if (release) release(user_data);
+        return false;
+    }
+    VioContext::Scope scope(handle->context);
+    // the tracker assumes images of the calibrated size
+    auto cam = SensorConfig::Instance().GetCamModel(0);
+    if (!cam || width != cam->width() || height != cam->height() ||
+        stride < width) {
+        LOGW_EVERY_MS(1000, "Drop image %dx%d of stride %d", width, height,
+                      stride);
+        if (release) release(user_data);
+        return false;
+    }
+    // the tracker also assumes continuous rows, padded images are copied
+    const bool padded = stride != width;
+    ImageData::Ptr imageData;
+    if (padded) {
+        imageData = std::make_shared<ImageData>();
+    } else {
+        // headers on the borrowed memory, the owner is told once the last
+        // reference to the frame is gone
+        auto deleter = [release, user_data](ImageData* p) {
+            delete p;
+            if (release) release(user_data);
+        };
+        imageData.reset(new ImageData(), deleter);
+    }
+    imageData->timestamp = timestamp;
+    imageData->image =
+        cv::Mat(height, width, CV_8UC1, const_cast<uchar*>(left), stride);
+    if (right) {
+        imageData->right_image =
+            cv::Mat(height, width, CV_8UC1, const_cast<uchar*>(right), stride);
+    }
+    if (padded) {
+        imageData->image = imageData->image.clone();
+        if (right) imageData->right_image = imageData->right_image.clone();
+        if (release) release(user_data);
+    }
+    handle->externalSourcePtr->PushImage(imageData);
+    return true;
+}
+
+bool PushImage(VioHandle handle, long long timestamp, const unsigned char* data,
+               int width, int height, int stride, VioReleaseCallback release,
+               void* user_data) {
+    return _PushImage(handle, timestamp, data, nullptr, width, height, stride,
+                      release, user_data);
+}
+
+bool PushStereoImage(VioHandle handle, long long timestamp,
+                     const unsigned char* left, const unsigned char* right,
+                     int width, int height, int stride,
+                     VioReleaseCallback release, void* user_data) {
+    return _PushImage(handle, timestamp, left, right, width, height, stride,
+                      release, user_data);
+}
+
+void PushOdometer(VioHandle handle, long long timestamp, float velocity,
+                  float angular_velocity) {
+    if (!handle || !handle->externalSourcePtr) return;
+    VioContext::Scope scope(handle->context);
+    OdometerData odometerData;
+    odometerData.timestamp = timestamp;
+    odometerData.velocity = velocity;
+    odometerData.angularVelocity = angular_velocity;
+    handle->externalSourcePtr->PushOdometer(odometerData);
+}
+
+bool GetLatestPose(VioHandle handle, VioPose* pose) {
+    if (!handle || !pose) return false;
+    auto& listener = handle->pose_listener;
+    std::lock_guard<std::mutex> lck(listener.mtx);
+    if (!listener.valid) return false;
+    *pose = listener.latest;
+    return true;
+}
+
+void SetPoseCallback(VioHandle handle, VioPoseCallback callback,
+                     void* user_data) {
+    if (!handle) return;
+    auto& listener = handle->pose_listener;
+    std::lock_guard<std::mutex> lck(listener.mtx);
+    listener.callback = callback;
+    listener.user_data = user_data;
+}
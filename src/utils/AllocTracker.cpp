@@ -0,0 +1,256 @@
+#include "utils/AllocTracker.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "precompile.h"
+#include "utils/Profiler.h"
+
+#if ENABLE_ALLOC_TRACKING
+#ifndef __GLIBC__
+#error "ENABLE_ALLOC_TRACKING replaces the glibc allocator"
+#endif
+#include <malloc.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+
+// the glibc allocator under the replaced symbols
+extern "C" {
+void* __libc_malloc(size_t size);
+void* __libc_memalign(size_t alignment, size_t size);
+void __libc_free(void* ptr);
+}
+#endif
+
+namespace DeltaVins {
+
+namespace {
+
+// slot 0 collects what is allocated outside of any section
+constexpr int NUM_SLOTS = Profiler::MAX_SECTIONS + 1;
+
+// one cache line each, threads in different sections do not contend
+struct alignas(64) Slot {
+    std::atomic<uint64_t> allocations;
+    std::atomic<uint64_t> allocated_bytes;
+    std::atomic<int64_t> live_blocks;
+    std::atomic<int64_t> live_bytes;
+};
+
+// zero initialized before any constructor runs, malloc may come first
+Slot g_slots[NUM_SLOTS];
+std::atomic<uint64_t> g_allocations;
+std::atomic<int64_t> g_live_bytes;
+
+// initial-exec, so the first access allocates no TLS block
+__attribute__((tls_model("initial-exec"))) thread_local int t_slot = 0;
+__attribute__((tls_model("initial-exec"))) thread_local uint64_t
+    t_allocations = 0;
+
+#if ENABLE_ALLOC_TRACKING
+// right before every block, keeps it 16 byte aligned
+struct alignas(16) BlockHeader {
+    uint64_t size;
+    uint32_t offset;  // of the block from what glibc returned
+    int32_t slot;
+};
+static_assert(sizeof(BlockHeader) == 16, "header has to keep the alignment");
+
+// glibc blocks are 16 byte aligned, larger alignments shift by a whole one
+void* _Allocate(size_t size, size_t alignment) {
+    const size_t offset = std::max(alignment, sizeof(BlockHeader));
+    if (size > SIZE_MAX - offset) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    char* raw = static_cast<char*>(
+        alignment <= sizeof(BlockHeader) ? __libc_malloc(size + offset)
+                                         : __libc_memalign(alignment,
+                                                           size + offset));
+    if (!raw) return nullptr;
+
+    char* ptr = raw + offset;
+    BlockHeader* header = reinterpret_cast<BlockHeader*>(ptr) - 1;
+    header->size = size;
+    header->offset = static_cast<uint32_t>(offset);
+    header->slot = t_slot;
+
+    Slot& slot = g_slots[header->slot];
+    slot.allocations.fetch_add(1, std::memory_order_relaxed);
+    slot.allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    slot.live_blocks.fetch_add(1, std::memory_order_relaxed);
+    slot.live_bytes.fetch_add(size, std::memory_order_relaxed);
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    g_live_bytes.fetch_add(size, std::memory_order_relaxed);
+    ++t_allocations;
+    return ptr;
+}
+
+BlockHeader* _Header(void* ptr) {
+    return static_cast<BlockHeader*>(ptr) - 1;
+}
+
+// credited to the section which allocated the block
+void _Free(void* ptr) {
+    if (!ptr) return;
+    BlockHeader* header = _Header(ptr);
+    Slot& slot = g_slots[header->slot];
+    slot.live_blocks.fetch_sub(1, std::memory_order_relaxed);
+    slot.live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    g_live_bytes.fetch_sub(header->size, std::memory_order_relaxed);
+    __libc_free(static_cast<char*>(ptr) - header->offset);
+}
+
+bool _ValidAlignment(size_t alignment) {
+    return alignment && !(alignment & (alignment - 1));
+}
+#endif
+
+}  // namespace
+
+int AllocTracker::SwapSection(int section) {
+    const int previous = t_slot - 1;
+    t_slot = section >= 0 && section < Profiler::MAX_SECTIONS ? section + 1
+                                                             : 0;
+    return previous;
+}
+
+uint64_t AllocTracker::Allocations() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+int64_t AllocTracker::LiveBytes() {
+    return g_live_bytes.load(std::memory_order_relaxed);
+}
+
+uint64_t AllocTracker::TakeThreadAllocations() {
+    const uint64_t allocations = t_allocations;
+    t_allocations = 0;
+    return allocations;
+}
+
+std::vector<AllocTracker::Stats> AllocTracker::Collect() {
+    std::vector<Stats> result;
+    for (int i = 0; i < NUM_SLOTS; ++i) {
+        const Slot& slot = g_slots[i];
+        Stats stats;
+        stats.allocations = slot.allocations.load(std::memory_order_relaxed);
+        if (!stats.allocations) continue;
+        stats.name = i ? Profiler::SectionName(i - 1) : "Other";
+        stats.allocated_bytes =
+            slot.allocated_bytes.load(std::memory_order_relaxed);
+        stats.live_blocks = slot.live_blocks.load(std::memory_order_relaxed);
+        stats.live_bytes = slot.live_bytes.load(std::memory_order_relaxed);
+        result.push_back(stats);
+    }
+    std::stable_sort(result.begin(), result.end(),
+                     [](const Stats& a, const Stats& b) {
+                         return a.live_bytes > b.live_bytes;
+                     });
+    return result;
+}
+
+long AllocTracker::PeakRssKb() {
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage)) return 0;
+    return usage.ru_maxrss;  // kB on Linux
+}
+
+bool AllocTracker::OutputResult(const std::string& output_file) {
+    FILE* fout = fopen(output_file.c_str(), "w");
+    if (!fout) {
+        LOGE("Cannot open file %s", output_file.c_str());
+        return false;
+    }
+    fprintf(fout, "#peak_rss_kb: %ld\n", PeakRssKb());
+    fprintf(fout, "section,allocations,allocated_bytes,live_blocks,"
+                  "live_bytes\n");
+    for (auto& s : Collect()) {
+        fprintf(fout, "%s,%llu,%llu,%lld,%lld\n", s.name.c_str(),
+                static_cast<unsigned long long>(s.allocations),
+                static_cast<unsigned long long>(s.allocated_bytes),
+                static_cast<long long>(s.live_blocks),
+                static_cast<long long>(s.live_bytes));
+    }
+    fclose(fout);
+    return true;
+}
+
+}  // namespace DeltaVins
+
+#if ENABLE_ALLOC_TRACKING
+// the whole malloc family, so no block of glibc is handed to our free
+extern "C" {
+
+void* malloc(size_t size) { return DeltaVins::_Allocate(size, 16); }
+
+void free(void* ptr) { DeltaVins::_Free(ptr); }
+
+void* calloc(size_t num, size_t size) {
+    if (size && num > SIZE_MAX / size) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    void* ptr = DeltaVins::_Allocate(num * size, 16);
+    if (ptr) memset(ptr, 0, num * size);
+    return ptr;
+}
+
+// always moves, the new block belongs to the current section
+void* realloc(void* ptr, size_t size) {
+    if (!ptr) return malloc(size);
+    if (!size) {
+        free(ptr);
+        return nullptr;
+    }
+    void* moved = DeltaVins::_Allocate(size, 16);
+    if (!moved) return nullptr;
+    memcpy(moved, ptr, std::min<size_t>(size, DeltaVins::_Header(ptr)->size));
+    free(ptr);
+    return moved;
+}
+
+void* memalign(size_t alignment, size_t size) {
+    if (!DeltaVins::_ValidAlignment(alignment)) {
+        errno = EINVAL;
+        return nullptr;
+    }
+    return DeltaVins::_Allocate(size, alignment);
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    return memalign(alignment, size);
+}
+
+int posix_memalign(void** ptr, size_t alignment, size_t size) {
+    if (!DeltaVins::_ValidAlignment(alignment) ||
+        alignment % sizeof(void*)) {
+        return EINVAL;
+    }
+    void* block = DeltaVins::_Allocate(size, alignment);
+    if (!block) return ENOMEM;
+    *ptr = block;
+    return 0;
+}
+
+void* valloc(size_t size) { return memalign(sysconf(_SC_PAGESIZE), size); }
+
+void* pvalloc(size_t size) {
+    const size_t page = sysconf(_SC_PAGESIZE);
+    if (size > SIZE_MAX - page) {
+        errno = ENOMEM;
+        return nullptr;
+    }
+    return memalign(page, (size + page - 1) / page * page);
+}
+
+size_t malloc_usable_size(void* ptr) {
+    return ptr ? DeltaVins::_Header(ptr)->size : 0;
+}
+
+}  // extern "C"
+#endif
@@ -27,40 +27,6 @@ using namespace std;
 using namespace cv;
 
 namespace DeltaVins {
-int Config::DataSourceType;
-string Config::DataSourcePath;
-int Config::SerialRun;
-int Config::ImageStartIdx;
-
-float Config::ExposureTime;
-float Config::Gain;
-
-string Config::CalibrationPath;
-string Config::outputFileName;
-string Config::ResultOutputPath;
-
-string Config::DataSourceConfigFilePath;
-int Config::CameraCalibration;
-int Config::NoDebugOutput;
-int Config::NoResultOutput;
-int Config::NoGUI;
-int Config::MaxRunFPS;
-int Config::RecordData;
-int Config::RecordIMU;
-int Config::RecordImage;
-int Config::UploadImage;
-int Config::RunVIO;
-int Config::PlaneConstraint;
-ResultOutputFormat Config::OutputFormat;
-string Config::VisualizerServerIP;
-int Config::MaxNumToTrack;
-int Config::MaskSize;
-bool Config::UseGnss;
-bool Config::UseStereo;
-bool Config::UseOdometer;
-bool Config::UseBackTracking;
-std::vector<ROS2SensorTopic> Config::ROS2SensorTopics;
-int Config::FastScoreThreshold;
 
 bool Config::loadConfigFile(const std::string& configFile) {
     _clear();
@@ -101,13 +67,17 @@ bool Config::loadConfigFile(const std::string& configFile) {
     string temp;
     PlaneConstraint = false;
     data_source_config_file_cv["DataSourceType"] >> temp;
+    if (temp == "External")
+        DataSourceType = DataSrcExternal;
 #ifndef USE_ROS2
-    if (temp == "EUROC" || temp == "Euroc")
+    else if (temp == "EUROC" || temp == "Euroc")
         DataSourceType = DataSrcEuroc;
     else if (temp == "Synthetic")
         DataSourceType = DataSrcSynthetic;
+    else if (temp == "Binary")
+        DataSourceType = DataSrcBinary;
 #else
-    if (temp == "ROS2")
+    else if (temp == "ROS2")
         DataSourceType = DataSrcROS2;
     else if (temp == "ROS2_bag") {
         DataSourceType = DataSrcROS2_bag;
@@ -117,6 +87,7 @@ bool Config::loadConfigFile(const std::string& configFile) {
         throw std::runtime_error("Unknown DataSource:" + temp);
 
     data_source_config_file_cv["DataSourcePath"] >> DataSourcePath;
+    if (!DataSourcePathOverride.empty()) DataSourcePath = DataSourcePathOverride;
 
     // GyroNoise2 = GyroNoise2 * (GyroNoise2 * nImuSample);
     // AccNoise2 = AccNoise2 * (AccNoise2 * nImuSample);
@@ -125,10 +96,30 @@ bool Config::loadConfigFile(const std::string& configFile) {
     // ImageNoise2 = ImageNoise2 * ImageNoise2;
 
     data_source_config_file_cv["ImageStartIdx"] >> ImageStartIdx;
+    data_source_config_file_cv["ImageReadAhead"] >> ImageReadAhead;
+    data_source_config_file_cv["ImageLoaderThreads"] >> ImageLoaderThreads;
+    data_source_config_file_cv["PlaybackRate"] >> PlaybackRate;
+    if (ImageReadAhead <= 0) ImageReadAhead = 8;
+    if (ImageLoaderThreads <= 0) ImageLoaderThreads = 2;
     config_file_cv["SerialRun"] >> SerialRun;
+    config_file_cv["DeterministicReplay"] >> DeterministicReplay;
     config_file_cv["NoGUI"] >> NoGUI;
+    if (NoGUIOverride) NoGUI = 1;
     config_file_cv["NoDebugOutput"] >> NoDebugOutput;
     config_file_cv["MaxRunFPS"] >> MaxRunFPS;
+    config_file_cv["ImuRatePose"] >> ImuRatePose;
+    if (!config_file_cv["LogLevel"].empty())
+        config_file_cv["LogLevel"] >> LogLevel;
+    config_file_cv["ExportTrace"] >> ExportTrace;
+    config_file_cv["PerfCounters"] >> PerfCounters;
+    config_file_cv["Telemetry"] >> Telemetry;
+    config_file_cv["MetricsInterval"] >> MetricsInterval;
+    config_file_cv["MetricsFile"] >> MetricsFile;
+    config_file_cv["MetricsSocket"] >> MetricsSocket;
+    if (!MetricsFile.empty() && !MetricsFileOverride.empty())
+        MetricsFile = MetricsFileOverride;
+    if (!MetricsSocket.empty() && !MetricsSocketOverride.empty())
+        MetricsSocket = MetricsSocketOverride;
     config_file_cv["RecordImu"] >> RecordIMU;
     config_file_cv["RecordImage"] >> RecordImage;
     config_file_cv["NoResultOutput"] >> NoResultOutput;
@@ -137,8 +128,16 @@ bool Config::loadConfigFile(const std::string& configFile) {
     config_file_cv["CameraCalibration"] >> CameraCalibration;
     config_file_cv["VisualizerServerIP"] >> VisualizerServerIP;
     config_file_cv["UploadImage"] >> UploadImage;
+    if (!config_file_cv["VisualizerFPS"].empty())
+        config_file_cv["VisualizerFPS"] >> VisualizerFPS;
+    if (!config_file_cv["ShmTransportName"].empty())
+        config_file_cv["ShmTransportName"] >> ShmTransportName;
+    if (!ShmTransportNameOverride.empty())
+        ShmTransportName = ShmTransportNameOverride;
     config_file_cv["RunVIO"] >> RunVIO;
     config_file_cv["ResultOutputPath"] >> ResultOutputPath;
+    if (!ResultOutputPathOverride.empty())
+        ResultOutputPath = ResultOutputPathOverride;
     config_file_cv["ResultOutputName"] >> outputFileName;
     config_file_cv["MaxNumToTrack"] >> MaxNumToTrack;
     config_file_cv["MaskSize"] >> MaskSize;
@@ -198,9 +197,9 @@ bool Config::loadConfigFile(const std::string& configFile) {
             }
             (*it)["TopicQueueSize"] >> topic.queue_size;
 
-            if ((topic.type == ROS2SensorType::GNSS && !Config::UseGnss) ||
+            if ((topic.type == ROS2SensorType::GNSS && !UseGnss) ||
                 (topic.type == ROS2SensorType::ODOMETER &&
-                 !Config::UseOdometer)) {
+                 !UseOdometer)) {
                 continue;
             }
 
@@ -218,6 +217,9 @@ bool Config::loadConfigFile(const std::string& configFile) {
     } else if (temp == "EUROC") {
         OutputFormat = ResultOutputFormat::EUROC;
         outputFileName += ".euroc";
+    } else if (temp == "BINARY") {
+        OutputFormat = ResultOutputFormat::BINARY;
+        outputFileName += ".bin";
     } else {
         throw std::runtime_error("Unknown ResultOutputFormat: " + temp);
     }
@@ -226,6 +228,14 @@ bool Config::loadConfigFile(const std::string& configFile) {
         SerialRun = 1;  // run in serial mode if data source is ROS2_bag
     }
 
+    if (DeterministicReplay) {
+        // no wall clock may influence which data the pipeline sees
+        SerialRun = 1;
+        MaxRunFPS = 0;
+        PlaybackRate = 0.f;
+        LOGI("Deterministic replay, run as fast as the pipeline consumes");
+    }
+
     return true;
 }
 
@@ -238,8 +248,22 @@ void Config::_clear() {
     Gain = 1.0f;
     CameraCalibration = 0;
     UploadImage = 0;
+    VisualizerFPS = 10;
+    ShmTransportName = "/deltavins";
     RunVIO = 0;
     PlaneConstraint = 0;
+    DeterministicReplay = 0;
+    ImuRatePose = 0;
+    LogLevel = 1;
+    ExportTrace = 0;
+    PerfCounters = 0;
+    Telemetry = 0;
+    MetricsInterval = 0;
+    MetricsFile.clear();
+    MetricsSocket.clear();
+    ImageReadAhead = 0;
+    ImageLoaderThreads = 0;
+    PlaybackRate = 0.f;
 }
 
 #if 0
@@ -0,0 +1,106 @@
+#include "utils/CsvReader.h"
+
+#include <charconv>
+#include <cstring>
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+CsvReader::CsvReader(const std::string& path, char delimiter,
+                     size_t block_size)
+    : delimiter_(delimiter), buffer_(block_size + 1) {
+    file_ = fopen(path.c_str(), "rb");
+}
+
+CsvReader::~CsvReader() {
+    if (file_) fclose(file_);
+}
+
+bool CsvReader::_FillBuffer() {
+    if (eof_) return false;
+    // move the incomplete line to the front and read behind it
+    size_t left = end_ - begin_;
+    if (left == buffer_.size() - 1) {
+        // a single line is larger than the buffer
+        buffer_.resize(buffer_.size() * 2);
+    }
+    memmove(buffer_.data(), buffer_.data() + begin_, left);
+    begin_ = 0;
+    end_ = left;
+    size_t n = fread(buffer_.data() + end_, 1, buffer_.size() - 1 - end_, file_);
+    end_ += n;
+    buffer_[end_] = '\0';
+    if (n == 0) eof_ = true;
+    return n > 0;
+}
+
+bool CsvReader::NextRow() {
+    if (!file_) return false;
+    while (true) {
+        char* data = buffer_.data();
+        char* line = data + begin_;
+        char* newline =
+            static_cast<char*>(memchr(line, '\n', end_ - begin_));
+        if (!newline) {
+            if (_FillBuffer()) continue;
+            // last line without line break
+            if (begin_ == end_) return false;
+            newline = data + end_;
+        }
+        begin_ = std::min<size_t>(newline - data + 1, end_);
+
+        char* line_end = newline;
+        if (line_end > line && line_end[-1] == '\r') --line_end;
+        const char* first = line;
+        while (first < line_end && (*first == ' ' || *first == '\t')) ++first;
+        if (first == line_end || line[0] == '#') continue;
+
+        num_fields_ = 0;
+        const char* field = line;
+        for (const char* p = line; num_fields_ < MAX_FIELDS; ++p) {
+            if (p == line_end || *p == delimiter_) {
+                fields_[num_fields_] = field;
+                field_sizes_[num_fields_++] = p - field;
+                if (p == line_end) break;
+                field = p + 1;
+            }
+        }
+        return true;
+    }
+}
+
+int64_t CsvReader::GetInt64(int i) const {
+    const char* first = fields_[i];
+    const char* last = first + field_sizes_[i];
+    while (first < last && *first == ' ') ++first;
+    int64_t value = 0;
+    std::from_chars(first, last, value);
+    return value;
+}
+
+bool CsvReader::GetInt64(int i, int64_t& value) const {
+    if (i >= num_fields_) return false;
+    const char* first = fields_[i];
+    const char* last = first + field_sizes_[i];
+    while (first < last && *first == ' ') ++first;
+    while (last > first && last[-1] == ' ') --last;
+    auto result = std::from_chars(first, last, value);
+    return result.ec == std::errc() && result.ptr == last;
+}
+
+float CsvReader::GetFloat(int i) const {
+    const char* first = fields_[i];
+    const char* last = first + field_sizes_[i];
+    while (first < last && *first == ' ') ++first;
+    float value = 0.f;
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    std::from_chars(first, last, value);
+#else
+    // strtof stops at the delimiter, the buffer is always terminated
+    value = strtof(first, nullptr);
+#endif
+    return value;
+}
+
+}  // namespace DeltaVins
@@ -0,0 +1,87 @@
+#include "utils/Metrics.h"
+
+#include <mutex>
+
+#include "framework/VioContext.h"
+#include "precompile.h"
+
+namespace DeltaVins {
+
+namespace {
+// names are shared by all contexts
+struct MetricNames {
+    std::mutex mtx;
+    std::atomic<int> size{0};
+    std::string names[Metrics::MAX_METRICS];
+    std::string helps[Metrics::MAX_METRICS];
+    Metrics::Type types[Metrics::MAX_METRICS];
+};
+
+MetricNames& _MetricNames() {
+    static MetricNames* names = new MetricNames();  // used up to exit
+    return *names;
+}
+}  // namespace
+
+Metrics& Metrics::Instance() { return VioContext::Current().GetMetrics(); }
+
+int Metrics::Register(const char* name, Type type, const char* help) {
+    auto& names = _MetricNames();
+    std::lock_guard<std::mutex> lck(names.mtx);
+    const int size = names.size.load(std::memory_order_relaxed);
+    for (int i = 0; i < size; ++i) {
+        if (names.names[i] == name) return i;
+    }
+    if (size == MAX_METRICS) {
+        LOGW("Metrics are full, %s is not exported", name);
+        return -1;
+    }
+    names.names[size] = name;
+    names.helps[size] = help;
+    names.types[size] = type;
+    names.size.store(size + 1, std::memory_order_release);
+    return size;
+}
+
+void Metrics::Add(int metric, double value) {
+    if (metric < 0 || metric >= MAX_METRICS) return;
+    auto& slot = slots_[metric];
+    double current = slot.value.load(std::memory_order_relaxed);
+    while (!slot.value.compare_exchange_weak(current, current + value,
+                                             std::memory_order_relaxed)) {
+    }
+    if (!slot.updated.load(std::memory_order_relaxed))
+        slot.updated.store(true, std::memory_order_relaxed);
+}
+
+void Metrics::Set(int metric, double value) {
+    if (metric < 0 || metric >= MAX_METRICS) return;
+    auto& slot = slots_[metric];
+    slot.value.store(value, std::memory_order_relaxed);
+    if (!slot.updated.load(std::memory_order_relaxed))
+        slot.updated.store(true, std::memory_order_relaxed);
+}
+
+std::vector<Metrics::Sample> Metrics::Collect() const {
+    auto& names = _MetricNames();
+    const int size = names.size.load(std::memory_order_acquire);
+    std::vector<Sample> result;
+    for (int i = 0; i < size; ++i) {
+        const auto& slot = slots_[i];
+        if (!slot.updated.load(std::memory_order_relaxed)) continue;
+        result.push_back({names.names[i], names.helps[i], names.types[i],
+                          slot.value.load(std::memory_order_relaxed)});
+    }
+    return result;
+}
+
+bool Metrics::Get(const char* name, double& value) const {
+    for (auto& sample : Collect()) {
+        if (sample.name != name) continue;
+        value = sample.value;
+        return true;
+    }
+    return false;
+}
+
+}  // namespace DeltaVins
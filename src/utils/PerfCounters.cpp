@@ -0,0 +1,96 @@
+#include "utils/PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "precompile.h"
+
+namespace DeltaVins {
+
+#ifdef __linux__
+namespace {
+
+constexpr int NUM_COUNTERS = 4;
+constexpr uint64_t COUNTER_CONFIGS[NUM_COUNTERS] = {
+    PERF_COUNT_HW_CPU_CYCLES, PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+int _PerfEventOpen(uint64_t config, int group_fd) {
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP;
+    // the leader starts the whole group
+    attr.disabled = group_fd < 0;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+// the group of one thread, closed when the thread exits
+struct ThreadCounters {
+    ThreadCounters() {
+        for (int i = 0; i < NUM_COUNTERS; ++i) {
+            fds[i] = _PerfEventOpen(COUNTER_CONFIGS[i], fds[0]);
+            if (fds[i] >= 0) {
+                slots[i] = num_open++;
+            } else if (i == 0) {
+                static std::once_flag warn_once;
+                const int error = errno;
+                std::call_once(warn_once, [error]() {
+                    LOGW("perf_event_open failed: %s, no hardware counters",
+                         strerror(error));
+                });
+                return;
+            }
+        }
+        ioctl(fds[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(fds[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+
+    ~ThreadCounters() {
+        for (int fd : fds) {
+            if (fd >= 0) close(fd);
+        }
+    }
+
+    int fds[NUM_COUNTERS] = {-1, -1, -1, -1};
+    int slots[NUM_COUNTERS] = {-1, -1, -1, -1};  // in the group read
+    int num_open = 0;
+};
+
+}  // namespace
+
+bool PerfCounters::Read(Values& values) {
+    thread_local ThreadCounters counters;
+    if (counters.fds[0] < 0) return false;
+
+    // number of counters, then their values in the order they were opened
+    uint64_t buffer[1 + NUM_COUNTERS];
+    if (read(counters.fds[0], buffer, sizeof(buffer)) <= 0) return false;
+    uint64_t* fields[NUM_COUNTERS] = {&values.cycles, &values.instructions,
+                                      &values.cache_misses,
+                                      &values.branch_misses};
+    for (int i = 0; i < NUM_COUNTERS; ++i) {
+        const int slot = counters.slots[i];
+        *fields[i] = slot >= 0 ? buffer[1 + slot] : 0;
+    }
+    return true;
+}
+#else
+bool PerfCounters::Read(Values& values) {
+    (void)values;
+    return false;
+}
+#endif
+
+}  // namespace DeltaVins
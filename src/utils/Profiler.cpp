@@ -0,0 +1,468 @@
+#include "utils/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "framework/VioContext.h"
+#include "precompile.h"
+
+namespace DeltaVins {
+
+namespace {
+// 8 buckets per power of two, values below 8 ns get one bucket each
+constexpr int SUB_BITS = 3;
+constexpr int SUB_BUCKETS = 1 << SUB_BITS;
+constexpr int MAX_EXPONENT = 42;  // about 73 minutes
+constexpr int NUM_BUCKETS = (MAX_EXPONENT - SUB_BITS + 2) * SUB_BUCKETS;
+
+int _BucketOf(uint64_t ns) {
+    if (ns < SUB_BUCKETS) return static_cast<int>(ns);
+    const int exponent = std::min(63 - __builtin_clzll(ns), MAX_EXPONENT);
+    const int sub = (ns >> (exponent - SUB_BITS)) & (SUB_BUCKETS - 1);
+    return (exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+}
+
+// middle of the range of values falling into the bucket
+double _BucketValue(int bucket) {
+    if (bucket < SUB_BUCKETS) return bucket;
+    const int exponent = bucket / SUB_BUCKETS + SUB_BITS - 1;
+    const int sub = bucket % SUB_BUCKETS;
+    const double width = std::ldexp(1.0, exponent - SUB_BITS);
+    return std::ldexp(1.0, exponent) + (sub + 0.5) * width;
+}
+
+// only the owning thread writes, so load and store need no atomic add
+template <typename T>
+void _Add(std::atomic<T>& counter, T value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value,
+                  std::memory_order_relaxed);
+}
+
+// section names are shared by all contexts
+struct SectionNames {
+    std::mutex mtx;
+    std::atomic<int> size{0};
+    std::string names[Profiler::MAX_SECTIONS];
+};
+
+SectionNames& _SectionNames() {
+    static SectionNames* names = new SectionNames();  // used up to exit
+    return *names;
+}
+
+std::atomic<uint64_t> g_next_serial{0};
+
+// names are identifiers or type names, quotes only for safety
+std::string _JsonString(const std::string& s) {
+    std::string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        out += c;
+    }
+    return out + "\"";
+}
+
+void _LogCounters(const PerfCounters::Values& c) {
+    LOGI("    per call: %llu cycles, %.2f IPC, %llu cache misses, "
+         "%llu branch misses",
+         static_cast<unsigned long long>(c.cycles),
+         c.cycles ? double(c.instructions) / c.cycles : 0.0,
+         static_cast<unsigned long long>(c.cache_misses),
+         static_cast<unsigned long long>(c.branch_misses));
+}
+}  // namespace
+
+struct Profiler::ThreadBlock {
+    struct Histogram {
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> total_ns{0};
+        std::atomic<uint64_t> max_ns{0};
+        std::atomic<uint32_t> buckets[NUM_BUCKETS] = {};
+        int64_t untaken_ns = 0;  // owning thread only, see TakeThreadTotal
+        // sums of the hardware counters over counted calls
+        std::atomic<uint64_t> counted{0};
+        std::atomic<uint64_t> cycles{0};
+        std::atomic<uint64_t> instructions{0};
+        std::atomic<uint64_t> cache_misses{0};
+        std::atomic<uint64_t> branch_misses{0};
+        PerfCounters::Values untaken_counters;  // owning thread only
+    };
+    struct TraceEvent {
+        int32_t section;
+        bool counter;
+        int64_t ts_ns;
+        int64_t value;  // duration of spans, value of counters
+    };
+
+    std::thread::id thread;
+    std::string name;  // guarded by mtx_blocks_
+    // Reset() generation the sections were cleared for, by the owner
+    std::atomic<uint64_t> generation{0};
+    Histogram sections[MAX_SECTIONS];
+
+    // ring of the latest events, written by the owning thread only
+    std::unique_ptr<TraceEvent[]> events;
+    size_t capacity = 0;
+    std::atomic<uint64_t> num_events{0};
+};
+
+Profiler::Profiler()
+    : serial_(++g_next_serial), origin_ns_(ProfileScope::Now()) {}
+
+Profiler::~Profiler() = default;
+
+Profiler& Profiler::Instance() { return VioContext::Current().GetProfiler(); }
+
+int Profiler::Register(const char* name) {
+    auto& names = _SectionNames();
+    std::lock_guard<std::mutex> lck(names.mtx);
+    const int size = names.size.load(std::memory_order_relaxed);
+    for (int i = 0; i < size; ++i) {
+        if (names.names[i] == name) return i;
+    }
+    if (size == MAX_SECTIONS) {
+        LOGW("Profiler is full, section %s is not recorded", name);
+        return -1;
+    }
+    names.names[size] = name;
+    names.size.store(size + 1, std::memory_order_release);
+    return size;
+}
+
+std::string Profiler::SectionName(int section) {
+    auto& names = _SectionNames();
+    // names are written once, before size is published
+    if (section < 0 || section >= names.size.load(std::memory_order_acquire))
+        return std::string();
+    return names.names[section];
+}
+
+Profiler::ThreadBlock& Profiler::_ThreadBlock() {
+#if ENABLE_ALLOC_TRACKING
+    // the blocks are the profiler's, not the heap of the section recorded
+    const int alloc_section = AllocTracker::SwapSection(-1);
+#endif
+    struct Cached {
+        uint64_t serial = 0;
+        std::shared_ptr<ThreadBlock> block;
+    };
+    thread_local Cached cached;
+    if (cached.serial != serial_) {
+        // first record since the thread switched contexts
+        const auto thread = std::this_thread::get_id();
+        std::lock_guard<std::mutex> lck(mtx_blocks_);
+        auto it = std::find_if(blocks_.begin(), blocks_.end(),
+                               [&](const std::shared_ptr<ThreadBlock>& b) {
+                                   return b->thread == thread;
+                               });
+        if (it == blocks_.end()) {
+            auto block = std::make_shared<ThreadBlock>();
+            block->thread = thread;
+            if (trace_capacity_) {
+                block->events.reset(
+                    new ThreadBlock::TraceEvent[trace_capacity_]);
+                block->capacity = trace_capacity_;
+            }
+            blocks_.push_back(block);
+            it = blocks_.end() - 1;
+        }
+        cached.block = *it;
+        cached.serial = serial_;
+    }
+    auto& block = *cached.block;
+    const uint64_t generation = generation_.load(std::memory_order_acquire);
+    if (block.generation.load(std::memory_order_relaxed) != generation)
+        _ClearBlock(block, generation);
+#if ENABLE_ALLOC_TRACKING
+    AllocTracker::SwapSection(alloc_section);
+#endif
+    return block;
+}
+
+void Profiler::_ClearBlock(ThreadBlock& block, uint64_t generation) {
+    for (auto& histogram : block.sections) {
+        histogram.count.store(0, std::memory_order_relaxed);
+        histogram.total_ns.store(0, std::memory_order_relaxed);
+        histogram.max_ns.store(0, std::memory_order_relaxed);
+        histogram.counted.store(0, std::memory_order_relaxed);
+        histogram.cycles.store(0, std::memory_order_relaxed);
+        histogram.instructions.store(0, std::memory_order_relaxed);
+        histogram.cache_misses.store(0, std::memory_order_relaxed);
+        histogram.branch_misses.store(0, std::memory_order_relaxed);
+        for (auto& bucket : histogram.buckets)
+            bucket.store(0, std::memory_order_relaxed);
+        histogram.untaken_ns = 0;
+        histogram.untaken_counters = PerfCounters::Values();
+    }
+    // Collect() skips the block until it is cleared
+    block.generation.store(generation, std::memory_order_release);
+}
+
+void Profiler::Record(int section, int64_t duration_ns) {
+    if (section < 0 || section >= MAX_SECTIONS) return;
+    const uint64_t ns = std::max<int64_t>(duration_ns, 0);
+    auto& block = _ThreadBlock();
+    auto& histogram = block.sections[section];
+    _Add<uint32_t>(histogram.buckets[_BucketOf(ns)], 1);
+    _Add<uint64_t>(histogram.total_ns, ns);
+    histogram.untaken_ns += ns;
+    if (ns > histogram.max_ns.load(std::memory_order_relaxed))
+        histogram.max_ns.store(ns, std::memory_order_relaxed);
+    // last, so a reader seeing the count sees the buckets mostly complete
+    _Add<uint64_t>(histogram.count, 1);
+}
+
+int64_t Profiler::TakeThreadTotal(int section) {
+    if (section < 0 || section >= MAX_SECTIONS) return 0;
+    auto& histogram = _ThreadBlock().sections[section];
+    const int64_t total = histogram.untaken_ns;
+    histogram.untaken_ns = 0;
+    return total;
+}
+
+void Profiler::_Record(int section, int64_t begin_ns, int64_t duration_ns) {
+    Record(section, duration_ns);
+    if (section < 0 || !TraceEnabled()) return;
+    _Trace(_ThreadBlock(), section, false, begin_ns, duration_ns);
+}
+
+void Profiler::Record(int section, int64_t begin_ns, int64_t end_ns,
+                      const PerfCounters::Values& counters) {
+    _Record(section, begin_ns, end_ns - begin_ns);
+    if (section < 0 || section >= MAX_SECTIONS) return;
+    auto& histogram = _ThreadBlock().sections[section];
+    _Add<uint64_t>(histogram.cycles, counters.cycles);
+    _Add<uint64_t>(histogram.instructions, counters.instructions);
+    _Add<uint64_t>(histogram.cache_misses, counters.cache_misses);
+    _Add<uint64_t>(histogram.branch_misses, counters.branch_misses);
+    _Add<uint64_t>(histogram.counted, 1);
+    histogram.untaken_counters += counters;
+}
+
+PerfCounters::Values Profiler::TakeThreadCounters(int section) {
+    if (section < 0 || section >= MAX_SECTIONS) return {};
+    auto& histogram = _ThreadBlock().sections[section];
+    const PerfCounters::Values counters = histogram.untaken_counters;
+    histogram.untaken_counters = PerfCounters::Values();
+    return counters;
+}
+
+void Profiler::Count(int section, int64_t value) {
+    if (section < 0 || section >= MAX_SECTIONS || !TraceEnabled()) return;
+    _Trace(_ThreadBlock(), section, true, ProfileScope::Now(), value);
+}
+
+void Profiler::_Trace(ThreadBlock& block, int section, bool counter,
+                      int64_t ts_ns, int64_t value) {
+    if (!block.capacity) return;
+    const uint64_t n = block.num_events.load(std::memory_order_relaxed);
+    block.events[n % block.capacity] = {section, counter, ts_ns, value};
+    block.num_events.store(n + 1, std::memory_order_release);
+}
+
+void Profiler::NameThread(const std::string& name) {
+    auto& block = _ThreadBlock();
+    std::lock_guard<std::mutex> lck(mtx_blocks_);
+    block.name = name;
+}
+
+void Profiler::EnableTrace(size_t events_per_thread) {
+    std::lock_guard<std::mutex> lck(mtx_blocks_);
+    if (trace_capacity_ || !events_per_thread) return;
+    trace_capacity_ = events_per_thread;
+    // the owners only trace once they see the flag below
+    for (auto& block : blocks_) {
+        block->events.reset(new ThreadBlock::TraceEvent[trace_capacity_]);
+        block->capacity = trace_capacity_;
+    }
+    trace_enabled_.store(true, std::memory_order_release);
+}
+
+bool Profiler::EnablePerfCounters() {
+    PerfCounters::Values values;
+    if (!PerfCounters::Read(values)) return false;
+    perf_enabled_.store(true, std::memory_order_relaxed);
+    return true;
+}
+
+bool Profiler::OutputTrace(const std::string& output_file) const {
+    FILE* fout = fopen(output_file.c_str(), "w");
+    if (!fout) {
+        LOGE("Cannot open file %s", output_file.c_str());
+        return false;
+    }
+    std::lock_guard<std::mutex> lck(mtx_blocks_);
+    auto& names = _SectionNames();
+    const int num_sections = names.size.load(std::memory_order_acquire);
+    std::vector<std::string> section_names(num_sections);
+    for (int i = 0; i < num_sections; ++i)
+        section_names[i] = _JsonString(names.names[i]);
+
+    fprintf(fout, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    const char* separator = "";
+    for (size_t tid = 0; tid < blocks_.size(); ++tid) {
+        const auto& block = *blocks_[tid];
+        const std::string thread_name =
+            block.name.empty() ? "thread " + std::to_string(tid) : block.name;
+        fprintf(fout,
+                "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+                "\"tid\":%zu,\"args\":{\"name\":%s}}",
+                separator, tid, _JsonString(thread_name).c_str());
+        separator = ",\n";
+        if (!block.capacity) continue;
+
+        // the oldest events were overwritten when the ring wrapped
+        const uint64_t end = block.num_events.load(std::memory_order_acquire);
+        const uint64_t begin = end > block.capacity ? end - block.capacity : 0;
+        for (uint64_t i = begin; i < end; ++i) {
+            const auto& e = block.events[i % block.capacity];
+            if (e.section < 0 || e.section >= num_sections) continue;
+            const double ts_us = (e.ts_ns - origin_ns_) / 1e3;
+            if (e.counter) {
+                fprintf(fout,
+                        "%s{\"name\":%s,\"ph\":\"C\",\"pid\":1,"
+                        "\"tid\":%zu,\"ts\":%.3f,"
+                        "\"args\":{\"value\":%lld}}",
+                        separator, section_names[e.section].c_str(), tid,
+                        ts_us, static_cast<long long>(e.value));
+            } else {
+                fprintf(fout,
+                        "%s{\"name\":%s,\"ph\":\"X\",\"pid\":1,"
+                        "\"tid\":%zu,\"ts\":%.3f,\"dur\":%.3f}",
+                        separator, section_names[e.section].c_str(), tid,
+                        ts_us, e.value / 1e3);
+            }
+        }
+    }
+    fprintf(fout, "\n]}\n");
+    fclose(fout);
+    return true;
+}
+
+std::vector<Profiler::Stats> Profiler::Collect() const {
+    std::vector<std::shared_ptr<ThreadBlock>> blocks;
+    {
+        std::lock_guard<std::mutex> lck(mtx_blocks_);
+        blocks = blocks_;
+    }
+    // blocks not cleared since the last Reset() hold stale samples only
+    const uint64_t generation = generation_.load(std::memory_order_acquire);
+    blocks.erase(std::remove_if(blocks.begin(), blocks.end(),
+                                [generation](const auto& block) {
+                                    return block->generation.load(
+                                               std::memory_order_acquire) !=
+                                           generation;
+                                }),
+                 blocks.end());
+    auto& names = _SectionNames();
+    const int num_sections = names.size.load(std::memory_order_acquire);
+
+    std::vector<Stats> result;
+    std::vector<uint64_t> buckets(NUM_BUCKETS);
+    for (int i = 0; i < num_sections; ++i) {
+        uint64_t total_ns = 0, max_ns = 0, counted = 0;
+        PerfCounters::Values counters;
+        std::fill(buckets.begin(), buckets.end(), 0);
+        for (auto& block : blocks) {
+            const auto& histogram = block->sections[i];
+            if (!histogram.count.load(std::memory_order_relaxed)) continue;
+            total_ns += histogram.total_ns.load(std::memory_order_relaxed);
+            max_ns = std::max(max_ns,
+                              histogram.max_ns.load(std::memory_order_relaxed));
+            for (int b = 0; b < NUM_BUCKETS; ++b)
+                buckets[b] +=
+                    histogram.buckets[b].load(std::memory_order_relaxed);
+            counted += histogram.counted.load(std::memory_order_relaxed);
+            counters.cycles +=
+                histogram.cycles.load(std::memory_order_relaxed);
+            counters.instructions +=
+                histogram.instructions.load(std::memory_order_relaxed);
+            counters.cache_misses +=
+                histogram.cache_misses.load(std::memory_order_relaxed);
+            counters.branch_misses +=
+                histogram.branch_misses.load(std::memory_order_relaxed);
+        }
+        // count from the buckets, the percentiles have to add up
+        uint64_t count = 0;
+        for (auto n : buckets) count += n;
+        if (!count) continue;
+
+        Stats stats;
+        stats.name = names.names[i];
+        stats.count = count;
+        stats.mean_ms = total_ns / 1e6 / count;
+        stats.max_ms = max_ns / 1e6;
+        if (counted) {
+            stats.counters.cycles = counters.cycles / counted;
+            stats.counters.instructions = counters.instructions / counted;
+            stats.counters.cache_misses = counters.cache_misses / counted;
+            stats.counters.branch_misses = counters.branch_misses / counted;
+        }
+        double* percentiles[] = {&stats.p50_ms, &stats.p90_ms, &stats.p99_ms};
+        const double ranks[] = {0.5, 0.9, 0.99};
+        uint64_t seen = 0;
+        int b = 0;
+        for (int k = 0; k < 3; ++k) {
+            const uint64_t rank = std::max<uint64_t>(
+                1, static_cast<uint64_t>(std::ceil(ranks[k] * count)));
+            while (seen + buckets[b] < rank) seen += buckets[b++];
+            *percentiles[k] = std::min(_BucketValue(b), double(max_ns)) / 1e6;
+        }
+        result.push_back(stats);
+    }
+    return result;
+}
+
+bool Profiler::Get(const char* name, Stats& stats) const {
+    for (auto& s : Collect()) {
+        if (s.name == name) {
+            stats = s;
+            return true;
+        }
+    }
+    return false;
+}
+
+void Profiler::Reset() {
+    // every thread clears its own block at its next record, none is written
+    // by another thread
+    generation_.fetch_add(1, std::memory_order_acq_rel);
+}
+
+void Profiler::OutputResult(const std::string& output_file) const {
+    FILE* fout = fopen(output_file.c_str(), "w");
+    if (!fout) {
+        LOGE("Cannot open file %s", output_file.c_str());
+        return;
+    }
+    const bool counters = PerfCountersEnabled();
+    fprintf(fout, "section,count,mean_ms,p50_ms,p90_ms,p99_ms,max_ms%s\n",
+            counters ? ",cycles,instructions,cache_misses,branch_misses" : "");
+    for (auto& s : Collect()) {
+        fprintf(fout, "%s,%llu,%f,%f,%f,%f,%f", s.name.c_str(),
+                static_cast<unsigned long long>(s.count), s.mean_ms, s.p50_ms,
+                s.p90_ms, s.p99_ms, s.max_ms);
+        if (counters) {
+            const auto& c = s.counters;
+            fprintf(fout, ",%llu,%llu,%llu,%llu",
+                    static_cast<unsigned long long>(c.cycles),
+                    static_cast<unsigned long long>(c.instructions),
+                    static_cast<unsigned long long>(c.cache_misses),
+                    static_cast<unsigned long long>(c.branch_misses));
+        }
+        fprintf(fout, "\n");
+    }
+    fclose(fout);
+}
+
+void Profiler::OutputResultConsole() const {
+    if (Config::Instance().NoDebugOutput) return;
+    for (auto& s : Collect()) {
+        LOGI("%s: mean %.3f p50 %.3f p90 %.3f p99 %.3f max %.3f ms",
+             s.name.c_str(), s.mean_ms, s.p50_ms, s.p90_ms, s.p99_ms,
+             s.max_ms);
+        if (PerfCountersEnabled()) _LogCounters(s.counters);
+    }
+}
+
+}  // namespace DeltaVins
@@ -1,12 +1,18 @@
 #include "utils/log.h"
 
+#include <chrono>
+#include <cstdarg>
+#include <unordered_map>
+
+#include "dataStructure/spscQueue.h"
+#include "framework/VioContext.h"
 #include "precompile.h"
 #include "utils/utils.h"
 
 #if OUTPUT_FILE
-FILE *infoLog = nullptr;
-FILE *warnLog = nullptr;
-FILE *errLog = nullptr;
+static FILE *infoLog = nullptr;
+static FILE *warnLog = nullptr;
+static FILE *errLog = nullptr;
 #endif
 
 void logInit() {
@@ -28,9 +34,18 @@ void logInit() {
     warnLog = fopen(("./Log/[Warn]" + asc + ".txt").c_str(), "w");
     errLog = fopen(("./Log/[Error]" + asc + ".txt").c_str(), "w");
 #endif
+#if !USE_ROS2
+    DeltaVins::Logger::Start();
+    // systems created through the handle API never call finishLogging
+    static std::once_flag exit_once;
+    std::call_once(exit_once, []() { atexit(DeltaVins::Logger::Stop); });
+#endif
 }
 
 void finishLogging() {
+#if !USE_ROS2
+    DeltaVins::Logger::Stop();
+#endif
 #if OUTPUT_FILE
 
     fflush(infoLog);
@@ -43,4 +58,241 @@ void finishLogging() {
     warnLog = nullptr;
     errLog = nullptr;
 #endif
-}
\ No newline at end of file
+}
+
+#if !USE_ROS2
+namespace DeltaVins {
+
+namespace {
+constexpr size_t QUEUE_SIZE = 1024;
+constexpr auto WRITE_PERIOD = std::chrono::milliseconds(10);
+
+struct ThreadQueue {
+    SpscQueue<Logger::Record> queue{QUEUE_SIZE};
+    std::atomic<int> dropped{0};
+};
+
+// state of the background thread, process wide like the console
+struct Backend {
+    std::mutex mtx_queues;
+    std::vector<std::shared_ptr<ThreadQueue>> queues;
+
+    std::mutex mtx_run;
+    std::condition_variable cv;
+    std::atomic_bool running{false};
+    bool stop = false;  // guarded by mtx_run
+    std::thread thread;
+};
+
+Backend &_Backend() {
+    static Backend *backend = new Backend();  // used up to exit
+    return *backend;
+}
+
+std::mutex &_OutputMutex() {
+    static std::mutex *mtx = new std::mutex();
+    return *mtx;
+}
+
+// files of the contexts, guarded by _OutputMutex()
+std::unordered_map<const VioContext *, FILE *> &_ContextFiles() {
+    static auto *files = new std::unordered_map<const VioContext *, FILE *>();
+    return *files;
+}
+
+// queue of the calling thread, kept by the backend until drained
+ThreadQueue &_ThreadQueue() {
+    thread_local std::shared_ptr<ThreadQueue> queue;
+    if (!queue) {
+        queue = std::make_shared<ThreadQueue>();
+        auto &backend = _Backend();
+        std::lock_guard<std::mutex> lck(backend.mtx_queues);
+        backend.queues.push_back(queue);
+    }
+    return *queue;
+}
+
+const char *_Prefix(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug:
+            return "[Debug] ";
+        case LogLevel::Info:
+            return "[Info] ";
+        case LogLevel::Warn:
+            return "[Warn] ";
+        default:
+            return "[Error] ";
+    }
+}
+
+void _Write(LogLevel level, const char *text, size_t size,
+            FILE *context_file = nullptr) {
+    (void)level;
+    if (context_file) {
+        fwrite(text, 1, size, context_file);
+    } else {
+#if OUTPUT_CONSOLE
+        fwrite(text, 1, size, stdout);
+#endif
+    }
+#if OUTPUT_FILE
+    FILE *file = level == LogLevel::Error  ? errLog
+                 : level == LogLevel::Warn ? warnLog
+                                           : infoLog;
+    if (file) fwrite(text, 1, size, file);
+#endif
+    (void)text;
+    (void)size;
+}
+
+void _Output(const Logger::Record &record) {
+    char line[1024];
+    int n = snprintf(line, sizeof(line), "%s", _Prefix(record.level));
+    int m = record.format(line + n, sizeof(line) - n - 1, record.fmt,
+                          record.args);
+    n = std::min<int>(n + std::max(m, 0), sizeof(line) - 2);
+    line[n++] = '\n';
+    FILE *context_file = nullptr;
+    if (record.context) {
+        auto &files = _ContextFiles();
+        auto it = files.find(record.context);
+        if (it != files.end()) context_file = it->second;
+    }
+    _Write(record.level, line, n, context_file);
+}
+
+// writes everything queued so far, only one thread at a time
+void _Drain() {
+    auto &backend = _Backend();
+    std::vector<std::shared_ptr<ThreadQueue>> queues;
+    {
+        std::lock_guard<std::mutex> lck(backend.mtx_queues);
+        queues = backend.queues;
+    }
+    std::lock_guard<std::mutex> lck(_OutputMutex());
+    Logger::Record record;
+    bool wrote = false;
+    for (auto &queue : queues) {
+        while (queue->queue.Pop(record)) {
+            _Output(record);
+            wrote = true;
+        }
+        int dropped = queue->dropped.exchange(0);
+        if (dropped) {
+            char line[128];
+            int n = snprintf(line, sizeof(line),
+                             "[Warn] Log queue full, dropped %d messages\n",
+                             dropped);
+            _Write(LogLevel::Warn, line, n);
+            wrote = true;
+        }
+    }
+    if (wrote) {
+        fflush(stdout);
+        for (auto &file : _ContextFiles()) fflush(file.second);
+    }
+
+    // forget the queues of finished threads
+    std::lock_guard<std::mutex> lck_queues(backend.mtx_queues);
+    auto &all = backend.queues;
+    all.erase(std::remove_if(all.begin(), all.end(),
+                             [](const std::shared_ptr<ThreadQueue> &q) {
+                                 return q.use_count() <= 2 &&
+                                        q->queue.Empty();
+                             }),
+              all.end());
+}
+}  // namespace
+
+std::atomic<int> Logger::level_{static_cast<int>(LogLevel::Info)};
+
+void Logger::Start() {
+    auto &backend = _Backend();
+    std::lock_guard<std::mutex> lck(backend.mtx_run);
+    if (backend.running) return;
+    backend.stop = false;
+    backend.thread = std::thread([&backend]() {
+        std::unique_lock<std::mutex> ul(backend.mtx_run);
+        while (!backend.stop) {
+            backend.cv.wait_for(ul, WRITE_PERIOD);
+            ul.unlock();
+            _Drain();
+            ul.lock();
+        }
+    });
+    backend.running = true;
+}
+
+void Logger::Stop() {
+    auto &backend = _Backend();
+    {
+        std::lock_guard<std::mutex> lck(backend.mtx_run);
+        if (!backend.running) return;
+        backend.running = false;
+        backend.stop = true;
+        backend.cv.notify_one();
+    }
+    backend.thread.join();
+    _Drain();
+}
+
+void Logger::SetContextFile(const VioContext *context, FILE *file) {
+    // the messages queued so far may be for the old file
+    _Drain();
+    std::lock_guard<std::mutex> lck(_OutputMutex());
+    if (file) {
+        _ContextFiles()[context] = file;
+    } else {
+        _ContextFiles().erase(context);
+    }
+}
+
+int Logger::_FormatText(char *out, size_t size, const char *fmt,
+                        const char *args) {
+    (void)fmt;
+    return snprintf(out, size, "%s", args);
+}
+
+int Logger::_FormatNow(char *out, size_t size, const char *fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    int n = vsnprintf(out, size, fmt, args);
+    va_end(args);
+    return n;
+}
+
+void Logger::_Submit(Record &record) {
+    record.context = VioContext::Bound();
+    auto &backend = _Backend();
+    if (!backend.running) {
+        // no background thread, write on the caller
+        std::lock_guard<std::mutex> lck(_OutputMutex());
+        _Output(record);
+        return;
+    }
+    auto &queue = _ThreadQueue();
+    if (!queue.queue.Push(record)) queue.dropped++;
+    if (record.level >= LogLevel::Error) {
+        // errors often precede a crash, write them out right away
+        std::lock_guard<std::mutex> lck(backend.mtx_run);
+        backend.cv.notify_one();
+    }
+}
+
+bool LogThrottle::Allow(int *suppressed) {
+    const long long now =
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    long long next = next_.load(std::memory_order_relaxed);
+    if (now < next ||
+        !next_.compare_exchange_strong(next, now + period_ns_)) {
+        suppressed_++;
+        return false;
+    }
+    *suppressed = suppressed_.exchange(0);
+    return true;
+}
+
+}  // namespace DeltaVins
+#endif
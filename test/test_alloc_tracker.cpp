@@ -0,0 +1,123 @@
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+
+#include "framework/VioContext.h"
+#include "utils/AllocTracker.h"
+#include "utils/Profiler.h"
+
+using namespace DeltaVins;
+
+namespace {
+// keeps the compiler from eliding a malloc and free pair
+void* volatile g_sink;
+
+bool _Get(const char* name, AllocTracker::Stats& stats) {
+    for (auto& s : AllocTracker::Collect()) {
+        if (s.name != name) continue;
+        stats = s;
+        return true;
+    }
+    return false;
+}
+}  // namespace
+
+TEST(AllocTracker, PeakRss) { EXPECT_GT(AllocTracker::PeakRssKb(), 0); }
+
+TEST(AllocTracker, ScopesChargeTheirAllocations) {
+    if (!AllocTracker::Enabled()) GTEST_SKIP() << "ENABLE_ALLOC_TRACKING=0";
+    VioContext context;
+    VioContext::Scope scope(&context);
+    const int outer = Profiler::Register("test_alloc_outer");
+    const int inner = Profiler::Register("test_alloc_inner");
+    void* kept;
+    {
+        ProfileScope outer_scope(outer);
+        g_sink = malloc(1000);
+        free(g_sink);
+        {
+            ProfileScope inner_scope(inner);
+            g_sink = malloc(3000);
+            free(g_sink);
+        }
+        // back in the outer section
+        kept = malloc(4000);
+    }
+
+    AllocTracker::Stats stats;
+    ASSERT_TRUE(_Get("test_alloc_outer", stats));
+    EXPECT_EQ(stats.allocations, 2u);
+    EXPECT_EQ(stats.allocated_bytes, 5000u);
+    EXPECT_EQ(stats.live_blocks, 1);
+    EXPECT_EQ(stats.live_bytes, 4000);
+    ASSERT_TRUE(_Get("test_alloc_inner", stats));
+    EXPECT_EQ(stats.allocations, 1u);
+    EXPECT_EQ(stats.live_bytes, 0);
+
+    // freed on another thread, still credited to the outer section
+    std::thread([kept]() { free(kept); }).join();
+    ASSERT_TRUE(_Get("test_alloc_outer", stats));
+    EXPECT_EQ(stats.live_blocks, 0);
+    EXPECT_EQ(stats.live_bytes, 0);
+}
+
+TEST(AllocTracker, CancelledScopeRestoresTheSection) {
+    if (!AllocTracker::Enabled()) GTEST_SKIP() << "ENABLE_ALLOC_TRACKING=0";
+    const int section = Profiler::Register("test_alloc_cancelled");
+    {
+        ProfileScope scope(section);
+        scope.Cancel();
+        g_sink = malloc(16);
+        free(g_sink);
+    }
+    AllocTracker::Stats stats;
+    EXPECT_FALSE(_Get("test_alloc_cancelled", stats));
+}
+
+TEST(AllocTracker, ThreadAllocationsAreTakenOnce) {
+    if (!AllocTracker::Enabled()) GTEST_SKIP() << "ENABLE_ALLOC_TRACKING=0";
+    AllocTracker::TakeThreadAllocations();
+    const int64_t live_bytes = AllocTracker::LiveBytes();
+    for (int i = 0; i < 3; ++i) {
+        g_sink = malloc(100);
+        free(g_sink);
+    }
+    g_sink = malloc(100);
+    EXPECT_EQ(AllocTracker::TakeThreadAllocations(), 4u);
+    EXPECT_EQ(AllocTracker::TakeThreadAllocations(), 0u);
+    EXPECT_EQ(AllocTracker::LiveBytes(), live_bytes + 100);
+    free(g_sink);
+}
+
+TEST(AllocTracker, KeepsAlignmentAndContent) {
+    if (!AllocTracker::Enabled()) GTEST_SKIP() << "ENABLE_ALLOC_TRACKING=0";
+    void* aligned = nullptr;
+    ASSERT_EQ(posix_memalign(&aligned, 64, 100), 0);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 64, 0u);
+    free(aligned);
+    aligned = aligned_alloc(4096, 4096);
+    ASSERT_NE(aligned, nullptr);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(aligned) % 4096, 0u);
+    free(aligned);
+
+    char* block = static_cast<char*>(malloc(8));
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(block) % 16, 0u);
+    memcpy(block, "0123456", 8);
+    block = static_cast<char*>(realloc(block, 1 << 20));
+    ASSERT_NE(block, nullptr);
+    EXPECT_STREQ(block, "0123456");
+    free(block);
+
+    int* zeros = static_cast<int*>(calloc(256, sizeof(int)));
+    ASSERT_NE(zeros, nullptr);
+    for (int i = 0; i < 256; ++i) EXPECT_EQ(zeros[i], 0);
+    free(zeros);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
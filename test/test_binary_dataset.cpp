@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "IO/dataSource/binaryDataset.h"
+
+using namespace DeltaVins;
+
+namespace {
+// a small dataset with a raw and a PNG image, as bytes of the file
+std::vector<uchar> _WriteDataset() {
+    const std::string path = testing::TempDir() + "test_binary_dataset.bin";
+    {
+        BinaryDatasetWriter writer(path);
+        std::vector<uchar> pixels(4 * 6, 7);
+        writer.AddImage(10, cv::Mat(4, 6, CV_8UC1, pixels.data()));
+        writer.AddEncodedImage(20, std::vector<uchar>(50, 1), 4, 6,
+                               BinaryImageEncoding::PNG);
+        for (int i = 0; i < 3; ++i) {
+            ImuData imu;
+            imu.timestamp = 5 * i;
+            writer.AddImu(imu);
+        }
+        OdometerData odometer{};
+        writer.AddOdometer(odometer);
+    }
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<uchar>(std::istreambuf_iterator<char>(file),
+                              std::istreambuf_iterator<char>());
+}
+
+bool _IsValid(const std::vector<uchar>& bytes) {
+    std::string error;
+    return ValidateBinaryDataset(bytes.data(), bytes.size(), error);
+}
+
+// the dataset with one field of the header or of the image index changed
+std::vector<uchar> _Corrupt(
+    const std::vector<uchar>& bytes,
+    const std::function<void(BinaryDatasetHeader&, BinaryImageRecord*)>&
+        change) {
+    std::vector<uchar> corrupt = bytes;
+    auto* header = reinterpret_cast<BinaryDatasetHeader*>(corrupt.data());
+    auto* images = reinterpret_cast<BinaryImageRecord*>(
+        corrupt.data() + header->image_index_offset);
+    change(*header, images);
+    return corrupt;
+}
+}  // namespace
+
+TEST(BinaryDataset, WrittenDatasetIsValid) {
+    const auto bytes = _WriteDataset();
+    std::string error;
+    EXPECT_TRUE(ValidateBinaryDataset(bytes.data(), bytes.size(), error))
+        << error;
+    EXPECT_FALSE(ValidateBinaryDataset(bytes.data(), 16, error));
+}
+
+TEST(BinaryDataset, RejectsSectionsOutOfTheFile) {
+    const auto bytes = _WriteDataset();
+    const uint64_t size = bytes.size();
+    EXPECT_FALSE(_IsValid(_Corrupt(bytes, [&](auto& h, auto*) {
+        h.image_index_offset = size;
+    })));
+    EXPECT_FALSE(_IsValid(_Corrupt(bytes, [](auto& h, auto*) {
+        h.num_imus = std::numeric_limits<uint32_t>::max();
+    })));
+    // would wrap around with offset + count * size
+    EXPECT_FALSE(_IsValid(_Corrupt(bytes, [](auto& h, auto*) {
+        h.odometer_offset = std::numeric_limits<uint64_t>::max() - 8;
+    })));
+    EXPECT_FALSE(_IsValid(_Corrupt(bytes, [](auto& h, auto*) {
+        h.gnss_offset += 1;
+        h.num_gnss = 1;
+    })));
+    EXPECT_FALSE(_IsValid(
+        _Corrupt(bytes, [](auto& h, auto*) { h.imu_offset += 1; })));
+}
+
+TEST(BinaryDataset, RejectsImagesOutOfTheFile) {
+    const auto bytes = _WriteDataset();
+    const uint64_t size = bytes.size();
+    EXPECT_FALSE(_IsValid(_Corrupt(
+        bytes, [&](auto&, auto* images) { images[1].offset = size; })));
+    EXPECT_FALSE(_IsValid(_Corrupt(bytes, [](auto&, auto* images) {
+        images[1].size = std::numeric_limits<uint64_t>::max();
+    })));
+    // the pixels of a raw image do not fit its size
+    EXPECT_FALSE(_IsValid(_Corrupt(
+        bytes, [](auto&, auto* images) { images[0].rows = 1 << 30; })));
+    EXPECT_FALSE(_IsValid(_Corrupt(
+        bytes, [](auto&, auto* images) { images[0].cols = -6; })));
+    EXPECT_FALSE(_IsValid(_Corrupt(bytes, [](auto&, auto* images) {
+        images[0].encoding = BinaryImageEncoding(7);
+    })));
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
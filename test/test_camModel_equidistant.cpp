@@ -17,7 +17,7 @@ TEST(EquidistantModel, TestMonocularModelPrecision) {
     DeltaVins::EquiDistantModel equidistantModel(width, height, fx, fy, cx, cy,
                                                  k1, k2, k3, k4);
 
-    DeltaVins::Config::ResultOutputPath = "./";
+    DeltaVins::Config::Instance().ResultOutputPath = "./";
     float model_err = equidistantModel.testModelPrecision(false);
 
     EXPECT_NEAR(model_err, 0.0f, 1e-3f);
@@ -46,7 +46,7 @@ TEST(EquidistantModel, TestStereoModelPrecision) {
         width, height, fx, fy, cx, cy, k1, k2, k3, k4, fx_right, fy_right,
         cx_right, cy_right, k1_right, k2_right, k3_right, k4_right);
 
-    DeltaVins::Config::ResultOutputPath = "./";
+    DeltaVins::Config::Instance().ResultOutputPath = "./";
     float left_model_err = equidistantModel.testModelPrecision(false);
     float right_model_err = equidistantModel.testModelPrecision(true);
 
@@ -13,7 +13,7 @@ DataSource::Ptr dataSourcePtr = nullptr;
 class TestFisheyeCamModel : public DataSource::ImageObserver {
    public:
     TestFisheyeCamModel() {
-        std::string datasetPath = Config::DataSourcePath;
+        std::string datasetPath = Config::Instance().DataSourcePath;
         existOrMkdir(datasetPath + "/rectify");
         rectifyPath = datasetPath + "/rectify/";
         testJacobian();
@@ -102,7 +102,7 @@ class TestFisheyeCamModel : public DataSource::ImageObserver {
 
 int main() {
     logInit();
-    Config::loadConfigFile("", "");
+    Config::Instance().loadConfigFile("", "");
     CamModel::loadCalibrations();
     TestFisheyeCamModel test;
     dataSourcePtr->AddImageObserver(&test);
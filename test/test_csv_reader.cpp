@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "utils/CsvReader.h"
+
+using namespace DeltaVins;
+
+namespace {
+std::string WriteTempFile(const std::string& content) {
+    std::string path = testing::TempDir() + "test_csv_reader.csv";
+    std::ofstream file(path, std::ios::binary);
+    file << content;
+    return path;
+}
+}  // namespace
+
+TEST(CsvReader, ParseEurocImuRows) {
+    auto path = WriteTempFile(
+        "#timestamp [ns],w_x,w_y,w_z,a_x,a_y,a_z\r\n"
+        "1403715273262142976,-0.099134,0.142417,0.0251327,8.1476,-0.37,-2.4"
+        "\r\n\r\n"
+        "1403715273267142912,-0.0991,1e-3,0.02,8.04,-0.36,-2.3\r\n");
+
+    CsvReader reader(path);
+    ASSERT_TRUE(reader.IsOpen());
+
+    ASSERT_TRUE(reader.NextRow());
+    ASSERT_EQ(reader.NumFields(), 7);
+    EXPECT_EQ(reader.GetInt64(0), 1403715273262142976LL);
+    EXPECT_FLOAT_EQ(reader.GetFloat(1), -0.099134f);
+    EXPECT_FLOAT_EQ(reader.GetFloat(6), -2.4f);
+
+    ASSERT_TRUE(reader.NextRow());
+    EXPECT_EQ(reader.GetInt64(0), 1403715273267142912LL);
+    EXPECT_FLOAT_EQ(reader.GetFloat(2), 1e-3f);
+    EXPECT_EQ(reader.Field(6), "-2.3");
+
+    EXPECT_FALSE(reader.NextRow());
+}
+
+TEST(CsvReader, RowsAcrossBlockBoundaries) {
+    std::string content;
+    for (int i = 0; i < 1000; ++i) {
+        content += std::to_string(i) + "," + std::to_string(i * 0.5f) + "\n";
+    }
+    // last line without line break
+    content += "1000,500";
+    auto path = WriteTempFile(content);
+
+    // tiny blocks force refills and growing the buffer
+    CsvReader reader(path, ',', 4);
+    int rows = 0;
+    while (reader.NextRow()) {
+        ASSERT_EQ(reader.NumFields(), 2);
+        EXPECT_EQ(reader.GetInt64(0), rows);
+        EXPECT_FLOAT_EQ(reader.GetFloat(1), rows * 0.5f);
+        rows++;
+    }
+    EXPECT_EQ(rows, 1001);
+}
+
+TEST(CsvReader, SkipsBlankAndHeaderRows) {
+    auto path = WriteTempFile(
+        "timestamp,filename\n"
+        "  \t\r\n"
+        "1403715273262142976,1403715273262142976.png\n"
+        "\n"
+        "\n");
+
+    CsvReader reader(path);
+    int64_t timestamp = 0;
+    ASSERT_TRUE(reader.NextRow());
+    EXPECT_FALSE(reader.GetInt64(0, timestamp));
+
+    ASSERT_TRUE(reader.NextRow());
+    ASSERT_TRUE(reader.GetInt64(0, timestamp));
+    EXPECT_EQ(timestamp, 1403715273262142976LL);
+    EXPECT_FALSE(reader.GetInt64(1, timestamp));
+    EXPECT_FALSE(reader.GetInt64(2, timestamp));
+
+    EXPECT_FALSE(reader.NextRow());
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,73 @@
+#include <gtest/gtest.h>
+
+#include "Algorithm/IMU/ImuPropagator.h"
+#include "framework/VioContext.h"
+#include "precompile.h"
+#include "utils/constantDefine.h"
+
+using namespace DeltaVins;
+
+// 200Hz samples of a body accelerating along x with 1m/s^2
+static ImuData MakeImu(int i) {
+    ImuData imuData;
+    imuData.timestamp = 1000000000LL + i * 5000000LL;
+    imuData.acc = Vector3f(1.f, 0.f, -GRAVITY);
+    return imuData;
+}
+
+static ImuPropagator::State MakeState(long long timestamp, float t) {
+    ImuPropagator::State state;
+    state.timestamp = timestamp;
+    state.Rwi.setIdentity();
+    state.Pwi = Vector3f(0.5f * t * t, 0.f, 0.f);
+    state.Vwi = Vector3f(t, 0.f, 0.f);
+    state.bg.setZero();
+    state.ba.setZero();
+    return state;
+}
+
+class ImuPropagatorTest : public testing::Test {
+   protected:
+    void SetUp() override {
+        Tfs<float>::Instance().AddStaticTransform(Transform<float>(
+            0, "imu0", "body", Eigen::Isometry3f::Identity()));
+    }
+    VioContext context_;
+    VioContext::Scope scope_{&context_};
+};
+
+TEST_F(ImuPropagatorTest, WaitsForTheFirstState) {
+    ImuPropagator propagator;
+    Pose pose;
+    EXPECT_FALSE(propagator.AddImu(MakeImu(0), pose));
+}
+
+TEST_F(ImuPropagatorTest, PropagatesEverySample) {
+    ImuPropagator propagator;
+    Pose pose;
+    propagator.AddImu(MakeImu(0), pose);
+    ASSERT_TRUE(propagator.SetState(MakeState(MakeImu(0).timestamp, 0.f),
+                                    pose));
+    for (int i = 1; i <= 200; i++) {
+        ASSERT_TRUE(propagator.AddImu(MakeImu(i), pose));
+        EXPECT_EQ(pose.timestamp, MakeImu(i).timestamp);
+    }
+    EXPECT_NEAR(pose.Pwb.x(), 0.5f, 1e-3f);
+    EXPECT_NEAR(pose.Pwb.z(), 0.f, 1e-3f);
+}
+
+TEST_F(ImuPropagatorTest, ReplaysSamplesAfterTheState) {
+    ImuPropagator propagator;
+    Pose pose;
+    for (int i = 0; i <= 200; i++) propagator.AddImu(MakeImu(i), pose);
+    // the filter finished the frame at 0.5s while samples up to 1s arrived
+    ASSERT_TRUE(propagator.SetState(MakeState(MakeImu(100).timestamp, 0.5f),
+                                    pose));
+    EXPECT_EQ(pose.timestamp, MakeImu(200).timestamp);
+    EXPECT_NEAR(pose.Pwb.x(), 0.5f, 1e-3f);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,74 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#include "framework/VioContext.h"
+#include "utils/log.h"
+
+using namespace DeltaVins;
+
+TEST(LogThrottle, CountsSuppressedMessages) {
+    LogThrottle throttle(50);
+    int suppressed = -1;
+    EXPECT_TRUE(throttle.Allow(&suppressed));
+    EXPECT_EQ(suppressed, 0);
+    for (int i = 0; i < 5; i++) EXPECT_FALSE(throttle.Allow(&suppressed));
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    EXPECT_TRUE(throttle.Allow(&suppressed));
+    EXPECT_EQ(suppressed, 5);
+}
+
+TEST(Logger, RuntimeLevel) {
+    Logger::SetLevel(LogLevel::Warn);
+    EXPECT_FALSE(Logger::Enabled(LogLevel::Info));
+    EXPECT_TRUE(Logger::Enabled(LogLevel::Error));
+    Logger::SetLevel(LogLevel::Info);
+    EXPECT_TRUE(Logger::Enabled(LogLevel::Info));
+}
+
+TEST(Logger, AsyncMessagesAreWrittenOnStop) {
+    testing::internal::CaptureStdout();
+    Logger::Start();
+    char name[] = "copied";
+    LOGI("value %d %.1f %s %s", 7, 2.5f, name, "literal");
+    name[0] = 'X';  // strings are copied when logging
+    Logger::Stop();
+    EXPECT_EQ(testing::internal::GetCapturedStdout(),
+              "[Info] value 7 2.5 copied literal\n");
+}
+
+TEST(Logger, ContextMessagesGoToItsFile) {
+    const std::string path = testing::TempDir() + "test_logger_context.txt";
+    FILE* file = fopen(path.c_str(), "w");
+    ASSERT_NE(file, nullptr);
+    VioContext context;
+    Logger::SetContextFile(&context, file);
+
+    testing::internal::CaptureStdout();
+    Logger::Start();
+    std::thread thread([&]() {
+        VioContext::Scope scope(&context);
+        LOGI("of the context %d", 1);
+    });
+    thread.join();
+    LOGI("of no context");
+    Logger::SetContextFile(&context, nullptr);
+    LOGI("after the file was closed");
+    Logger::Stop();
+    fclose(file);
+
+    EXPECT_EQ(testing::internal::GetCapturedStdout(),
+              "[Info] of no context\n[Info] after the file was closed\n");
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    EXPECT_EQ(content.str(), "[Info] of the context 1\n");
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,183 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "IO/dataOuput/MetricsExporter.h"
+#include "IO/dataOuput/MetricsReporter.h"
+#include "framework/VioContext.h"
+#include "utils/Metrics.h"
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace DeltaVins;
+
+namespace {
+// collects the snapshots instead of exporting them
+struct SnapshotRecorder : public MetricsExporter {
+    void Export(const MetricsSnapshot& snapshot) override {
+        snapshots.push_back(snapshot);
+    }
+    std::vector<MetricsSnapshot> snapshots;
+};
+
+std::string _ReadFile(const std::string& path) {
+    std::ifstream fin(path);
+    std::stringstream ss;
+    ss << fin.rdbuf();
+    return ss.str();
+}
+}  // namespace
+
+TEST(Metrics, SameNameSameMetric) {
+    const int a =
+        Metrics::Register("test_same", Metrics::Type::Gauge, "a gauge");
+    EXPECT_GE(a, 0);
+    EXPECT_EQ(Metrics::Register("test_same", Metrics::Type::Gauge, "a gauge"),
+              a);
+    EXPECT_NE(Metrics::Register("test_other", Metrics::Type::Gauge, "other"),
+              a);
+}
+
+TEST(Metrics, CountersAddUpAcrossThreads) {
+    Metrics metrics;
+    const int counter =
+        Metrics::Register("test_counter", Metrics::Type::Counter, "counter");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&]() {
+            for (int i = 0; i < 10000; ++i) metrics.Add(counter, 1);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    double value = 0;
+    ASSERT_TRUE(metrics.Get("test_counter", value));
+    EXPECT_EQ(value, 40000);
+}
+
+TEST(Metrics, OnlyUpdatedMetricsAreCollected) {
+    VioContext context;
+    {
+        VioContext::Scope scope(&context);
+        METRIC_SET("test_gauge", "a gauge", 2.5);
+        METRIC_SET("test_gauge", "a gauge", 1.5);
+    }
+    double value = 0;
+    ASSERT_TRUE(context.GetMetrics().Get("test_gauge", value));
+    EXPECT_EQ(value, 1.5);
+    EXPECT_FALSE(VioContext::Default().GetMetrics().Get("test_gauge", value));
+    Metrics::Register("test_untouched", Metrics::Type::Gauge, "never set");
+    EXPECT_FALSE(context.GetMetrics().Get("test_untouched", value));
+}
+
+TEST(MetricsExporter, FormatsPrometheusText) {
+    MetricsSnapshot snapshot;
+    snapshot.timestamp = 1700000000.5;
+    snapshot.metrics.push_back(
+        {"frames", "Frames processed", Metrics::Type::Counter, 42});
+    Profiler::Stats stats{"Solve", 10, 2.0, 1.5, 3.0, 4.0, 5.0, {}};
+    snapshot.stages.push_back(stats);
+
+    const std::string text = MetricsExporter::FormatText(snapshot);
+    EXPECT_NE(text.find("# TYPE deltavins_frames counter\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("\ndeltavins_frames 42\n"), std::string::npos);
+    EXPECT_NE(text.find("deltavins_stage_latency_ms{stage=\"Solve\","
+                        "quantile=\"0.99\"} 4.000000\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("deltavins_stage_latency_ms_count{stage=\"Solve\"} "
+                        "10\n"),
+              std::string::npos);
+    EXPECT_NE(text.find("deltavins_stage_latency_ms_sum{stage=\"Solve\"} "
+                        "20.000000\n"),
+              std::string::npos);
+}
+
+TEST(MetricsExporter, FileIsReplaced) {
+    const std::string path = testing::TempDir() + "metrics_test.prom";
+    MetricsFileExporter exporter(path);
+    MetricsSnapshot snapshot{};
+    snapshot.metrics.push_back({"value", "", Metrics::Type::Gauge, 1});
+    exporter.Export(snapshot);
+    snapshot.metrics[0].value = 2;
+    exporter.Export(snapshot);
+
+    const std::string text = _ReadFile(path);
+    EXPECT_NE(text.find("\ndeltavins_value 2\n"), std::string::npos);
+    EXPECT_EQ(text.find("\ndeltavins_value 1\n"), std::string::npos);
+    EXPECT_FALSE(std::ifstream(path + ".tmp").good());
+    std::remove(path.c_str());
+}
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+TEST(MetricsExporter, SocketServesLatestExport) {
+    const std::string path = testing::TempDir() + "metrics_test.sock";
+    MetricsSocketExporter exporter(path);
+    MetricsSnapshot snapshot{};
+    snapshot.metrics.push_back({"value", "", Metrics::Type::Gauge, 7});
+    exporter.Export(snapshot);
+
+    for (int scrape = 0; scrape < 2; ++scrape) {
+        const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        ASSERT_GE(fd, 0);
+        sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path) - 1);
+        ASSERT_EQ(connect(fd, reinterpret_cast<sockaddr*>(&addr),
+                          sizeof(addr)),
+                  0);
+        std::string text;
+        char buffer[256];
+        ssize_t n;
+        while ((n = read(fd, buffer, sizeof(buffer))) > 0)
+            text.append(buffer, n);
+        close(fd);
+        EXPECT_NE(text.find("\ndeltavins_value 7\n"), std::string::npos);
+    }
+}
+#endif
+
+TEST(MetricsReporter, ExportsOnStop) {
+    VioContext context;
+    VioContext::Scope scope(&context);
+    auto recorder = std::make_shared<SnapshotRecorder>();
+    MetricsReporter reporter(60000);
+    reporter.AddExporter(recorder);
+    reporter.Start();
+    METRIC_ADD("frames_total", "Frames processed", 3);
+    reporter.Stop();
+
+    ASSERT_EQ(recorder->snapshots.size(), 1u);
+    double frames = -1, fps = -1;
+    for (auto& m : recorder->snapshots[0].metrics) {
+        if (m.name == "frames_total") frames = m.value;
+        if (m.name == "fps") fps = m.value;
+    }
+    EXPECT_EQ(frames, 3);
+    EXPECT_GT(fps, 0);
+}
+
+TEST(MetricsReporter, ExportsWhenDestroyedWhileRunning) {
+    VioContext context;
+    VioContext::Scope scope(&context);
+    auto recorder = std::make_shared<SnapshotRecorder>();
+    {
+        MetricsReporter reporter(60000);
+        reporter.AddExporter(recorder);
+        reporter.Start();
+        // no Stop(), e.g. released after an early return of _StopSystem
+    }
+    EXPECT_EQ(recorder->snapshots.size(), 1u);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
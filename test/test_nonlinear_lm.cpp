@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "Algorithm/Nonliear_LM.h"
+
+// Estimate a 3d point from direct noisy position measurements, h(z) = z.
+struct PointFittingProblem {
+    template <typename Func>
+    void ForEachResidual(const Eigen::Vector3d& z, Func&& f) const {
+        const Eigen::Matrix3d J = Eigen::Matrix3d::Identity();
+        for (const auto& m : measurements) {
+            Eigen::Vector3d r = m - z;
+            f(r, J);
+        }
+    }
+    bool DecentFail(const Eigen::Vector3d&) const { return false; }
+    void ConvergeCriteria(LM_Result&) const {}
+
+    std::vector<Eigen::Vector3d> measurements;
+};
+
+TEST(NonLinearLM, ConvergeToLeastSquaresSolution) {
+    PointFittingProblem problem;
+    problem.measurements = {{1.1, 2.0, 3.0}, {0.9, 2.0, 3.0},
+                            {1.0, 2.1, 3.0}, {1.0, 1.9, 3.0},
+                            {1.0, 2.0, 3.1}, {1.0, 2.0, 2.9}};
+
+    NonLinear_LM<PointFittingProblem, 3, double, LM_L2Loss> lm(
+        problem, 1e-6, 1e-8, 1e-3, 50);
+    lm.solve();
+
+    EXPECT_TRUE(lm.m_Result.bConverged);
+    EXPECT_NEAR(lm.State().x(), 1.0, 1e-4);
+    EXPECT_NEAR(lm.State().y(), 2.0, 1e-4);
+    EXPECT_NEAR(lm.State().z(), 3.0, 1e-4);
+}
+
+TEST(NonLinearLM, HuberLossDownWeightsOutlier) {
+    PointFittingProblem problem;
+    for (int i = 0; i < 10; ++i) {
+        problem.measurements.emplace_back(1.0 + 0.01 * (i % 3 - 1), 2.0, 3.0);
+    }
+    problem.measurements.emplace_back(100.0, 2.0, 3.0);
+
+    NonLinear_LM<PointFittingProblem, 3, double, LM_L2Loss> lm_l2(
+        problem, 1e-6, 1e-8, 1e-3, 50);
+    lm_l2.solve();
+    NonLinear_LM<PointFittingProblem, 3, double, LM_HuberLoss> lm_huber(
+        problem, 1e-6, 1e-8, 1e-3, 50);
+    lm_huber.solve();
+
+    EXPECT_GT(std::abs(lm_l2.State().x() - 1.0), 5.0);
+    EXPECT_LT(std::abs(lm_huber.State().x() - 1.0),
+              std::abs(lm_l2.State().x() - 1.0));
+}
+
+int main(int argc, char **argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
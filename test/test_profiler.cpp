@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "framework/VioContext.h"
+#include "utils/Profiler.h"
+
+using namespace DeltaVins;
+
+TEST(Profiler, SameNameSameSection) {
+    const int a = Profiler::Register("test_same_name");
+    EXPECT_GE(a, 0);
+    EXPECT_EQ(Profiler::Register("test_same_name"), a);
+    EXPECT_NE(Profiler::Register("test_other_name"), a);
+}
+
+TEST(Profiler, Percentiles) {
+    Profiler profiler;
+    const int section = Profiler::Register("test_percentiles");
+    // 1 ms to 100 ms, one sample each
+    for (int i = 1; i <= 100; ++i) profiler.Record(section, i * 1000000LL);
+
+    Profiler::Stats stats;
+    ASSERT_TRUE(profiler.Get("test_percentiles", stats));
+    EXPECT_EQ(stats.count, 100u);
+    EXPECT_NEAR(stats.mean_ms, 50.5, 1e-6);
+    EXPECT_NEAR(stats.max_ms, 100.0, 1e-6);
+    // within the resolution of the histogram
+    EXPECT_NEAR(stats.p50_ms, 50.0, 50.0 * 0.07);
+    EXPECT_NEAR(stats.p90_ms, 90.0, 90.0 * 0.07);
+    EXPECT_NEAR(stats.p99_ms, 99.0, 99.0 * 0.07);
+    EXPECT_LE(stats.p99_ms, stats.max_ms);
+
+    profiler.Reset();
+    EXPECT_FALSE(profiler.Get("test_percentiles", stats));
+}
+
+TEST(Profiler, ThreadTotalIsTakenOnce) {
+    Profiler profiler;
+    const int section = Profiler::Register("test_thread_total");
+    profiler.Record(section, 1000);
+    profiler.Record(section, 2000);
+    EXPECT_EQ(profiler.TakeThreadTotal(section), 3000);
+    EXPECT_EQ(profiler.TakeThreadTotal(section), 0);
+    // other threads keep their own totals
+    std::thread([&profiler, section]() { profiler.Record(section, 5); })
+        .join();
+    EXPECT_EQ(profiler.TakeThreadTotal(section), 0);
+}
+
+TEST(Profiler, ResetForgetsUntakenTotals) {
+    Profiler profiler;
+    const int section = Profiler::Register("test_reset_total");
+    profiler.Record(section, 1000);
+    profiler.Reset();
+    profiler.Record(section, 7);
+    EXPECT_EQ(profiler.TakeThreadTotal(section), 7);
+
+    Profiler::Stats stats;
+    ASSERT_TRUE(profiler.Get("test_reset_total", stats));
+    EXPECT_EQ(stats.count, 1u);
+}
+
+TEST(Profiler, ResetWhileThreadsRecord) {
+    Profiler profiler;
+    const int section = Profiler::Register("test_reset_threads");
+    std::atomic_bool running{true};
+    std::thread thread([&]() {
+        while (running) profiler.Record(section, 1000);
+    });
+    for (int i = 0; i < 100; ++i) profiler.Reset();
+    running = false;
+    thread.join();
+
+    // the samples since the last reset only, none of the earlier ones
+    profiler.Reset();
+    Profiler::Stats stats;
+    EXPECT_FALSE(profiler.Get("test_reset_threads", stats));
+}
+
+TEST(Profiler, MergesThreads) {
+    Profiler profiler;
+    const int section = Profiler::Register("test_threads");
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&profiler, section, t]() {
+            for (int i = 0; i < 1000; ++i)
+                profiler.Record(section, (t + 1) * 1000LL);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    Profiler::Stats stats;
+    ASSERT_TRUE(profiler.Get("test_threads", stats));
+    EXPECT_EQ(stats.count, 4000u);
+    EXPECT_NEAR(stats.max_ms, 0.004, 1e-9);
+}
+
+TEST(Profiler, ScopesRecordIntoTheirContext) {
+    VioContext context;
+    {
+        VioContext::Scope scope(&context);
+        {
+            PROFILE_SCOPE("test_scope");
+            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        }
+        PROFILE_SCOPE_NAMED(cancelled, "test_cancelled");
+        cancelled.Cancel();
+    }
+    Profiler::Stats stats;
+#if ENABLE_PROFILER
+    ASSERT_TRUE(context.GetProfiler().Get("test_scope", stats));
+    EXPECT_EQ(stats.count, 1u);
+    EXPECT_GE(stats.max_ms, 2.0);
+#endif
+    EXPECT_FALSE(context.GetProfiler().Get("test_cancelled", stats));
+    EXPECT_FALSE(VioContext::Default().GetProfiler().Get("test_scope", stats));
+}
+
+TEST(Profiler, TraceKeepsLatestEvents) {
+    VioContext context;
+    context.GetProfiler().EnableTrace(4);
+    {
+        VioContext::Scope scope(&context);
+        context.GetProfiler().NameThread("test thread");
+        for (int i = 0; i < 6; ++i) {
+            PROFILE_SCOPE("test_trace_span");
+        }
+        TRACE_COUNTER("test_trace_counter", 3);
+    }
+    const std::string path = "test_profiler_trace.json";
+    ASSERT_TRUE(context.GetProfiler().OutputTrace(path));
+    std::stringstream ss;
+    ss << std::ifstream(path).rdbuf();
+    const std::string trace = ss.str();
+    remove(path.c_str());
+
+    auto occurrences = [&trace](const std::string& s) {
+        int n = 0;
+        for (auto pos = trace.find(s); pos != std::string::npos;
+             pos = trace.find(s, pos + 1))
+            n++;
+        return n;
+    };
+    EXPECT_EQ(occurrences("\"test thread\""), 1);
+#if ENABLE_PROFILER
+    // 6 spans and a counter through a ring of 4
+    EXPECT_EQ(occurrences("\"ph\":\"X\""), 3);
+    EXPECT_EQ(occurrences("\"ph\":\"C\""), 1);
+    EXPECT_EQ(occurrences("\"value\":3"), 1);
+#endif
+    EXPECT_EQ(trace.back(), '\n');
+}
+
+TEST(Profiler, ThreadCountersAreTakenOnce) {
+    Profiler profiler;
+    const int section = Profiler::Register("test_thread_counters");
+    PerfCounters::Values counters;
+    counters.cycles = 300;
+    counters.instructions = 600;
+    counters.cache_misses = 3;
+    counters.branch_misses = 1;
+    profiler.Record(section, 0, 1000, counters);
+    profiler.Record(section, 0, 3000, counters);
+
+    Profiler::Stats stats;
+    ASSERT_TRUE(profiler.Get("test_thread_counters", stats));
+    EXPECT_EQ(stats.count, 2u);
+    // means per call
+    EXPECT_EQ(stats.counters.cycles, 300u);
+    EXPECT_EQ(stats.counters.instructions, 600u);
+    EXPECT_EQ(stats.counters.cache_misses, 3u);
+    EXPECT_EQ(stats.counters.branch_misses, 1u);
+
+    EXPECT_EQ(profiler.TakeThreadCounters(section).cycles, 600u);
+    EXPECT_EQ(profiler.TakeThreadCounters(section).cycles, 0u);
+}
+
+TEST(Profiler, ScopesCountWithPerfCounters) {
+    VioContext context;
+    if (!context.GetProfiler().EnablePerfCounters()) {
+        GTEST_SKIP() << "perf_event_open is not permitted here";
+    }
+    {
+        VioContext::Scope scope(&context);
+        PROFILE_SCOPE("test_perf_scope");
+        volatile uint64_t sum = 0;
+        for (int i = 0; i < 100000; ++i) sum += i;
+    }
+#if ENABLE_PROFILER
+    Profiler::Stats stats;
+    ASSERT_TRUE(context.GetProfiler().Get("test_perf_scope", stats));
+    // a volatile add and the loop are several instructions each
+    EXPECT_GE(stats.counters.instructions, 100000u);
+#endif
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "IO/dataSource/dataSource_External.h"
+#include "framework/slamAPI.h"
+#include "precompile.h"
+
+using namespace DeltaVins;
+
+struct CountingObserver : public DataSource::ImuObserver,
+                          public DataSource::ImageObserver {
+    void OnImuReceived(const ImuData& imuData) override {
+        imu_timestamps.push_back(imuData.timestamp);
+    }
+    void OnImageReceived(const ImageData::Ptr imageData) override {
+        last_image = imageData;
+    }
+    std::vector<long long> imu_timestamps;
+    ImageData::Ptr last_image;
+};
+
+TEST(DataSourceExternal, DropsSamplesOutOfOrder) {
+    DataSource_External source;
+    CountingObserver observer;
+    source.AddImuObserver(&observer);
+    source.AddImageObserver(&observer);
+
+    for (long long t : {10, 20, 20, 15, 30}) {
+        ImuData imuData;
+        imuData.timestamp = t;
+        source.PushImu(imuData);
+    }
+    EXPECT_EQ(observer.imu_timestamps, (std::vector<long long>{10, 20, 30}));
+
+    auto first = std::make_shared<ImageData>();
+    first->timestamp = 100;
+    source.PushImage(first);
+    auto late = std::make_shared<ImageData>();
+    late->timestamp = 50;
+    source.PushImage(late);
+    EXPECT_EQ(observer.last_image, first);
+}
+
+static void CountRelease(void* user_data) { ++*static_cast<int*>(user_data); }
+
+TEST(PushApi, RejectedImagesAreReleased) {
+    unsigned char pixels[4 * 2] = {0};
+    int released = 0;
+    EXPECT_FALSE(
+        PushImage(nullptr, 1, pixels, 4, 2, 4, CountRelease, &released));
+    EXPECT_EQ(released, 1);
+    VioPose pose;
+    EXPECT_FALSE(GetLatestPose(nullptr, &pose));
+}
+
+namespace {
+// a mono External system on the EuRoC calibration, serial so that a push
+// returns once the frame is processed
+std::string _WriteConfig() {
+    const std::string dir = testing::TempDir();
+    const std::string source = dir + "test_push_api_source.yaml";
+    const std::string config = dir + "test_push_api.yaml";
+    std::ofstream(source) << "%YAML:1.0\n---\nDataSourceType: \"External\"\n";
+    std::ofstream(config) << "%YAML:1.0\n---\n"
+                             "SerialRun: 1\nNoGUI: 1\nRunVIO: 1\n"
+                             "UseGnss: 0\nUseStereo: 0\nUseOdometer: 0\n"
+                             "ResultOutputPath: \""
+                          << dir << "\"\nDataSourceConfigFilePath: \""
+                          << source
+                          << "\"\nCalibrationPath: \"" CALIBRATION_DIR "\"\n"
+                             "MaxNumToTrack: 350\nMaskSize: 41\n"
+                             "UseBackTracking: 1\nFastScoreThreshold: 15\n";
+    return config;
+}
+}  // namespace
+
+TEST(PushApi, PaddedImagesAreCopied) {
+    VioHandle handle = CreateSlamSystem(_WriteConfig().c_str());
+    ASSERT_NE(handle, nullptr);
+    ASSERT_TRUE(StartSlamSystem(handle));
+    // at rest, up to past the images
+    const float gyro[3] = {0.f, 0.f, 0.f};
+    const float acc[3] = {0.f, 0.f, 9.81f};
+    for (long long t = 5000000; t <= 300000000; t += 5000000)
+        PushImu(handle, t, gyro, acc);
+
+    const int width = 752, height = 480, stride = width + 16;
+    std::vector<unsigned char> pixels(stride * height);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < stride; ++x)
+            pixels[y * stride + x] = (x / 16 + y / 16) % 2 ? 200 : 50;
+    }
+    int released = 0;
+    EXPECT_TRUE(PushImage(handle, 100000000, pixels.data(), width, height,
+                          stride, CountRelease, &released));
+    // processed from a copy, the buffer is given back
+    EXPECT_EQ(released, 1);
+
+    // not of the calibrated size, or rows shorter than the image
+    EXPECT_FALSE(PushImage(handle, 150000000, pixels.data(), width - 16,
+                           height, stride, CountRelease, &released));
+    EXPECT_FALSE(PushImage(handle, 150000000, pixels.data(), width, height,
+                           width - 1, CountRelease, &released));
+    EXPECT_EQ(released, 3);
+
+    // borrowed, given back with the system at the latest
+    int borrowed = 0;
+    EXPECT_TRUE(PushImage(handle, 200000000, pixels.data(), width, height,
+                          width, CountRelease, &borrowed));
+    DestroySlamSystem(handle);
+    EXPECT_EQ(borrowed, 1);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
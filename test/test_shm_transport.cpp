@@ -0,0 +1,185 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "IO/dataOuput/PoseOutputShm.h"
+#include "IO/dataOuput/ShmTransport.h"
+
+#if defined(PLATFORM_LINUX) || defined(PLATFORM_MAC)
+#include <unistd.h>
+
+using namespace DeltaVins;
+using namespace DeltaVins::shm;
+
+namespace {
+// one segment per process, tests of two builds may run at once
+std::string _Name() {
+    return "/deltavins_test_" + std::to_string(getpid());
+}
+
+Layout _SmallLayout() {
+    Layout layout;
+    layout.slots = 4;
+    layout.max_frames = 8;
+    layout.max_points = 16;
+    layout.max_image_bytes = 64;
+    return layout;
+}
+}  // namespace
+
+TEST(ShmTransport, RoundTrip) {
+    ShmReader reader;
+    EXPECT_FALSE(reader.Open(_Name()));
+
+    ShmWriter writer;
+    ASSERT_TRUE(writer.Create(_Name(), _SmallLayout()));
+    ASSERT_TRUE(reader.Open(_Name()));
+    ShmReader::Message message;
+    EXPECT_FALSE(reader.ReadLatest(POSES, message));
+
+    ShmFrame frames[2] = {{1, 1, {}}, {2, 1, {}}};
+    frames[1].Twc[12] = 3.5f;
+    MessageInfo info;
+    info.frame = 7;
+    info.count = 2;
+    info.size = sizeof(frames);
+    ASSERT_TRUE(writer.Write(POSES, frames, info));
+
+    ASSERT_TRUE(reader.ReadLatest(POSES, message));
+    EXPECT_EQ(message.info.frame, 7u);
+    ASSERT_EQ(message.info.count, 2u);
+    EXPECT_EQ(message.Frames()[1].id, 2);
+    EXPECT_EQ(message.Frames()[1].Twc[12], 3.5f);
+    // read already
+    EXPECT_FALSE(reader.ReadLatest(POSES, message));
+    EXPECT_FALSE(reader.ReadLatest(POINTS, message));
+}
+
+TEST(ShmTransport, SlowReaderGetsNewest) {
+    ShmWriter writer;
+    ASSERT_TRUE(writer.Create(_Name(), _SmallLayout()));
+    ShmReader reader;
+    ASSERT_TRUE(reader.Open(_Name()));
+
+    for (uint32_t i = 0; i < 10; ++i) {
+        MessageInfo info;
+        info.frame = i;
+        info.size = sizeof(i);
+        ASSERT_TRUE(writer.Write(IMAGE0, &i, info));
+    }
+    EXPECT_EQ(reader.Published(IMAGE0), 10u);
+    ShmReader::Message message;
+    ASSERT_TRUE(reader.ReadLatest(IMAGE0, message));
+    EXPECT_EQ(message.info.frame, 9u);
+    EXPECT_FALSE(reader.ReadLatest(IMAGE0, message));
+}
+
+TEST(ShmTransport, TooLargeIsRejected) {
+    ShmWriter writer;
+    ASSERT_TRUE(writer.Create(_Name(), _SmallLayout()));
+    EXPECT_EQ(writer.Capacity(IMAGE1), 64u);
+    EXPECT_EQ(writer.Begin(IMAGE1, 65), nullptr);
+
+    std::vector<uint8_t> image(65);
+    MessageInfo info;
+    info.size = image.size();
+    EXPECT_FALSE(writer.Write(IMAGE1, image.data(), info));
+    ShmReader reader;
+    ASSERT_TRUE(reader.Open(_Name()));
+    EXPECT_EQ(reader.Published(IMAGE1), 0u);
+}
+
+TEST(ShmTransport, ReaderSeesWriterClose) {
+    ShmReader reader;
+    {
+        ShmWriter writer;
+        ASSERT_TRUE(writer.Create(_Name(), _SmallLayout()));
+        ASSERT_TRUE(reader.Open(_Name()));
+        EXPECT_FALSE(reader.WriterClosed());
+    }
+    EXPECT_TRUE(reader.WriterClosed());
+    ShmReader other;
+    EXPECT_FALSE(other.Open(_Name()));
+}
+
+TEST(ShmTransport, ConcurrentReadsAreNeverTorn) {
+    ShmWriter writer;
+    ASSERT_TRUE(writer.Create(_Name(), _SmallLayout()));
+    ShmReader reader;
+    ASSERT_TRUE(reader.Open(_Name()));
+
+    // every point of message k carries id k
+    std::atomic_bool done{false};
+    std::thread thread([&]() {
+        for (int k = 1; k <= 20000; ++k) {
+            MessageInfo info;
+            info.frame = k;
+            info.count = 16;
+            info.size = info.count * sizeof(ShmPoint);
+            auto* points =
+                reinterpret_cast<ShmPoint*>(writer.Begin(POINTS, info.size));
+            for (uint32_t i = 0; i < info.count; ++i) points[i] = {k, {}};
+            writer.Publish(POINTS, info);
+        }
+        done = true;
+    });
+
+    ShmReader::Message message;
+    int reads = 0;
+    uint64_t last = 0;
+    while (!done) {
+        if (!reader.ReadLatest(POINTS, message)) continue;
+        ++reads;
+        ASSERT_EQ(message.info.count, 16u);
+        EXPECT_GT(message.info.frame, last);
+        last = message.info.frame;
+        for (uint32_t i = 0; i < message.info.count; ++i)
+            ASSERT_EQ(message.Points()[i].id, (int)message.info.frame);
+    }
+    thread.join();
+    if (reader.ReadLatest(POINTS, message)) ++reads;
+    EXPECT_GT(reads, 0);
+    EXPECT_EQ(message.info.frame, 20000u);
+}
+
+TEST(PoseOutputShm, PublishesOneFrame) {
+    Layout layout = _SmallLayout();
+    layout.max_image_bytes = 2 * 2 * 3;
+    PoseOutputShm output(_Name(), layout);
+    ShmReader reader;
+    ASSERT_TRUE(reader.Open(_Name()));
+
+    std::vector<FrameGL> frames;
+    frames.emplace_back(Eigen::Matrix3f::Identity(),
+                        Eigen::Vector3f(1, 2, 3), 5);
+    std::vector<WorldPointGL> points;
+    points.emplace_back(Eigen::Vector3f(4, 5, 6), 9);
+    unsigned char left[12] = {1}, right[12] = {2};
+    output.PushViewMatrix(frames);
+    output.PushWorldPoint(points);
+    output.PushImageTexture(left, 2, 2, 3, "track_image_left");
+    output.PushImageTexture(right, 2, 2, 3, "track_image_right");
+    output.FinishFrame();
+
+    ShmReader::Message message;
+    ASSERT_TRUE(reader.ReadLatest(POSES, message));
+    ASSERT_EQ(message.info.count, 1u);
+    EXPECT_EQ(message.Frames()[0].id, 5);
+    EXPECT_EQ(message.Frames()[0].Twc[14], 3.f);
+    ASSERT_TRUE(reader.ReadLatest(POINTS, message));
+    EXPECT_EQ(message.Points()[0].id, 9);
+    EXPECT_EQ(message.Points()[0].P[2], 6.f);
+    ASSERT_TRUE(reader.ReadLatest(IMAGE1, message));
+    EXPECT_STREQ(message.info.name, "track_image_right");
+    EXPECT_EQ(message.info.width, 2);
+    EXPECT_EQ(message.payload[0], 2);
+    EXPECT_EQ(message.info.frame, 0u);
+}
+#endif
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
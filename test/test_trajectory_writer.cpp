@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "IO/dataOuput/TelemetryWriter.h"
+#include "IO/dataOuput/TrajectoryWriter.h"
+#include "dataStructure/spscQueue.h"
+#include "precompile.h"
+
+using namespace DeltaVins;
+
+namespace {
+TrajectoryWriter::Record MakeRecord(long long timestamp, float x) {
+    TrajectoryWriter::Record record{};
+    record.timestamp = timestamp;
+    record.position[0] = x;
+    record.rotation[0] = 1.f;  // identity
+    return record;
+}
+
+std::string ReadFile(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    std::stringstream ss;
+    ss << file.rdbuf();
+    return ss.str();
+}
+}  // namespace
+
+TEST(SpscQueue, RejectsPushWhenFull) {
+    SpscQueue<int> queue(4);
+    for (int i = 0; i < 4; i++) EXPECT_TRUE(queue.Push(i));
+    EXPECT_FALSE(queue.Push(4));
+    int value;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(queue.Pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(queue.Pop(value));
+    EXPECT_TRUE(queue.Empty());
+}
+
+TEST(TrajectoryWriter, WritesEverythingOnStop) {
+    const std::string path = testing::TempDir() + "trajectory.tum";
+    {
+        TrajectoryWriter writer(path, ResultOutputFormat::TUM);
+        ASSERT_TRUE(writer.IsOpen());
+        writer.Start();
+        for (int i = 0; i < 100; i++)
+            writer.Write(MakeRecord(1000000000LL * (i + 1), i));
+        writer.Stop();
+    }
+    std::istringstream lines(ReadFile(path));
+    std::string line;
+    int n = 0;
+    while (std::getline(lines, line)) n++;
+    EXPECT_EQ(n, 100);
+    EXPECT_EQ(ReadFile(path).substr(0, 9), "1.000000 ");
+}
+
+TEST(TrajectoryWriter, KittiRowsAreTransformMatrices) {
+    const std::string path = testing::TempDir() + "trajectory.kitti";
+    {
+        TrajectoryWriter writer(path, ResultOutputFormat::KITTI);
+        writer.Write(MakeRecord(1, 2.f));
+    }
+    std::istringstream row(ReadFile(path));
+    std::vector<float> values;
+    float value;
+    while (row >> value) values.push_back(value);
+    ASSERT_EQ(values.size(), 12u);
+    EXPECT_FLOAT_EQ(values[0], 1.f);
+    EXPECT_FLOAT_EQ(values[3], 2.f);
+    EXPECT_FLOAT_EQ(values[10], 1.f);
+}
+
+TEST(TrajectoryWriter, BinaryKeepsRecords) {
+    const std::string path = testing::TempDir() + "trajectory.bin";
+    {
+        TrajectoryWriter writer(path, ResultOutputFormat::BINARY);
+        writer.Write(MakeRecord(42, 3.f));
+    }
+    auto data = ReadFile(path);
+    ASSERT_EQ(data.size(), sizeof(TrajectoryWriter::Record));
+    TrajectoryWriter::Record record;
+    memcpy(&record, data.data(), sizeof(record));
+    EXPECT_EQ(record.timestamp, 42);
+    EXPECT_FLOAT_EQ(record.position[0], 3.f);
+}
+
+TEST(TelemetryWriter, CsvHasHeaderAndOneLinePerFrame) {
+    const std::string path = testing::TempDir() + "telemetry.csv";
+    {
+        TelemetryWriter writer(path, false);
+        writer.Start();
+        FrameTelemetry telemetry{};
+        for (int i = 0; i < 3; i++) {
+            telemetry.timestamp = i;
+            telemetry.tracked_features = 100 + i;
+            writer.Write(telemetry);
+        }
+    }
+    std::istringstream lines(ReadFile(path));
+    std::string line;
+    ASSERT_TRUE(std::getline(lines, line));
+    EXPECT_EQ(line.substr(0, 23), "timestamp,add_frame_ms,");
+    const size_t columns = std::count(line.begin(), line.end(), ',');
+    int n = 0;
+    while (std::getline(lines, line)) {
+        EXPECT_EQ(std::count(line.begin(), line.end(), ','), columns);
+        EXPECT_NE(line.find(",10" + std::to_string(n) + ","),
+                  std::string::npos);
+        n++;
+    }
+    EXPECT_EQ(n, 3);
+}
+
+TEST(TelemetryWriter, BinaryKeepsRecords) {
+    const std::string path = testing::TempDir() + "telemetry.bin";
+    {
+        TelemetryWriter writer(path, true);
+        FrameTelemetry telemetry{};
+        telemetry.timestamp = 7;
+        telemetry.queue_depth = 2;
+        writer.Write(telemetry);
+    }
+    auto data = ReadFile(path);
+    ASSERT_EQ(data.size(), sizeof(FrameTelemetry));
+    FrameTelemetry telemetry;
+    memcpy(&telemetry, data.data(), sizeof(telemetry));
+    EXPECT_EQ(telemetry.timestamp, 7);
+    EXPECT_EQ(telemetry.queue_depth, 2);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
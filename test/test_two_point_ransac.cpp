@@ -0,0 +1,199 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "Algorithm/DataAssociation/TwoPointRansac.h"
+
+using namespace DeltaVins;
+
+namespace {
+const float FOCAL = 450.f;
+const float MAX_REPROJ_ERR = 2.f;
+
+Eigen::Matrix3f _EssentialMatrix(const TwoPointRansac::Hypothesis& hyp) {
+    Eigen::Matrix3f E;
+    E << 0, -hyp.cos_beta, -hyp.sin_beta_sin_alpha, hyp.cos_beta, 0,
+        -hyp.sin_beta_cos_alpha, hyp.sin_beta_sin_alpha,
+        hyp.sin_beta_cos_alpha, 0;
+    return E;
+}
+
+TwoPointRansac::Hypothesis _Hypothesis(float alpha, float beta) {
+    return {std::cos(beta), std::sin(beta) * std::sin(alpha),
+            std::sin(beta) * std::cos(alpha)};
+}
+
+// the per point test scoring was written as before it was batched
+int _ScalarInliers(const TwoPointRansac::Hypothesis& hyp,
+                   const std::vector<Eigen::Vector3f>& ray10,
+                   const std::vector<Eigen::Vector3f>& ray1,
+                   std::vector<bool>& inliers) {
+    const Eigen::Matrix3f E = _EssentialMatrix(hyp);
+    const float focal2 = FOCAL * FOCAL;
+    int num_inliers = 0;
+    inliers.resize(ray10.size());
+    for (size_t i = 0; i < ray10.size(); ++i) {
+        Eigen::Vector3f l1 = E * ray10[i];
+        float a0 = ray1[i].dot(l1);
+        float s0 = focal2 / (l1.x() * l1.x() + l1.y() * l1.y());
+        Eigen::Vector3f l2 = E.transpose() * ray1[i];
+        float a1 = ray10[i].dot(l2);
+        float s1 = focal2 / (l2.x() * l2.x() + l2.y() * l2.y());
+        inliers[i] = std::max(a0 * a0 * s0, a1 * a1 * s1) <
+                     MAX_REPROJ_ERR * MAX_REPROJ_ERR;
+        num_inliers += inliers[i];
+    }
+    return num_inliers;
+}
+
+// seeded correspondences of a translation along t, a third are outliers
+void _MakeCorrespondences(int num_points, unsigned seed,
+                          const Eigen::Vector3f& t,
+                          std::vector<Eigen::Vector3f>& ray10,
+                          std::vector<Eigen::Vector3f>& ray1) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> lateral(-2.f, 2.f);
+    std::uniform_real_distribution<float> depth(2.f, 10.f);
+    std::normal_distribution<float> noise(0.f, 0.5f / FOCAL);
+    ray10.clear();
+    ray1.clear();
+    for (int i = 0; i < num_points; ++i) {
+        Eigen::Vector3f P(lateral(rng), lateral(rng), depth(rng));
+        Eigen::Vector3f P1 = P - t;
+        Eigen::Vector3f r1 = P1 / P1.z();
+        if (i % 3 == 2) {
+            r1.x() += lateral(rng) * 0.1f;
+            r1.y() += lateral(rng) * 0.1f;
+        } else {
+            r1.x() += noise(rng);
+            r1.y() += noise(rng);
+        }
+        ray10.push_back(P / P.z());
+        ray1.push_back(r1);
+    }
+}
+
+// what FindInliers sets up, without a rotation
+void _Setup(TwoPointRansac& ransac, const std::vector<Eigen::Vector3f>& ray10,
+            const std::vector<Eigen::Vector3f>& ray1) {
+    const int P = TwoPointRansac::POINT_BLOCK;
+    ransac.num_points_ = ray10.size();
+    ransac.num_padded_points_ = (ransac.num_points_ + P - 1) / P * P;
+    ransac.focal2_ = FOCAL * FOCAL;
+    for (auto* buffer : {&ransac.ray10_x_, &ransac.ray10_y_, &ransac.ray10_z_,
+                         &ransac.ray1_x_, &ransac.ray1_y_, &ransac.ray1_z_})
+        buffer->assign(ransac.num_padded_points_, 0.f);
+    for (int i = 0; i < ransac.num_points_; ++i) {
+        ransac.ray10_x_[i] = ray10[i].x();
+        ransac.ray10_y_[i] = ray10[i].y();
+        ransac.ray10_z_[i] = ray10[i].z();
+        ransac.ray1_x_[i] = ray1[i].x();
+        ransac.ray1_y_[i] = ray1[i].y();
+        ransac.ray1_z_[i] = ray1[i].z();
+    }
+}
+}  // namespace
+
+TEST(TwoPointRansac, BatchedScoringMatchesScalar) {
+    const Eigen::Vector3f t(0.3f, -0.1f, 0.2f);
+    const Eigen::Vector3f dir = t.normalized();
+    // t = (sb * ca, -sb * sa, cb)
+    const float beta = std::acos(dir.z());
+    const float alpha = std::atan2(-dir.y(), dir.x());
+
+    // neither a multiple of the point block nor of the hypothesis batch
+    for (int num_points : {5, 77, 203}) {
+        SCOPED_TRACE(num_points);
+        std::vector<Eigen::Vector3f> ray10, ray1;
+        _MakeCorrespondences(num_points, 7 + num_points, t, ray10, ray1);
+        TwoPointRansac ransac(MAX_REPROJ_ERR);
+        _Setup(ransac, ray10, ray1);
+
+        // the true motion among perturbed ones
+        std::mt19937 rng(num_points);
+        std::uniform_real_distribution<float> perturb(-0.05f, 0.05f);
+        const int num_hypotheses = TwoPointRansac::HYPOTHESIS_BATCH - 1;
+        std::vector<int> scalar_inliers(num_hypotheses);
+        std::vector<std::vector<bool>> scalar_sets(num_hypotheses);
+        for (int h = 0; h < num_hypotheses; ++h) {
+            ransac.hypotheses_[h] =
+                h == 3 ? _Hypothesis(alpha, beta)
+                       : _Hypothesis(alpha + perturb(rng), beta + perturb(rng));
+            scalar_inliers[h] = _ScalarInliers(ransac.hypotheses_[h], ray10,
+                                               ray1, scalar_sets[h]);
+        }
+        const int scalar_best =
+            std::max_element(scalar_inliers.begin(), scalar_inliers.end()) -
+            scalar_inliers.begin();
+        ASSERT_GE(scalar_inliers[scalar_best], num_points / 2);
+
+        // without preemption every score is complete
+        int best;
+        EXPECT_EQ(ransac.ScoreHypotheses(num_hypotheses, -1, best),
+                  scalar_inliers[scalar_best]);
+        EXPECT_EQ(best, scalar_best);
+        for (int h = 0; h < num_hypotheses; ++h) {
+            EXPECT_EQ(ransac.hypothesis_inliers_[h], scalar_inliers[h]);
+            std::vector<bool> inliers;
+            EXPECT_EQ(ransac.SelectInliers(ransac.hypotheses_[h], inliers),
+                      scalar_inliers[h]);
+            EXPECT_EQ(inliers, scalar_sets[h]);
+        }
+
+        // preemption drops hypotheses, never the best one
+        EXPECT_EQ(ransac.ScoreHypotheses(num_hypotheses,
+                                         scalar_inliers[scalar_best] - 1, best),
+                  scalar_inliers[scalar_best]);
+        EXPECT_EQ(best, scalar_best);
+    }
+}
+
+TEST(TwoPointRansac, AdaptiveBoundStopsWithinBatch) {
+    const Eigen::Vector3f t(0.3f, -0.1f, 0.2f);
+    const Eigen::Vector3f dir = t.normalized();
+    const float beta = std::acos(dir.z());
+    const float alpha = std::atan2(-dir.y(), dir.x());
+    const int num_points = 203;
+    std::vector<Eigen::Vector3f> ray10, ray1;
+    _MakeCorrespondences(num_points, 11, t, ray10, ray1);
+    TwoPointRansac ransac(MAX_REPROJ_ERR);
+    _Setup(ransac, ray10, ray1);
+
+    // a fair hypothesis first, the true motion later in the batch
+    const int num_hypotheses = TwoPointRansac::HYPOTHESIS_BATCH;
+    for (int h = 0; h < num_hypotheses; ++h) {
+        ransac.hypotheses_[h] = h == 3 ? _Hypothesis(alpha, beta)
+                                       : _Hypothesis(alpha + 0.05f * (h + 1),
+                                                     beta - 0.05f * (h + 1));
+    }
+    int best_hypothesis;
+    ransac.ScoreHypotheses(num_hypotheses, -1, best_hypothesis);
+    const int first_inliers = ransac.hypothesis_inliers_[0];
+    ASSERT_EQ(best_hypothesis, 3);
+    ASSERT_GT(ransac.hypothesis_inliers_[3], first_inliers);
+
+    // a sequential scan stops right after the first hypothesis
+    const int first_iter = ransac.UpdateIterNum(first_inliers) - 1;
+    ASSERT_GE(first_iter, 0);
+    int max_inliers = -1;
+    TwoPointRansac::Hypothesis best;
+    EXPECT_EQ(ransac.AcceptHypotheses(num_hypotheses, first_iter,
+                                      first_iter + num_hypotheses, max_inliers,
+                                      best),
+              first_iter + 1);
+    EXPECT_EQ(max_inliers, first_inliers);
+    EXPECT_EQ(best.cos_beta, ransac.hypotheses_[0].cos_beta);
+
+    // and takes the whole batch under a loose bound
+    max_inliers = -1;
+    ransac.AcceptHypotheses(num_hypotheses, 0, 1000, max_inliers, best);
+    EXPECT_EQ(max_inliers, ransac.hypothesis_inliers_[3]);
+    EXPECT_EQ(best.cos_beta, ransac.hypotheses_[3].cos_beta);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "framework/VioContext.h"
+#include "precompile.h"
+#include "utils/Config.h"
+#include "utils/tf.h"
+
+using namespace DeltaVins;
+
+TEST(VioContext, InstancesFollowTheBoundContext) {
+    VioContext a, b;
+    {
+        VioContext::Scope scope(&a);
+        EXPECT_EQ(&VioContext::Current(), &a);
+        Config::Instance().MaxNumToTrack = 100;
+        Tfs<float>::Instance().AddStaticTransform(Transform<float>(
+            0, "body", "imu0", Eigen::Isometry3f::Identity()));
+        {
+            VioContext::Scope inner(&b);
+            EXPECT_EQ(&Config::Instance(), &b.GetConfig());
+            Config::Instance().MaxNumToTrack = 200;
+        }
+        // the outer binding is restored
+        EXPECT_EQ(Config::Instance().MaxNumToTrack, 100);
+    }
+    EXPECT_EQ(&VioContext::Current(), &VioContext::Default());
+    EXPECT_EQ(b.GetConfig().MaxNumToTrack, 200);
+
+    Transform<float> tf;
+    EXPECT_TRUE(a.GetTfs().GetTransform("body", "imu0", tf));
+    EXPECT_FALSE(b.GetTfs().GetTransform("body", "imu0", tf));
+}
+
+TEST(VioContext, ThreadsStartInTheDefaultContext) {
+    VioContext context;
+    VioContext::Scope scope(&context);
+    VioContext* seen = nullptr;
+    std::thread([&seen]() { seen = &VioContext::Current(); }).join();
+    EXPECT_EQ(seen, &VioContext::Default());
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
+#include "IO/dataOuput/VisualizerPublisher.h"
+#include "framework/VioContext.h"
+#include "utils/Metrics.h"
+
+using namespace DeltaVins;
+
+namespace {
+// records what the publisher hands over, slowly if asked to
+struct RecordingAdapter : public FrameAdapter, public WorldPointAdapter {
+    void PushViewMatrix(std::vector<FrameGL>& frames) override {
+        entered = true;
+        std::this_thread::sleep_for(delay);
+        ids.push_back(frames.empty() ? -1 : frames[0].m_id);
+    }
+    void PushImageTexture(unsigned char*, const int, const int, const int,
+                          const std::string&) override {
+        ++images;
+    }
+    void PushWorldPoint(const std::vector<WorldPointGL>&) override {}
+    void FinishFrame() override {
+        std::lock_guard<std::mutex> lck(mtx);
+        ++finished;
+        cv.notify_all();
+    }
+
+    bool WaitFinished(int n) {
+        std::unique_lock<std::mutex> lck(mtx);
+        return cv.wait_for(lck, std::chrono::seconds(5),
+                           [&]() { return finished >= n; });
+    }
+
+    std::chrono::milliseconds delay{0};
+    std::atomic_bool entered{false};
+    std::vector<int> ids;  // read after the publisher stopped
+    int images = 0;
+    std::mutex mtx;
+    std::condition_variable cv;
+    int finished = 0;  // guarded by mtx
+};
+
+VisualSnapshot::Ptr _Snapshot(VisualizerPublisher& publisher, int id,
+                              long long timestamp) {
+    auto snapshot = publisher.Acquire(timestamp);
+    if (!snapshot) return snapshot;
+    snapshot->images[0] = cv::Mat(32, 32, CV_8UC1, cv::Scalar(0));
+    snapshot->frames.assign(1, FrameGL(Eigen::Matrix3f::Identity(),
+                                       Eigen::Vector3f::Zero(), id));
+    snapshot->has_map = true;
+    return snapshot;
+}
+}  // namespace
+
+TEST(VisualizerPublisher, DecimatesBySensorTime) {
+    RecordingAdapter adapter;
+    VisualizerPublisher decimated(&adapter, &adapter, 10);
+    VisualizerPublisher every(&adapter, &adapter, 0);
+    int taken = 0, taken_every = 0;
+    // 3 s at 30 Hz
+    for (int i = 0; i < 90; ++i) {
+        const long long timestamp = 1000000000LL + i * 33333333LL;
+        if (decimated.Acquire(timestamp)) ++taken;
+        if (every.Acquire(timestamp)) ++taken_every;
+    }
+    EXPECT_NEAR(taken, 30, 1);
+    EXPECT_EQ(taken_every, 90);
+}
+
+TEST(VisualizerPublisher, LatestWinsWithoutBlocking) {
+    VioContext context;
+    VioContext::Scope scope(&context);
+    RecordingAdapter adapter;
+    adapter.delay = std::chrono::milliseconds(200);
+    VisualizerPublisher publisher(&adapter, &adapter, 0);
+    publisher.Start();
+
+    publisher.Publish(_Snapshot(publisher, 0, 0));
+    while (!adapter.entered) std::this_thread::yield();
+    // the visualizer is busy with 0, the VIO thread goes on
+    const auto start = std::chrono::steady_clock::now();
+    for (int id = 1; id <= 5; ++id)
+        publisher.Publish(_Snapshot(publisher, id, id));
+    EXPECT_LT(std::chrono::steady_clock::now() - start,
+              std::chrono::milliseconds(100));
+
+    ASSERT_TRUE(adapter.WaitFinished(2));
+    publisher.Stop();
+    EXPECT_EQ(adapter.ids, std::vector<int>({0, 5}));
+    EXPECT_EQ(adapter.images, 2);
+    double dropped = 0;
+    ASSERT_TRUE(context.GetMetrics().Get("visualizer_dropped_total", dropped));
+    EXPECT_EQ(dropped, 4);
+}
+
+TEST(VisualizerPublisher, DestroyedWhileRunning) {
+    VioContext context;
+    VioContext::Scope scope(&context);
+    RecordingAdapter adapter;
+    {
+        VisualizerPublisher publisher(&adapter, &adapter, 0);
+        publisher.Start();
+        publisher.Publish(_Snapshot(publisher, 0, 0));
+        ASSERT_TRUE(adapter.WaitFinished(1));
+        // the thread waits for the next snapshot, no Stop() before the
+        // destructor wakes it up
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+    EXPECT_EQ(adapter.ids, std::vector<int>({0}));
+}
+
+TEST(VisualizerPublisher, DrawsTracksOnTheImage) {
+    VisualSnapshot snapshot;
+    snapshot.images[0] = cv::Mat(64, 64, CV_8UC1, cv::Scalar(0));
+    VisualSnapshot::Track track;
+    track.cam_id = 0;
+    track.color = cv::Scalar(255, 0, 0);
+    track.num_px = 2;
+    track.px[0] = Vector2f(32, 48);
+    track.px[1] = Vector2f(26, 48);
+    track.last_px = track.px[0];
+    snapshot.tracks.push_back(track);
+
+    cv::Mat image;
+    VisualizerPublisher::DrawTrackImage(snapshot, 0, image);
+    ASSERT_EQ(image.rows, 64);
+    ASSERT_EQ(image.channels(), 3);
+    // the circle around the last observation, below the text
+    EXPECT_EQ(image.at<cv::Vec3b>(48, 40)[0], 255);
+    EXPECT_EQ(image.at<cv::Vec3b>(0, 0)[0], 0);
+}
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}